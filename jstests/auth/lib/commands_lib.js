@@ -2180,6 +2180,20 @@ var authCommandsLib = {
               }
           ]
         },
+        {
+          testname: "cpuSamplingProfile",
+          command: {cpuSamplingProfile: "report"},
+          skipSharded: true,
+          testcases: [
+              {
+                runOnDb: adminDbName,
+                roles: roles_hostManager,
+                privileges: [{resource: {cluster: true}, actions: ["cpuProfiler"]}]
+              },
+              {runOnDb: firstDbName, roles: {}, expectFail: true},
+              {runOnDb: secondDbName, roles: {}, expectFail: true}
+          ]
+        },
         {
           testname: "copydb",
           command: {copydb: 1, fromdb: firstDbName, todb: secondDbName},
@@ -135,6 +135,7 @@
         copydb: {skip: "Tested in replsets/copydb.js"},
         copydbsaslstart: {skip: isUnrelated},
         count: {command: {count: "view"}},
+        cpuSamplingProfile: {skip: isUnrelated},
         cpuload: {skip: isAnInternalCommand},
         create: {skip: "tested in views/views_creation.js"},
         createIndexes: {
@@ -0,0 +1,73 @@
+/**
+ * Tests that the cpuSamplingProfile command samples the CPU used by operations, and that the
+ * profile shows up in serverStatus for FTDC while cpuSamplingProfilerRecordInFTDC is set.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: {cpuSamplingProfilerRecordInFTDC: true}});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    const adminDB = conn.getDB("admin");
+    const testDB = conn.getDB("test");
+
+    if (_isWindows()) {
+        assert.commandFailedWithCode(adminDB.runCommand({cpuSamplingProfile: "start"}),
+                                     ErrorCodes.CommandNotSupported);
+        MongoRunner.stopMongod(conn);
+        return;
+    }
+
+    assert.commandFailedWithCode(adminDB.runCommand({cpuSamplingProfile: "bogus"}),
+                                 ErrorCodes.BadValue);
+    assert.commandFailedWithCode(
+        adminDB.runCommand({cpuSamplingProfile: "start", samplingIntervalMicros: 1}),
+        ErrorCodes.BadValue);
+
+    // The section is only included by default while the profiler runs.
+    assert(!adminDB.serverStatus().hasOwnProperty("cpuSamplingProfile"));
+
+    assert.commandWorked(
+        adminDB.runCommand({cpuSamplingProfile: "start", samplingIntervalMicros: 1000}));
+    assert.commandFailedWithCode(adminDB.runCommand({cpuSamplingProfile: "start"}),
+                                 ErrorCodes.ConflictingOperationInProgress);
+
+    const coll = testDB.cpu_sampling_profile;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; i++) {
+        bulk.insert({x: i, s: "a".repeat(100)});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Run aggregations until some of their samples are charged to them.
+    let report;
+    assert.soon(() => {
+        coll.aggregate([{$group: {_id: {$mod: ["$x", 7]}, n: {$sum: 1}}}]).itcount();
+        report = assert.commandWorked(adminDB.runCommand({cpuSamplingProfile: "report"}));
+        return report.operations.some(op => op.op === "aggregate" && op.ns === "test");
+    });
+    assert(report.running, tojson(report));
+    for (let op of report.operations) {
+        for (let stack of op.stacks) {
+            assert(report.stacks.hasOwnProperty(stack.stack), tojson(report));
+        }
+    }
+
+    const section = adminDB.serverStatus().cpuSamplingProfile;
+    assert.neq(undefined, section);
+    assert.gt(section.samples, 0, tojson(section));
+    assert(section.hasOwnProperty("operations"), tojson(section));
+    assert(section.hasOwnProperty("stacks"), tojson(section));
+
+    assert.commandWorked(adminDB.runCommand({cpuSamplingProfile: "stop"}));
+    report = assert.commandWorked(adminDB.runCommand({cpuSamplingProfile: "report"}));
+    assert(!report.running, tojson(report));
+    assert.gt(report.samples, 0, tojson(report));
+
+    assert.commandWorked(adminDB.runCommand({cpuSamplingProfile: "reset"}));
+    report = assert.commandWorked(adminDB.runCommand({cpuSamplingProfile: "report"}));
+    assert.eq(0, report.samples, tojson(report));
+    assert.eq([], report.operations, tojson(report));
+
+    MongoRunner.stopMongod(conn);
+}());
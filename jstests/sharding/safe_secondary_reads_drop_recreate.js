@@ -134,6 +134,7 @@
             },
             behavior: "versioned"
         },
+        cpuSamplingProfile: {skip: "does not return user data"},
         cpuload: {skip: "does not return user data"},
         create: {skip: "primary only"},
         createIndexes: {skip: "primary only"},
@@ -153,6 +153,7 @@
             },
             behavior: "versioned"
         },
+        cpuSamplingProfile: {skip: "does not return user data"},
         cpuload: {skip: "does not return user data"},
         create: {skip: "primary only"},
         createIndexes: {skip: "primary only"},
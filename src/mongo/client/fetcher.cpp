@@ -174,7 +174,8 @@ Fetcher::Fetcher(executor::TaskExecutor* executor,
                  const BSONObj& metadata,
                  Milliseconds findNetworkTimeout,
                  Milliseconds getMoreNetworkTimeout,
-                 std::unique_ptr<RemoteCommandRetryScheduler::RetryPolicy> firstCommandRetryPolicy)
+                 std::unique_ptr<RemoteCommandRetryScheduler::RetryPolicy> firstCommandRetryPolicy,
+                 GetMoreCommandFn prefetchGetMoreCommandFn)
     : _executor(executor),
       _source(source),
       _dbname(dbname),
@@ -187,7 +188,8 @@ Fetcher::Fetcher(executor::TaskExecutor* executor,
           _executor,
           RemoteCommandRequest(_source, _dbname, _cmdObj, _metadata, nullptr, _findNetworkTimeout),
           [this](const auto& x) { return this->_callback(x, kFirstBatchFieldName); },
-          std::move(firstCommandRetryPolicy)) {
+          std::move(firstCommandRetryPolicy)),
+      _prefetchGetMoreCommandFn(std::move(prefetchGetMoreCommandFn)) {
     uassert(ErrorCodes::BadValue, "callback function cannot be null", work);
 }
 
@@ -224,6 +226,7 @@ std::string Fetcher::getDiagnosticString() const {
     output << " getMoreNetworkTimeout: " << _getMoreNetworkTimeout;
     output << " shutting down?: " << _isShuttingDown_inlock();
     output << " first: " << _first;
+    output << " prefetchGetMore: " << static_cast<bool>(_prefetchGetMoreCommandFn);
     output << " firstCommandScheduler: " << _firstRemoteCommandScheduler.toString();
 
     if (_getMoreCallbackHandle.isValid()) {
@@ -330,6 +333,43 @@ Status Fetcher::_scheduleGetMore(const BSONObj& cmdObj) {
 }
 
 void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batchFieldName) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        // A prefetched getMore may complete while the previous batch is still being processed on
+        // another thread. Hand the response over to that thread so that '_work' is never run
+        // concurrently and batches are processed in order.
+        if (_inCallback) {
+            invariant(!_pendingResponse);
+            _pendingResponse = rcbd.response;
+            return;
+        }
+        _inCallback = true;
+    }
+
+    if (_processResponse(rcbd.response, batchFieldName)) {
+        return;
+    }
+
+    while (true) {
+        executor::RemoteCommandResponse response;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_pendingResponse) {
+                _inCallback = false;
+                return;
+            }
+            response = std::move(*_pendingResponse);
+            _pendingResponse = boost::none;
+        }
+
+        if (_processResponse(response, kNextBatchFieldName)) {
+            return;
+        }
+    }
+}
+
+bool Fetcher::_processResponse(const executor::RemoteCommandResponse& response,
+                               const char* batchFieldName) {
     QueryResponse batchData;
     auto finishCallbackGuard = MakeGuard([this, &batchData] {
         if (batchData.cursorId && !batchData.nss.isEmpty()) {
@@ -338,31 +378,40 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
         _finishCallback();
     });
 
-    if (!rcbd.response.isOK()) {
-        _work(StatusWith<Fetcher::QueryResponse>(rcbd.response.status), nullptr, nullptr);
-        return;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_discardPrefetchedResponse) {
+            // '_work' stopped the fetcher after this getMore was sent, and the cursor has already
+            // been killed.
+            return true;
+        }
+    }
+
+    if (!response.isOK()) {
+        _work(StatusWith<Fetcher::QueryResponse>(response.status), nullptr, nullptr);
+        return true;
     }
 
     if (_isShuttingDown()) {
         _work(Status(ErrorCodes::CallbackCanceled, "fetcher shutting down"), nullptr, nullptr);
-        return;
+        return true;
     }
 
-    const BSONObj& queryResponseObj = rcbd.response.data;
+    const BSONObj& queryResponseObj = response.data;
     Status status = getStatusFromCommandResult(queryResponseObj);
     if (!status.isOK()) {
         _work(StatusWith<Fetcher::QueryResponse>(status), nullptr, nullptr);
-        return;
+        return true;
     }
 
     status = parseCursorResponse(queryResponseObj, batchFieldName, &batchData);
     if (!status.isOK()) {
         _work(StatusWith<Fetcher::QueryResponse>(status), nullptr, nullptr);
-        return;
+        return true;
     }
 
-    batchData.otherFields.metadata = std::move(rcbd.response.metadata);
-    batchData.elapsedMillis = rcbd.response.elapsedMillis.value_or(Milliseconds{0});
+    batchData.otherFields.metadata = response.metadata;
+    batchData.elapsedMillis = response.elapsedMillis.value_or(Milliseconds{0});
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         batchData.first = _first;
@@ -373,35 +422,61 @@ void Fetcher::_callback(const RemoteCommandCallbackArgs& rcbd, const char* batch
 
     if (!batchData.cursorId) {
         _work(StatusWith<QueryResponse>(batchData), &nextAction, nullptr);
-        return;
+        return true;
     }
 
     nextAction = NextAction::kGetMore;
 
+    // Failing to prefetch is not an error, the getMore is then scheduled after '_work' returns.
+    bool prefetched = false;
+    if (_prefetchGetMoreCommandFn) {
+        auto prefetchCmdObj = _prefetchGetMoreCommandFn(batchData);
+        if (!prefetchCmdObj.isEmpty()) {
+            prefetched = _scheduleGetMore(prefetchCmdObj).isOK();
+        }
+    }
+
     BSONObjBuilder bob;
     _work(StatusWith<QueryResponse>(batchData), &nextAction, &bob);
 
+    if (prefetched) {
+        // The fetcher completes once the response to the prefetched getMore arrives, so the guard
+        // must not run here.
+        finishCallbackGuard.Dismiss();
+
+        if (nextAction != NextAction::kGetMore || bob.obj().isEmpty()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _discardPrefetchedResponse = true;
+                _executor->cancel(_getMoreCallbackHandle);
+            }
+            _sendKillCursors(batchData.cursorId, batchData.nss);
+        }
+        return false;
+    }
+
     // Callback function _work may modify nextAction to request the fetcher
     // not to schedule a getMore command.
     if (nextAction != NextAction::kGetMore) {
-        return;
+        return true;
     }
 
     // Callback function may also disable the fetching of additional data by not filling in the
     // BSONObjBuilder for the getMore command.
     auto cmdObj = bob.obj();
     if (cmdObj.isEmpty()) {
-        return;
+        return true;
     }
 
     status = _scheduleGetMore(cmdObj);
     if (!status.isOK()) {
         nextAction = NextAction::kNoAction;
         _work(StatusWith<Fetcher::QueryResponse>(status), nullptr, nullptr);
-        return;
+        return true;
     }
 
     finishCallbackGuard.Dismiss();
+    return false;
 }
 
 void Fetcher::_sendKillCursors(const CursorId id, const NamespaceString& nss) {
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <iosfwd>
 #include <memory>
 #include <string>
@@ -86,6 +87,12 @@ public:
     typedef stdx::function<void(const StatusWith<QueryResponse>&, NextAction*, BSONObjBuilder*)>
         CallbackFn;
 
+    /**
+     * Type of a function which returns the getMore command for the batch following the given
+     * one, or an empty object if the next batch should not be prefetched.
+     */
+    using GetMoreCommandFn = stdx::function<BSONObj(const QueryResponse&)>;
+
     /**
      * Creates Fetcher task but does not schedule it to be run by the executor.
      *
@@ -120,6 +127,13 @@ public:
      *
      * An optional retry policy may be provided for the first remote command request so that
      * the remote command scheduler will re-send the command in case of transient network errors.
+     *
+     * If 'prefetchGetMoreCommandFn' is provided, the fetcher sends the getMore command returned by
+     * it as soon as a batch arrives, before the batch is passed to 'work', so that the next batch
+     * is transferred while the current one is being processed. At most one getMore is outstanding
+     * at a time and batches are still passed to 'work' one at a time, in order. The command built
+     * by 'work' then only indicates whether to continue: if 'work' does not request a getMore, the
+     * prefetched getMore is canceled and the cursor is killed.
      */
     Fetcher(executor::TaskExecutor* executor,
             const HostAndPort& source,
@@ -130,7 +144,8 @@ public:
             Milliseconds findNetworkTimeout = RemoteCommandRequest::kNoTimeout,
             Milliseconds getMoreNetworkTimeout = RemoteCommandRequest::kNoTimeout,
             std::unique_ptr<RemoteCommandRetryScheduler::RetryPolicy> firstCommandRetryPolicy =
-                RemoteCommandRetryScheduler::makeNoRetryPolicy());
+                RemoteCommandRetryScheduler::makeNoRetryPolicy(),
+            GetMoreCommandFn prefetchGetMoreCommandFn = GetMoreCommandFn());
 
     virtual ~Fetcher();
 
@@ -210,6 +225,14 @@ private:
     void _callback(const executor::TaskExecutor::RemoteCommandCallbackArgs& rcbd,
                    const char* batchFieldName);
 
+    /**
+     * Passes the batch in the response to '_work' and schedules the next getMore, if any.
+     * Returns true if the fetcher has completed, in which case this Fetcher may already have been
+     * destroyed by another thread.
+     */
+    bool _processResponse(const executor::RemoteCommandResponse& response,
+                          const char* batchFieldName);
+
     /**
      * Sets fetcher state to inactive and notifies waiters.
      */
@@ -258,6 +281,21 @@ private:
 
     // First remote command scheduler.
     RemoteCommandRetryScheduler _firstRemoteCommandScheduler;
+
+    // Returns the getMore command to send before a batch is passed to '_work'. If not set,
+    // getMores are only sent after '_work' returns.
+    GetMoreCommandFn _prefetchGetMoreCommandFn;
+
+    // True while a response is being processed by _callback().
+    bool _inCallback = false;
+
+    // Response of a prefetched getMore which arrived while the previous batch was still being
+    // processed. It is processed by the thread processing the previous batch once it is done.
+    boost::optional<executor::RemoteCommandResponse> _pendingResponse;
+
+    // Set when '_work' stops the fetcher while a prefetched getMore is outstanding. The response to
+    // that getMore is discarded.
+    bool _discardPrefetchedResponse = false;
 };
 
 /**
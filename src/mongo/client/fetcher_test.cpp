@@ -954,6 +954,118 @@ TEST_F(FetcherTest, UpdateNextActionAfterSecondBatch) {
     ASSERT_EQUALS(1, countLogLinesContaining("killCursors command failed: UnknownError"));
 }
 
+BSONObj makePrefetchedGetMoreRequest(const Fetcher::QueryResponse& batchData) {
+    return BSON("getMore" << batchData.cursorId << "collection" << batchData.nss.coll()
+                          << "prefetched"
+                          << true);
+}
+
+TEST_F(FetcherTest, PrefetchedGetMoreIsSentForEachBatch) {
+    fetcher = stdx::make_unique<Fetcher>(&getExecutor(),
+                                         source,
+                                         "db",
+                                         findCmdObj,
+                                         makeCallback(),
+                                         rpc::makeEmptyMetadata(),
+                                         executor::RemoteCommandRequest::kNoTimeout,
+                                         executor::RemoteCommandRequest::kNoTimeout,
+                                         RemoteCommandRetryScheduler::makeNoRetryPolicy(),
+                                         makePrefetchedGetMoreRequest);
+
+    callbackHook = appendGetMoreRequest;
+
+    ASSERT_OK(fetcher->schedule());
+
+    const BSONObj doc = BSON("_id" << 1);
+
+    processNetworkResponse(BSON("cursor" << BSON("id" << 1LL << "ns"
+                                                      << "db.coll"
+                                                      << "firstBatch"
+                                                      << BSON_ARRAY(doc))
+                                         << "ok"
+                                         << 1),
+                           ReadyQueueState::kHasReadyRequests,
+                           FetcherState::kActive);
+
+    ASSERT_OK(status);
+    ASSERT_EQUALS(1LL, cursorId);
+    ASSERT_BSONOBJ_EQ(doc, documents.front());
+    ASSERT_TRUE(first);
+    ASSERT_TRUE(Fetcher::NextAction::kGetMore == nextAction);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        ASSERT_TRUE(getNet()->hasReadyRequests());
+        auto request = getNet()->getFrontOfUnscheduledQueue()->getRequest();
+        ASSERT_EQUALS("getMore", request.cmdObj.firstElement().fieldNameStringData());
+        ASSERT_TRUE(request.cmdObj["prefetched"].trueValue());
+    }
+
+    const BSONObj doc2 = BSON("_id" << 2);
+
+    processNetworkResponse(BSON("cursor" << BSON("id" << 0LL << "ns"
+                                                      << "db.coll"
+                                                      << "nextBatch"
+                                                      << BSON_ARRAY(doc2))
+                                         << "ok"
+                                         << 1),
+                           ReadyQueueState::kEmpty,
+                           FetcherState::kInactive);
+
+    ASSERT_OK(status);
+    ASSERT_EQUALS(0, cursorId);
+    ASSERT_BSONOBJ_EQ(doc2, documents.front());
+    ASSERT_FALSE(first);
+    ASSERT_TRUE(Fetcher::NextAction::kNoAction == nextAction);
+}
+
+TEST_F(FetcherTest, PrefetchedGetMoreIsCanceledAndCursorKilledIfCallbackStopsFetcher) {
+    fetcher = stdx::make_unique<Fetcher>(&getExecutor(),
+                                         source,
+                                         "db",
+                                         findCmdObj,
+                                         makeCallback(),
+                                         rpc::makeEmptyMetadata(),
+                                         executor::RemoteCommandRequest::kNoTimeout,
+                                         executor::RemoteCommandRequest::kNoTimeout,
+                                         RemoteCommandRetryScheduler::makeNoRetryPolicy(),
+                                         makePrefetchedGetMoreRequest);
+
+    callbackHook = setNextActionToNoAction;
+
+    ASSERT_OK(fetcher->schedule());
+
+    const BSONObj doc = BSON("_id" << 1);
+
+    // The fetcher remains active until the canceled getMore is delivered back to it.
+    processNetworkResponse(BSON("cursor" << BSON("id" << 1LL << "ns"
+                                                      << "db.coll"
+                                                      << "firstBatch"
+                                                      << BSON_ARRAY(doc))
+                                         << "ok"
+                                         << 1),
+                           ReadyQueueState::kHasReadyRequests,
+                           FetcherState::kActive);
+
+    ASSERT_OK(status);
+    ASSERT_EQUALS(1LL, cursorId);
+    ASSERT_TRUE(Fetcher::NextAction::kNoAction == nextAction);
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(getNet());
+        getNet()->runReadyNetworkOperations();
+        ASSERT_TRUE(getNet()->hasReadyRequests());
+        auto request = getNet()->getNextReadyRequest()->getRequest();
+        ASSERT_EQUALS("killCursors", request.cmdObj.firstElement().fieldNameStringData());
+    }
+
+    fetcher->join();
+    ASSERT_FALSE(fetcher->isActive());
+
+    // The response to the canceled getMore is not passed to the callback.
+    ASSERT_OK(status);
+}
+
 /**
  * This will be invoked twice before the fetcher returns control to the task executor.
  */
@@ -32,6 +32,7 @@
 
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/uuid_catalog.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/util/fail_point_service.h"
 
 namespace mongo {
@@ -109,8 +110,10 @@ AutoGetCollection::AutoGetCollection(OperationContext* opCtx,
                             << nsOrUUID.toString());
 
     // If the collection exists, there is no need to check for views
-    if (_coll)
+    if (_coll) {
+        Top::setOperationSlot(opCtx, _coll->getTopSlot());
         return;
+    }
 
     _view = db->getViewCatalog()->lookup(opCtx, _resolvedNss.ns());
     uassert(ErrorCodes::CommandNotSupportedOnView,
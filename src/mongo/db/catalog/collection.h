@@ -71,6 +71,7 @@ class OperationContext;
 struct OplogUpdateEntryArgs;
 class RecordCursor;
 class RecordFetcher;
+struct TopSlot;
 class UpdateDriver;
 class UpdateRequest;
 
@@ -728,6 +729,18 @@ public:
         return this->_impl().getDefaultCollator();
     }
 
+    /**
+     * Get the slot in which Top keeps the usage statistics of this collection. Cached here so that
+     * operations on the collection can record them without a namespace lookup. May be null.
+     */
+    inline const std::shared_ptr<TopSlot>& getTopSlot() const {
+        return _topSlot;
+    }
+
+    inline void setTopSlot(std::shared_ptr<TopSlot> slot) {
+        _topSlot = std::move(slot);
+    }
+
 
 private:
     inline DatabaseCatalogEntry* dbce() const {
@@ -773,6 +786,9 @@ private:
 
     std::unique_ptr<Impl> _pimpl;
 
+    // Set once when the collection is instantiated, before other threads can see it.
+    std::shared_ptr<TopSlot> _topSlot;
+
     friend class DatabaseImpl;
     friend class IndexCatalogImpl;
 };
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <string>
+
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/sampling_profiler.h"
+
+namespace mongo {
+namespace {
+
+// Whether serverStatus, and so FTDC, includes the sampling CPU profile while the profiler runs.
+MONGO_EXPORT_SERVER_PARAMETER(cpuSamplingProfilerRecordInFTDC, bool, false);
+
+// How many of the hottest operations and stacks the serverStatus section follows. At most twice
+// as many of each are emitted; see SamplingProfiler::appendFTDCSection().
+MONGO_EXPORT_SERVER_PARAMETER(cpuSamplingProfilerFTDCMaxEntries, int, 16);
+
+const long long kMinSamplingIntervalMicros = 1000;
+const long long kMaxSamplingIntervalMicros = 1000 * 1000;
+
+const long long kMaxReportedOperations = 100;
+const long long kMaxReportedStacksPerOperation = 10;
+
+/**
+ * Returns the number in the "fieldName" field of "cmdObj", or "defaultValue" if there is none.
+ * Throws unless it is within [minValue, maxValue].
+ */
+long long getBoundedNumber(const BSONObj& cmdObj,
+                           StringData fieldName,
+                           long long defaultValue,
+                           long long minValue,
+                           long long maxValue) {
+    const auto elem = cmdObj[fieldName];
+    if (!elem) {
+        return defaultValue;
+    }
+
+    uassert(ErrorCodes::TypeMismatch,
+            str::stream() << fieldName << " must be a number",
+            elem.isNumber());
+    const long long value = elem.safeNumberLong();
+    uassert(ErrorCodes::BadValue,
+            str::stream() << fieldName << " must be between " << minValue << " and " << maxValue,
+            value >= minValue && value <= maxValue);
+    return value;
+}
+
+/**
+ * Admin command which controls the built-in sampling CPU profiler:
+ *     { cpuSamplingProfile: "start", samplingIntervalMicros: <int> }
+ *     { cpuSamplingProfile: "stop" }
+ *     { cpuSamplingProfile: "reset" }
+ *     { cpuSamplingProfile: "report", maxOperations: <int>, maxStacksPerOperation: <int> }
+ *
+ * The report lists the operations with the most samples, each with its hottest stacks, and the
+ * symbolized frames of those stacks.
+ */
+class CmdCpuSamplingProfile : public BasicCommand {
+public:
+    CmdCpuSamplingProfile() : BasicCommand("cpuSamplingProfile") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    std::string help() const override {
+        return "controls the sampling CPU profiler and reports where the server spends CPU\n"
+               "{ cpuSamplingProfile: 'start' | 'stop' | 'reset' | 'report' }";
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const final {
+        bool isAuthorized = AuthorizationSession::get(client)->isAuthorizedForActionsOnResource(
+            ResourcePattern::forClusterResource(), ActionType::cpuProfiler);
+        return isAuthorized ? Status::OK() : Status(ErrorCodes::Unauthorized, "Unauthorized");
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const auto actionElem = cmdObj.firstElement();
+        uassert(ErrorCodes::TypeMismatch,
+                str::stream() << getName() << " must be 'start', 'stop', 'reset' or 'report'",
+                actionElem.type() == String);
+
+        auto profiler = SamplingProfiler::get();
+        const auto action = actionElem.valueStringData();
+        if (action == "start") {
+            const auto micros = getBoundedNumber(
+                cmdObj,
+                "samplingIntervalMicros",
+                durationCount<Microseconds>(SamplingProfiler::kDefaultSamplingInterval),
+                kMinSamplingIntervalMicros,
+                kMaxSamplingIntervalMicros);
+            uassertStatusOK(profiler->start(Microseconds(micros)));
+        } else if (action == "stop") {
+            profiler->stop();
+        } else if (action == "reset") {
+            profiler->reset();
+        } else if (action == "report") {
+            const auto maxOperations =
+                getBoundedNumber(cmdObj, "maxOperations", 20, 1, kMaxReportedOperations);
+            const auto maxStacksPerOperation = getBoundedNumber(
+                cmdObj, "maxStacksPerOperation", 5, 1, kMaxReportedStacksPerOperation);
+            profiler->appendReport(&result, maxOperations, maxStacksPerOperation);
+        } else {
+            uasserted(ErrorCodes::BadValue,
+                      str::stream() << "Unknown " << getName() << " action '" << action << "'");
+        }
+        return true;
+    }
+} cmdCpuSamplingProfile;
+
+/**
+ * Exposes a compact, bounded form of the sampling CPU profile to FTDC.
+ */
+class CpuSamplingProfileServerStatusSection final : public ServerStatusSection {
+public:
+    CpuSamplingProfileServerStatusSection() : ServerStatusSection("cpuSamplingProfile") {}
+
+    bool includeByDefault() const override {
+        return cpuSamplingProfilerRecordInFTDC.load() && SamplingProfiler::get()->isRunning();
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder builder;
+        SamplingProfiler::get()->appendFTDCSection(
+            &builder, std::max(1, cpuSamplingProfilerFTDCMaxEntries.load()));
+        return builder.obj();
+    }
+} cpuSamplingProfileServerStatusSection;
+
+}  // namespace
+}  // namespace mongo
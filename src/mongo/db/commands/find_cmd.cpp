@@ -38,6 +38,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -250,6 +252,14 @@ public:
             }
         }
 
+        // Point reads by _id are short, so they may use the tickets reserved for high priority
+        // operations instead of queueing behind long-running ones.
+        const auto oldTicketPriority = opCtx->lockState()->getTicketPriority();
+        if (CanonicalQuery::isSimpleIdQuery(qr->getFilter())) {
+            opCtx->lockState()->setTicketPriority(TicketHolder::Priority::kHigh);
+        }
+        ON_BLOCK_EXIT([&] { opCtx->lockState()->setTicketPriority(oldTicketPriority); });
+
         // Acquire locks. If the query is on a view, we release our locks and convert the query
         // request into an aggregation command.
         boost::optional<AutoGetCollectionForReadCommand> ctx;
@@ -298,6 +298,10 @@ public:
     BSONObj generateSection(OperationContext* opCtx, const BSONElement& configElement) const {
         BSONObjBuilder b;
         networkCounter.append(b);
+        {
+            BSONObjBuilder stages(b.subobjStart("transportStages"));
+            transportStageCounter.append(stages);
+        }
         appendMessageCompressionStats(&b);
         auto executor = opCtx->getServiceContext()->getServiceExecutor();
         if (executor)
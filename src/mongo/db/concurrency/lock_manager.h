@@ -41,6 +41,7 @@
 #include "mongo/platform/compiler.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -158,6 +159,43 @@ private:
         Map data;
     };
 
+    // Intent mode requests on the global resource, which every operation acquires, can skip
+    // both the partition and the bucket mutex while the global lock is biased towards intent
+    // modes. Such a request is granted by publishing it in the slot of its locker, and a
+    // conflicting request revokes the bias and moves all published requests to the LockHead
+    // before queueing itself. This is the BRAVO scheme for biased reader-writer locks.
+    struct alignas(stdx::hardware_destructive_interference_size) IntentSlot {
+        AtomicWord<LockRequest*> request;
+    };
+
+    /**
+     * Attempts to grant an intent mode request on the global resource through its locker's
+     * slot. Returns false if the bias is not set or the slot is taken, in which case the request
+     * must go through the regular path.
+     */
+    bool _tryLockIntentFastPath(LockRequest* request);
+
+    /**
+     * Releases a request granted through _tryLockIntentFastPath. Returns false if the request
+     * has been moved to the LockHead in the meantime and must be released from there.
+     */
+    bool _unlockIntentFastPath(LockRequest* request);
+
+    /**
+     * Clears the intent bias and moves all requests granted through the fast path to the
+     * global LockHead, so that conflicting requests see them. MUST be called under the global
+     * resource's bucket mutex.
+     */
+    void _revokeIntentBias(LockHead* lock);
+
+    /**
+     * Sets the intent bias again if no conflicting modes are granted or waiting on the global
+     * resource and the back-off that follows the last revocation has expired.
+     */
+    void _tryRestoreIntentBias();
+
+    IntentSlot* _getIntentSlot(LockRequest* request);
+
     /**
      * Retrieves the bucket in which the particular resource must reside. There is no need to
      * hold a lock when calling this function.
@@ -216,6 +254,16 @@ private:
 
     static const unsigned _numPartitions;
     Partition* _partitions;
+
+    static const unsigned _numIntentSlots = 1024;
+    IntentSlot _intentSlots[_numIntentSlots];
+
+    // Whether intent requests on the global resource may use the fast path.
+    AtomicWord<bool> _intentBias{true};
+
+    // After a revocation the bias stays off until this time (in microseconds on a monotonic
+    // clock), which keeps the cost of revocations in proportion to the time spent in the fast path.
+    AtomicWord<unsigned long long> _intentBiasInhibitUntil{0};
 };
 
 
@@ -365,6 +365,15 @@ struct LockRequest {
     // No synchronization
     bool partitioned;
 
+    // Set if this request was granted through the LockManager's intent fast path for the global
+    // resource. Such a request stays on no lock head until the bias is revoked, at which point it
+    // is moved to the regular LockHead and 'lock' is set.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on Locker thread
+    // No synchronization
+    bool fastPath;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
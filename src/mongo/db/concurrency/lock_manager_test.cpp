@@ -951,4 +951,88 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, GlobalIntentFastPath) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+    MMAPV1LockerImpl lockerIS;
+    LockRequestCombo requestIS(&lockerIS);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+
+    MMAPV1LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+
+    // Neither request is on a lock head
+    ASSERT(requestIS.fastPath);
+    ASSERT(requestIX.fastPath);
+    ASSERT(requestIS.lock == nullptr);
+    ASSERT(requestIX.lock == nullptr);
+
+    // Recursive acquisitions don't touch the fast path
+    ASSERT(LOCK_OK == lockMgr.convert(resId, &requestIX, MODE_IS));
+    ASSERT(!lockMgr.unlock(&requestIX));
+
+    ASSERT(lockMgr.unlock(&requestIS));
+    ASSERT(lockMgr.unlock(&requestIX));
+}
+
+TEST(LockManager, GlobalIntentFastPathRevoke) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+    MMAPV1LockerImpl lockerIX;
+    LockRequestCombo requestIX(&lockerIX);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+    ASSERT(requestIX.fastPath);
+
+    // The conflicting request moves the intent request to the lock head and waits for it
+    MMAPV1LockerImpl lockerX;
+    LockRequestCombo requestX(&lockerX);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+    ASSERT(requestIX.lock != nullptr);
+    ASSERT(requestIX.lock == requestX.lock);
+
+    // Intent requests queue behind the X request while it is pending
+    MMAPV1LockerImpl lockerIS;
+    LockRequestCombo requestIS(&lockerIS);
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestIS, MODE_IS));
+    ASSERT(!requestIS.fastPath);
+
+    ASSERT(lockMgr.unlock(&requestIX));
+    ASSERT_EQ(LOCK_OK, requestX.lastResult);
+    ASSERT_EQ(1, requestX.numNotifies);
+    ASSERT_EQ(0, requestIS.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestX));
+    ASSERT_EQ(LOCK_OK, requestIS.lastResult);
+    ASSERT_EQ(1, requestIS.numNotifies);
+
+    ASSERT(lockMgr.unlock(&requestIS));
+}
+
+TEST(LockManager, GlobalIntentFastPathConvert) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, ResourceId::SINGLETON_GLOBAL);
+
+    MMAPV1LockerImpl locker1;
+    LockRequestCombo request1(&locker1);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+
+    MMAPV1LockerImpl locker2;
+    LockRequestCombo request2(&locker2);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request2, MODE_IS));
+
+    // Upgrading must see the other intent request, even though both took the fast path
+    ASSERT(LOCK_WAITING == lockMgr.convert(resId, &request1, MODE_X));
+    ASSERT(request1.status == LockRequest::STATUS_CONVERTING);
+
+    ASSERT(lockMgr.unlock(&request2));
+    ASSERT_EQ(LOCK_OK, request1.lastResult);
+    ASSERT(request1.mode == MODE_X);
+
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+}
+
 }  // namespace mongo
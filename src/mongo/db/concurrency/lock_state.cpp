@@ -305,8 +305,8 @@ LockResult LockerImpl<IsForMMAPV1>::_lockGlobalBegin(LockMode mode, Date_t deadl
         if (holder) {
             _clientState.store(reader ? kQueuedReader : kQueuedWriter);
             if (deadline == Date_t::max()) {
-                holder->waitForTicket();
-            } else if (!holder->waitForTicketUntil(deadline)) {
+                holder->waitForTicket(getTicketPriority());
+            } else if (!holder->waitForTicketUntil(deadline, getTicketPriority())) {
                 _clientState.store(kInactive);
                 return LOCK_TIMEOUT;
             }
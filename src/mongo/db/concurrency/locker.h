@@ -34,6 +34,7 @@
 #include "mongo/db/concurrency/lock_manager.h"
 #include "mongo/db/concurrency/lock_stats.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/ticketholder.h"
 
 namespace mongo {
 
@@ -346,6 +347,18 @@ public:
         return _shouldAcquireTicket;
     }
 
+    /**
+     * Sets the priority with which this locker acquires tickets. High priority may also use the
+     * tickets reserved for it, and should only be given to short operations, such as point reads.
+     * Takes effect the next time the global lock is acquired.
+     */
+    void setTicketPriority(TicketHolder::Priority newValue) {
+        _ticketPriority = newValue;
+    }
+    TicketHolder::Priority getTicketPriority() const {
+        return _ticketPriority;
+    }
+
 
 protected:
     Locker() {}
@@ -353,6 +366,7 @@ protected:
 private:
     bool _shouldConflictWithSecondaryBatchApplication = true;
     bool _shouldAcquireTicket = true;
+    TicketHolder::Priority _ticketPriority = TicketHolder::Priority::kNormal;
 };
 
 }  // namespace mongo
@@ -395,6 +395,14 @@ void CurOp::reportState(BSONObjBuilder* builder, bool truncateOps) {
     }
 
     builder->append("numYields", _numYields);
+
+    if (auto cpuSamples = _cpuSamples.load()) {
+        builder->append("cpuSamples", cpuSamples);
+    }
+
+    if (_debug.executorQueueMicros >= 0) {
+        builder->append("executorQueueMicros", _debug.executorQueueMicros);
+    }
 }
 
 namespace {
@@ -523,6 +531,8 @@ string OpDebug::report(Client* client,
         s << " reslen:" << responseLength;
     }
 
+    OPDEBUG_TOSTRING_HELP(executorQueueMicros);
+
     {
         BSONObjBuilder locks;
         lockStats.report(&locks);
@@ -619,6 +629,7 @@ void OpDebug::append(const CurOp& curop,
     }
 
     OPDEBUG_APPEND_NUMBER(responseLength);
+    OPDEBUG_APPEND_NUMBER(executorQueueMicros);
     if (iscommand) {
         b.append("protocol", getProtoString(networkOp));
     }
@@ -127,6 +127,10 @@ public:
     long long executionTimeMicros{0};
     long long nreturned{-1};
     int responseLength{-1};
+
+    // Time the request spent queued in the ServiceExecutor after being read off the network. Only
+    // set when the traceTransportStages server parameter is enabled.
+    long long executorQueueMicros{-1};
 };
 
 /**
@@ -427,6 +431,14 @@ public:
         return _numYields;
     }
 
+    /**
+     * Counts the samples the sampling CPU profiler took of this operation. It is incremented
+     * from a signal handler, and may be read from any thread.
+     */
+    AtomicWord<long long>* cpuSamples() {
+        return &_cpuSamples;
+    }
+
     /**
      * this should be used very sparingly
      * generally the Context should set this up
@@ -486,6 +498,7 @@ private:
     std::string _message;
     ProgressMeter _progressMeter;
     int _numYields{0};
+    AtomicWord<long long> _cpuSamples{0};
 
     std::string _planSummary;
 };
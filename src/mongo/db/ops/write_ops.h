@@ -34,6 +34,12 @@
 
 namespace mongo {
 
+/**
+ * The documents of the parsed insert are not copied: they point into the request, and for requests
+ * parsed from the wire, into the buffer of the received message. The request, or the message it was
+ * parsed from, must outlive the returned object unless the request shares ownership of the message
+ * buffer (see OpMsg::parseOwned()). The storage engine makes the only copy of the documents.
+ */
 class InsertOp {
 public:
     static write_ops::Insert parse(const OpMsgRequest& request);
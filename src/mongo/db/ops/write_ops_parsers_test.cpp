@@ -240,6 +240,34 @@ TEST(CommandWriteOpsParsers, RealMultiInsert) {
     }
 }
 
+TEST(CommandWriteOpsParsers, MultiInsertDocumentsPointIntoMessage) {
+    const auto ns = NamespaceString("test", "foo");
+    const BSONObj obj0 = BSON("x" << 0);
+    const BSONObj obj1 = BSON("x" << 1);
+    auto cmd = BSON("insert" << ns.coll() << "documents" << BSON_ARRAY(obj0 << obj1));
+    for (bool seq : {false, true}) {
+        const auto message = toOpMsg(ns.db(), cmd, seq).serialize();
+        const char* const begin = message.buf();
+        const char* const end = begin + message.size();
+
+        for (bool owned : {false, true}) {
+            const auto request = owned ? OpMsgRequest(OpMsg::parseOwned(message))
+                                       : OpMsgRequest::parse(message);
+            const auto op = InsertOp::parse(request);
+            ASSERT_EQ(op.getDocuments().size(), 2u);
+            for (auto&& doc : op.getDocuments()) {
+                ASSERT(doc.objdata() >= begin && doc.objdata() + doc.objsize() <= end);
+                if (seq) {
+                    // Documents in an array in the body are unowned even if the body is owned.
+                    ASSERT_EQ(doc.isOwned(), owned);
+                }
+            }
+            ASSERT_BSONOBJ_EQ(op.getDocuments()[0], obj0);
+            ASSERT_BSONOBJ_EQ(op.getDocuments()[1], obj1);
+        }
+    }
+}
+
 TEST(CommandWriteOpsParsers, Update) {
     const auto ns = NamespaceString("test", "foo");
     const BSONObj query = BSON("x" << 1);
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/util/summation.h"
@@ -60,6 +61,14 @@ public:
         processInternal(input, merging);
     }
 
+    /**
+     * Processes the 'count' values in 'inputs', in order, with the same result as calling process()
+     * on each of them.
+     */
+    void processBatch(const Value* inputs, size_t count, bool merging) {
+        processBatchInternal(inputs, count, merging);
+    }
+
     /** Marks the end of the evaluate() phase and return accumulated result.
      *  toBeMerged should be true when the outputs will be merged by process().
      */
@@ -89,6 +98,42 @@ protected:
     /// Update subclass's internal state based on input
     virtual void processInternal(const Value& input, bool merging) = 0;
 
+    /// Update subclass's internal state based on a batch of inputs. Subclasses with a faster way
+    /// to process a run of inputs than one at a time override this.
+    virtual void processBatchInternal(const Value* inputs, size_t count, bool merging) {
+        for (size_t i = 0; i < count; ++i) {
+            processInternal(inputs[i], merging);
+        }
+    }
+
+    /**
+     * Sums the run of NumberInt and NumberLong values in 'inputs' which starts at index '*pos' and
+     * ends before index 'count', advancing '*pos' past them. The sum is exact: the run ends early
+     * at a value which would overflow it. Sets '*sawLong' to true if the run had a NumberLong.
+     */
+    static long long sumIntegralRun(const Value* inputs, size_t count, size_t* pos, bool* sawLong) {
+        long long total = 0;
+        for (; *pos < count; ++*pos) {
+            const Value& input = inputs[*pos];
+            long long value;
+            if (input.getType() == NumberInt) {
+                value = input.getInt();
+            } else if (input.getType() == NumberLong) {
+                value = input.getLong();
+                *sawLong = true;
+            } else {
+                break;
+            }
+
+            long long newTotal;
+            if (mongoSignedAddOverflow64(total, value, &newTotal)) {
+                break;
+            }
+            total = newTotal;
+        }
+        return total;
+    }
+
     const boost::intrusive_ptr<ExpressionContext>& getExpressionContext() const {
         return _expCtx;
     }
@@ -166,6 +211,7 @@ public:
     explicit AccumulatorSum(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
+    void processBatchInternal(const Value* inputs, size_t count, bool merging) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
     void reset() final;
@@ -198,6 +244,7 @@ public:
     AccumulatorMinMax(const boost::intrusive_ptr<ExpressionContext>& expCtx, Sense sense);
 
     void processInternal(const Value& input, bool merging) final;
+    void processBatchInternal(const Value* inputs, size_t count, bool merging) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
     void reset() final;
@@ -254,6 +301,7 @@ public:
     explicit AccumulatorAvg(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
+    void processBatchInternal(const Value* inputs, size_t count, bool merging) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
     void reset() final;
@@ -92,6 +92,37 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
     _count++;
 }
 
+void AccumulatorAvg::processBatchInternal(const Value* inputs, size_t count, bool merging) {
+    size_t i = 0;
+    while (i < count) {
+        if (merging) {
+            AccumulatorAvg::processInternal(inputs[i++], merging);
+            continue;
+        }
+
+        const size_t runStart = i;
+        switch (inputs[i].getType()) {
+            case NumberInt:
+            case NumberLong: {
+                // The summation is exact for integers, so adding an exact subtotal of a run of
+                // them gives the same total as adding them one at a time.
+                bool sawLong = false;
+                _nonDecimalTotal.addLong(sumIntegralRun(inputs, count, &i, &sawLong));
+                _count += i - runStart;
+                break;
+            }
+            case NumberDouble:
+                for (; i < count && inputs[i].getType() == NumberDouble; ++i) {
+                    _nonDecimalTotal.addDouble(inputs[i].getDouble());
+                }
+                _count += i - runStart;
+                break;
+            default:
+                AccumulatorAvg::processInternal(inputs[i++], merging);
+        }
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorAvg::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorAvg(expCtx);
@@ -61,6 +61,36 @@ void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
     }
 }
 
+namespace {
+bool isIntegralType(const Value& value) {
+    return value.getType() == NumberInt || value.getType() == NumberLong;
+}
+}  // namespace
+
+void AccumulatorMinMax::processBatchInternal(const Value* inputs, size_t count, bool merging) {
+    size_t i = 0;
+    while (i < count) {
+        if (!isIntegralType(inputs[i])) {
+            AccumulatorMinMax::processInternal(inputs[i++], merging);
+            continue;
+        }
+
+        // Of a run of integers, only the first most extreme one can replace the current value. The
+        // collation does not affect integers, so they can be compared directly.
+        size_t best = i;
+        long long bestValue = inputs[i].coerceToLong();
+        for (++i; i < count && isIntegralType(inputs[i]); ++i) {
+            const long long value = inputs[i].coerceToLong();
+            const int cmp = bestValue < value ? -1 : (bestValue > value ? 1 : 0);
+            if (cmp * _sense > 0) {
+                best = i;
+                bestValue = value;
+            }
+        }
+        AccumulatorMinMax::processInternal(inputs[best], merging);
+    }
+}
+
 Value AccumulatorMinMax::getValue(bool toBeMerged) {
     if (_val.missing()) {
         return Value(BSONNULL);
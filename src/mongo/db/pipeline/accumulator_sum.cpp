@@ -84,6 +84,31 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorSum::processBatchInternal(const Value* inputs, size_t count, bool merging) {
+    size_t i = 0;
+    while (i < count) {
+        switch (inputs[i].getType()) {
+            case NumberInt:
+            case NumberLong: {
+                // The summation is exact for integers, so adding an exact subtotal of a run of
+                // them gives the same total as adding them one at a time.
+                bool sawLong = false;
+                nonDecimalTotal.addLong(sumIntegralRun(inputs, count, &i, &sawLong));
+                totalType = Value::getWidestNumeric(totalType, sawLong ? NumberLong : NumberInt);
+                break;
+            }
+            case NumberDouble:
+                totalType = Value::getWidestNumeric(totalType, NumberDouble);
+                for (; i < count && inputs[i].getType() == NumberDouble; ++i) {
+                    nonDecimalTotal.addDouble(inputs[i].getDouble());
+                }
+                break;
+            default:
+                AccumulatorSum::processInternal(inputs[i++], merging);
+        }
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorSum(expCtx);
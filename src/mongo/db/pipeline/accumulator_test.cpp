@@ -91,6 +91,30 @@ static void assertExpectedResults(
                 ASSERT_VALUE_EQ(op.second, result);
                 ASSERT_EQUALS(op.second.getType(), result.getType());
             }
+
+            // Asserts that result equals expected result when the input is processed as a batch.
+            {
+                boost::intrusive_ptr<Accumulator> accum(factory(expCtx));
+                accum->processBatch(op.first.data(), op.first.size(), false);
+                Value result = accum->getValue(false);
+                ASSERT_VALUE_EQ(op.second, result);
+                ASSERT_EQUALS(op.second.getType(), result.getType());
+            }
+
+            // Asserts that result equals expected result when batches of shard results are merged.
+            {
+                boost::intrusive_ptr<Accumulator> accum(factory(expCtx));
+                std::vector<Value> shardResults;
+                for (auto&& val : op.first) {
+                    boost::intrusive_ptr<Accumulator> shard(factory(expCtx));
+                    shard->process(val, false);
+                    shardResults.push_back(shard->getValue(true));
+                }
+                accum->processBatch(shardResults.data(), shardResults.size(), true);
+                Value result = accum->getValue(false);
+                ASSERT_VALUE_EQ(op.second, result);
+                ASSERT_EQUALS(op.second.getType(), result.getType());
+            }
         } catch (...) {
             log() << "failed with arguments: " << Value(op.first);
             throw;
@@ -331,7 +355,18 @@ TEST(Accumulators, Sum) {
          // Null values are ignored.
          {{Value(5), Value(BSONNULL)}, Value(5)},
          // Missing values are ignored.
-         {{Value(9), Value()}, Value(9)}});
+         {{Value(9), Value()}, Value(9)},
+
+         // A run of integers which overflows part way through continues as a double.
+         {{Value(1),
+           Value(numeric_limits<long long>::max()),
+           Value(2LL),
+           Value(3),
+           Value(1.0)},
+          Value(static_cast<double>(numeric_limits<long long>::max()) + 7.0)},
+         // Runs of integers and doubles are interleaved.
+         {{Value(1), Value(2LL), Value(0.5), Value(0.25), Value(3), Value(BSONNULL), Value(4LL)},
+          Value(10.75)}});
 }
 
 TEST(Accumulators, AddToSetRespectsCollation) {
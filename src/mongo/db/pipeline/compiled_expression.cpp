@@ -0,0 +1,334 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/compiled_expression.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/platform/overflow_arithmetic.h"
+
+namespace mongo {
+
+namespace {
+
+using boost::intrusive_ptr;
+
+using Evaluator = CompiledExpression::Evaluator;
+using BoolEvaluator = stdx::function<bool(const Document& root)>;
+
+Evaluator compileValue(const intrusive_ptr<Expression>& expr);
+
+bool isIntegral(BSONType type) {
+    return type == NumberInt || type == NumberLong;
+}
+
+bool isIntegralOrDouble(BSONType type) {
+    return type == NumberInt || type == NumberLong || type == NumberDouble;
+}
+
+/**
+ * Sets '*result' to the sum of 'lhs' and 'rhs' and returns true if both are numbers which can be
+ * added without the compensated summation used by $add. The result is the one $add would return.
+ */
+bool tryAddNumbers(const Value& lhs, const Value& rhs, Value* result) {
+    const BSONType lhsType = lhs.getType();
+    const BSONType rhsType = rhs.getType();
+    if (lhsType == NumberInt && rhsType == NumberInt) {
+        *result = Value::createIntOrLong(static_cast<long long>(lhs.getInt()) + rhs.getInt());
+        return true;
+    }
+
+    if (isIntegral(lhsType) && isIntegral(rhsType)) {
+        long long sum;
+        if (mongoSignedAddOverflow64(lhs.coerceToLong(), rhs.coerceToLong(), &sum)) {
+            return false;
+        }
+        *result = Value(sum);
+        return true;
+    }
+
+    // The compensated sum of two doubles rounds to their plain sum, except that it is never
+    // negative zero. This does not hold for longs, which may not be representable as doubles.
+    if ((lhsType == NumberDouble && (rhsType == NumberDouble || rhsType == NumberInt)) ||
+        (lhsType == NumberInt && rhsType == NumberDouble)) {
+        double sum = lhs.coerceToDouble() + rhs.coerceToDouble();
+        *result = Value(sum == 0 ? 0.0 : sum);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Like tryAddNumbers(), but for the product computed by $multiply.
+ */
+bool tryMultiplyNumbers(const Value& lhs, const Value& rhs, Value* result) {
+    const BSONType lhsType = lhs.getType();
+    const BSONType rhsType = rhs.getType();
+    if (lhsType == NumberInt && rhsType == NumberInt) {
+        *result = Value::createIntOrLong(static_cast<long long>(lhs.getInt()) * rhs.getInt());
+        return true;
+    }
+
+    if (isIntegral(lhsType) && isIntegral(rhsType)) {
+        long long product;
+        if (mongoSignedMultiplyOverflow64(lhs.coerceToLong(), rhs.coerceToLong(), &product)) {
+            return false;
+        }
+        *result = Value(product);
+        return true;
+    }
+
+    if (isIntegralOrDouble(lhsType) && isIntegralOrDouble(rhsType)) {
+        *result = Value(lhs.coerceToDouble() * rhs.coerceToDouble());
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Compiles a binary $add or $multiply. Both return null or throw for a first operand of a type
+ * they do not support without evaluating the second one, which the compiled form preserves. Only
+ * $add, for which 'acceptsDates' is set, supports dates as well as numbers.
+ */
+template <typename TryApply, typename Apply>
+Evaluator compileArithmetic(const ExpressionNary& expr,
+                            bool acceptsDates,
+                            TryApply tryApply,
+                            Apply apply) {
+    auto left = compileValue(expr.getOperandList()[0]);
+    auto right = compileValue(expr.getOperandList()[1]);
+    return [left, right, acceptsDates, tryApply, apply](const Document& root) {
+        Value lhs = left(root);
+        if (!lhs.numeric() && !(acceptsDates && lhs.getType() == Date)) {
+            return apply(lhs, Value());
+        }
+
+        Value rhs = right(root);
+        Value result;
+        if (tryApply(lhs, rhs, &result)) {
+            return result;
+        }
+        return apply(lhs, rhs);
+    };
+}
+
+Evaluator compileSubtract(const ExpressionSubtract& expr) {
+    auto left = compileValue(expr.getOperandList()[0]);
+    auto right = compileValue(expr.getOperandList()[1]);
+    return [left, right](const Document& root) {
+        Value lhs = left(root);
+        Value rhs = right(root);
+        return ExpressionSubtract::apply(lhs, rhs);
+    };
+}
+
+/**
+ * Returns the truth value of 'op' for a comparison result 'cmp' which is negative, zero or
+ * positive.
+ */
+bool comparisonHolds(ExpressionCompare::CmpOp op, int cmp) {
+    switch (op) {
+        case ExpressionCompare::EQ:
+            return cmp == 0;
+        case ExpressionCompare::NE:
+            return cmp != 0;
+        case ExpressionCompare::GT:
+            return cmp > 0;
+        case ExpressionCompare::GTE:
+            return cmp >= 0;
+        case ExpressionCompare::LT:
+            return cmp < 0;
+        case ExpressionCompare::LTE:
+            return cmp <= 0;
+        case ExpressionCompare::CMP:
+            break;
+    }
+    MONGO_UNREACHABLE;
+}
+
+/**
+ * Compiles a comparison which is not $cmp into a closure returning its truth value. Integral
+ * operands are compared directly, since the collation does not affect them.
+ */
+BoolEvaluator compileCompareBool(const intrusive_ptr<ExpressionCompare>& expr) {
+    invariant(expr->getOp() != ExpressionCompare::CMP);
+    auto left = compileValue(expr->getOperandList()[0]);
+    auto right = compileValue(expr->getOperandList()[1]);
+    return [expr, left, right](const Document& root) {
+        Value lhs = left(root);
+        Value rhs = right(root);
+        if (isIntegral(lhs.getType()) && isIntegral(rhs.getType())) {
+            const long long lhsLong = lhs.coerceToLong();
+            const long long rhsLong = rhs.coerceToLong();
+            return comparisonHolds(expr->getOp(),
+                                   lhsLong < rhsLong ? -1 : (lhsLong > rhsLong ? 1 : 0));
+        }
+        return expr->apply(lhs, rhs).getBool();
+    };
+}
+
+/**
+ * Compiles 'expr' into a closure returning its value coerced to a boolean.
+ */
+BoolEvaluator compileBool(const intrusive_ptr<Expression>& expr) {
+    auto compare = dynamic_cast<ExpressionCompare*>(expr.get());
+    if (compare && compare->getOp() != ExpressionCompare::CMP) {
+        return compileCompareBool(compare);
+    }
+
+    auto valueEvaluator = compileValue(expr);
+    return [valueEvaluator](const Document& root) { return valueEvaluator(root).coerceToBool(); };
+}
+
+std::vector<BoolEvaluator> compileBoolOperands(const ExpressionNary& expr) {
+    std::vector<BoolEvaluator> operands;
+    for (auto&& operand : expr.getOperandList()) {
+        operands.push_back(compileBool(operand));
+    }
+    return operands;
+}
+
+Evaluator compileFieldPath(const intrusive_ptr<ExpressionFieldPath>& expr) {
+    const FieldPath& path = expr->getFieldPath();
+    std::vector<std::string> fieldNames;
+    for (size_t i = 1; i < path.getPathLength(); ++i) {
+        fieldNames.push_back(path.getFieldName(i).toString());
+    }
+
+    return [expr, fieldNames](const Document& root) {
+        Document doc = root;
+        for (size_t i = 0;; ++i) {
+            Value val = doc[fieldNames[i]];
+            if (i + 1 == fieldNames.size()) {
+                return val;
+            }
+
+            switch (val.getType()) {
+                case Object:
+                    doc = val.getDocument();
+                    break;
+                case Array:
+                    // The rest of the path applies to each element of the array.
+                    return expr->evaluate(root);
+                default:
+                    return Value();
+            }
+        }
+    };
+}
+
+Evaluator compileValue(const intrusive_ptr<Expression>& expr) {
+    if (auto constant = dynamic_cast<ExpressionConstant*>(expr.get())) {
+        Value value = constant->getValue();
+        return [value](const Document&) { return value; };
+    }
+
+    if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(expr.get())) {
+        if (fieldPath->isRootFieldPath() && fieldPath->getFieldPath().getPathLength() > 1) {
+            return compileFieldPath(fieldPath);
+        }
+    }
+
+    if (auto add = dynamic_cast<ExpressionAdd*>(expr.get())) {
+        if (add->getOperandList().size() == 2) {
+            return compileArithmetic(*add, true, tryAddNumbers, ExpressionAdd::apply);
+        }
+    }
+
+    if (auto multiply = dynamic_cast<ExpressionMultiply*>(expr.get())) {
+        if (multiply->getOperandList().size() == 2) {
+            return compileArithmetic(
+                *multiply, false, tryMultiplyNumbers, ExpressionMultiply::apply);
+        }
+    }
+
+    if (auto subtract = dynamic_cast<ExpressionSubtract*>(expr.get())) {
+        return compileSubtract(*subtract);
+    }
+
+    if (auto compare = dynamic_cast<ExpressionCompare*>(expr.get())) {
+        if (compare->getOp() != ExpressionCompare::CMP) {
+            auto evaluator = compileCompareBool(compare);
+            return [evaluator](const Document& root) { return Value(evaluator(root)); };
+        }
+    }
+
+    if (auto cond = dynamic_cast<ExpressionCond*>(expr.get())) {
+        auto condition = compileBool(cond->getOperandList()[0]);
+        auto thenBranch = compileValue(cond->getOperandList()[1]);
+        auto elseBranch = compileValue(cond->getOperandList()[2]);
+        return [condition, thenBranch, elseBranch](const Document& root) {
+            return condition(root) ? thenBranch(root) : elseBranch(root);
+        };
+    }
+
+    if (auto andExpr = dynamic_cast<ExpressionAnd*>(expr.get())) {
+        auto operands = compileBoolOperands(*andExpr);
+        return [operands](const Document& root) {
+            for (auto&& operand : operands) {
+                if (!operand(root)) {
+                    return Value(false);
+                }
+            }
+            return Value(true);
+        };
+    }
+
+    if (auto orExpr = dynamic_cast<ExpressionOr*>(expr.get())) {
+        auto operands = compileBoolOperands(*orExpr);
+        return [operands](const Document& root) {
+            for (auto&& operand : operands) {
+                if (operand(root)) {
+                    return Value(true);
+                }
+            }
+            return Value(false);
+        };
+    }
+
+    if (auto notExpr = dynamic_cast<ExpressionNot*>(expr.get())) {
+        auto operand = compileBool(notExpr->getOperandList()[0]);
+        return [operand](const Document& root) { return Value(!operand(root)); };
+    }
+
+    return [expr](const Document& root) { return expr->evaluate(root); };
+}
+
+}  // namespace
+
+CompiledExpression CompiledExpression::compile(const intrusive_ptr<Expression>& expression) {
+    return CompiledExpression(compileValue(expression));
+}
+
+}  // namespace mongo
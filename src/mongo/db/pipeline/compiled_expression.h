@@ -0,0 +1,75 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/stdx/functional.h"
+
+namespace mongo {
+
+class Expression;
+
+/**
+ * An optimized Expression tree lowered into a tree of closures with their operands pre-bound.
+ * Evaluating it avoids a virtual call per node and runs typed fast paths for the common cases of
+ * field paths, constants, arithmetic and comparisons on numbers, $cond, $and, $or and $not. Any
+ * other expression, including the subtree below it, is evaluated by the original Expression.
+ *
+ * The result of evaluate() is always the same as that of Expression::evaluate(), including the
+ * errors it raises and the order in which operands are evaluated. The compiled form holds
+ * references to the Expressions it was compiled from, which must not be modified afterwards.
+ */
+class CompiledExpression {
+public:
+    using Evaluator = stdx::function<Value(const Document& root)>;
+
+    /**
+     * Constructs an empty CompiledExpression, which must be assigned to before being evaluated.
+     */
+    CompiledExpression() = default;
+
+    /**
+     * Compiles 'expression', which should already have been optimized.
+     */
+    static CompiledExpression compile(const boost::intrusive_ptr<Expression>& expression);
+
+    Value evaluate(const Document& root) const {
+        return _evaluator(root);
+    }
+
+private:
+    explicit CompiledExpression(Evaluator evaluator) : _evaluator(std::move(evaluator)) {}
+
+    Evaluator _evaluator;
+};
+
+}  // namespace mongo
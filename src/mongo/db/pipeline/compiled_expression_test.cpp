@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/compiled_expression.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+
+/**
+ * Parses and optimizes 'spec', then asserts that evaluating its compiled form against each of
+ * 'inputs' produces the same value and type as the Expression itself.
+ */
+void assertCompiledMatches(BSONObj spec, const std::vector<BSONObj>& inputs) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr =
+        Expression::parseOperand(expCtx, spec.firstElement(), expCtx->variablesParseState)
+            ->optimize();
+    auto compiled = CompiledExpression::compile(expr);
+
+    for (auto&& input : inputs) {
+        Document root(input);
+        Value expected = expr->evaluate(root);
+        Value actual = compiled.evaluate(root);
+        ASSERT_TRUE(ValueComparator().evaluate(expected == actual))
+            << "spec: " << spec << ", input: " << input << ", expected: " << expected
+            << ", actual: " << actual;
+        ASSERT_EQ(expected.getType(), actual.getType()) << "spec: " << spec
+                                                        << ", input: " << input;
+    }
+}
+
+const std::vector<BSONObj> kNumericInputs = {
+    BSON("a" << 1 << "b" << 2),
+    BSON("a" << 1 << "b" << 2LL),
+    BSON("a" << 1.5 << "b" << 2),
+    BSON("a" << -0.0 << "b" << -0.0),
+    BSON("a" << std::numeric_limits<int>::max() << "b" << std::numeric_limits<int>::max()),
+    BSON("a" << std::numeric_limits<long long>::max() << "b" << 1LL),
+    BSON("a" << std::numeric_limits<long long>::max() << "b" << 1.0),
+    BSON("a" << std::numeric_limits<double>::infinity() << "b" << 1),
+    BSON("a" << Decimal128("1.1") << "b" << 2),
+    BSON("a" << Date_t::fromMillisSinceEpoch(1000) << "b" << 5),
+    BSON("a" << BSONNULL << "b" << 1),
+    BSON("b" << 1),
+    BSON("a" << 3),
+};
+
+TEST(CompiledExpressionTest, AddMatchesInterpreter) {
+    assertCompiledMatches(BSON("expr" << BSON("$add" << BSON_ARRAY("$a"
+                                                                   << "$b"))),
+                          kNumericInputs);
+}
+
+TEST(CompiledExpressionTest, MultiplyMatchesInterpreter) {
+    std::vector<BSONObj> inputs = kNumericInputs;
+    inputs.erase(std::remove_if(inputs.begin(),
+                                inputs.end(),
+                                [](const BSONObj& obj) { return obj["a"].type() == Date; }),
+                 inputs.end());
+    assertCompiledMatches(BSON("expr" << BSON("$multiply" << BSON_ARRAY("$a"
+                                                                        << "$b"))),
+                          inputs);
+}
+
+TEST(CompiledExpressionTest, SubtractMatchesInterpreter) {
+    assertCompiledMatches(BSON("expr" << BSON("$subtract" << BSON_ARRAY("$a"
+                                                                        << "$b"))),
+                          kNumericInputs);
+}
+
+TEST(CompiledExpressionTest, ComparisonsMatchInterpreter) {
+    for (auto&& op : {"$eq", "$ne", "$gt", "$gte", "$lt", "$lte", "$cmp"}) {
+        assertCompiledMatches(BSON("expr" << BSON(op << BSON_ARRAY("$a"
+                                                                   << "$b"))),
+                              {BSON("a" << 1 << "b" << 2),
+                               BSON("a" << 2LL << "b" << 2),
+                               BSON("a" << 3 << "b" << 2.5),
+                               BSON("a"
+                                    << "x"
+                                    << "b"
+                                    << 2),
+                               BSON("b" << 2)});
+    }
+}
+
+TEST(CompiledExpressionTest, FieldPathsMatchInterpreter) {
+    assertCompiledMatches(BSON("expr"
+                               << "$a.b.c"),
+                          {BSON("a" << BSON("b" << BSON("c" << 1))),
+                           BSON("a" << BSON_ARRAY(BSON("b" << BSON("c" << 1)) << BSON("b" << 2))),
+                           BSON("a" << BSON("b" << 1)),
+                           BSON("a" << 1),
+                           BSONObj()});
+}
+
+TEST(CompiledExpressionTest, LogicalExpressionsMatchInterpreter) {
+    assertCompiledMatches(
+        fromjson("{expr: {$cond: [{$and: [{$gt: ['$a', 0]}, {$not: ['$b']}]}, 'yes', {$or: ['$b', "
+                 "{$lt: ['$a', -5]}]}]}}"),
+        {BSON("a" << 1 << "b" << false),
+         BSON("a" << 1 << "b" << true),
+         BSON("a" << -10),
+         BSON("a" << 0 << "b" << 0)});
+}
+
+TEST(CompiledExpressionTest, UncompiledExpressionsAreEvaluated) {
+    assertCompiledMatches(
+        fromjson("{expr: {$concat: [{$toUpper: '$s'}, '-', {$substrBytes: ['$s', 0, 1]}]}}"),
+        {BSON("s"
+              << "abc"),
+         BSON("s" << BSONNULL)});
+}
+
+TEST(CompiledExpressionTest, DoesNotEvaluateOperandsAfterNullishFirstOperand) {
+    // The second operand would throw if it were evaluated.
+    assertCompiledMatches(fromjson("{expr: {$add: ['$a', {$divide: [1, '$zero']}]}}"),
+                          {BSON("zero" << 0), BSON("a" << BSONNULL << "zero" << 0)});
+}
+
+TEST(CompiledExpressionTest, RaisesSameErrorsAsInterpreter) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto expr = Expression::parseOperand(expCtx,
+                                         fromjson("{expr: {$add: ['$a', '$b']}}").firstElement(),
+                                         expCtx->variablesParseState);
+    auto compiled = CompiledExpression::compile(expr->optimize());
+
+    Document root{{"a", "str"_sd}, {"b", 1}};
+    ASSERT_THROWS_CODE(compiled.evaluate(root), AssertionException, 16554);
+}
+
+TEST(CompiledExpressionTest, MultiplyRejectsDateFirstOperandBeforeEvaluatingSecond) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    // The second operand would throw a different error if it were evaluated.
+    auto expr = Expression::parseOperand(
+        expCtx,
+        fromjson("{expr: {$multiply: ['$a', {$divide: [1, '$zero']}]}}").firstElement(),
+        expCtx->variablesParseState);
+    auto compiled = CompiledExpression::compile(expr->optimize());
+
+    Document root{{"a", Date_t::fromMillisSinceEpoch(1000)}, {"zero", 0}};
+    ASSERT_THROWS_CODE(expr->evaluate(root), AssertionException, 16555);
+    ASSERT_THROWS_CODE(compiled.evaluate(root), AssertionException, 16555);
+}
+
+}  // namespace
+}  // namespace mongo
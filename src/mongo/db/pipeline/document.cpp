@@ -30,6 +30,7 @@
 
 #include "mongo/db/pipeline/document.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 
 #include "mongo/bson/bson_depth.h"
@@ -48,7 +49,7 @@ const DocumentStorage DocumentStorage::kEmptyDoc;
 const std::vector<StringData> Document::allMetadataFieldNames = {
     Document::metaFieldTextScore, Document::metaFieldRandVal, Document::metaFieldSortKey};
 
-Position DocumentStorage::findField(StringData requested) const {
+Position DocumentStorage::findFieldInCache(StringData requested) const {
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
     if (_numFields >= HASH_TAB_MIN) {  // hash lookup
@@ -65,7 +66,7 @@ Position DocumentStorage::findField(StringData requested) const {
             pos = elem.nextCollision;
         }
     } else {  // linear scan
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = cacheIterator(); !it.atEnd(); it.advance()) {
             if (it->nameLen == reqSize && memcmp(requested.rawData(), it->_name, reqSize) == 0) {
                 return it.position();
             }
@@ -76,7 +77,7 @@ Position DocumentStorage::findField(StringData requested) const {
     return Position();
 }
 
-Value& DocumentStorage::appendField(StringData name) {
+Value& DocumentStorage::appendFieldToCache(StringData name) {
     Position pos = getNextPosition();
     const int nameSize = name.size();
 
@@ -103,7 +104,7 @@ Value& DocumentStorage::appendField(StringData name) {
 #undef append
 
     // Make sure next field starts where we expect it
-    fassert(16486, getField(pos).next()->ptr() == _buffer + _usedBytes);
+    fassert(16486, getCachedField(pos).next()->ptr() == _buffer + _usedBytes);
 
     _numFields++;
 
@@ -114,12 +115,93 @@ Value& DocumentStorage::appendField(StringData name) {
         rehash();
     }
 
-    return getField(pos).val;
+    return getCachedField(pos).val;
+}
+
+DocumentStorage::DocumentStorage(BSONObj bson, bool stripMetadata, size_t bsonDepthBound)
+    : DocumentStorage() {
+    invariant(bson.isOwned());
+    _bson = std::move(bson);
+    _bsonDepthBound = bsonDepthBound;
+    _bsonNext = _bson.isEmpty() ? nullptr : _bson.firstElement().rawdata();
+
+    if (!stripMetadata)
+        return;
+
+    // Metadata must be available without loading any fields, so parse it up front. Only field
+    // names are examined, which is much cheaper than converting the fields.
+    for (auto&& elem : _bson) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName[0] != '$')
+            continue;
+
+        if (fieldName == Document::metaFieldTextScore) {
+            setTextScore(elem.Double());
+        } else if (fieldName == Document::metaFieldRandVal) {
+            setRandMetaField(elem.Double());
+        } else if (fieldName == Document::metaFieldSortKey) {
+            setSortKeyMetaField(elem.Obj());
+        } else {
+            continue;
+        }
+        _stripMetadata = true;
+    }
+}
+
+namespace {
+size_t computeBsonDepth(const BSONObj& obj) {
+    size_t maxNestedDepth = 0;
+    for (auto&& elem : obj) {
+        if (elem.type() == Object || elem.type() == Array) {
+            maxNestedDepth = std::max(maxNestedDepth, computeBsonDepth(elem.embeddedObject()));
+        }
+    }
+    return maxNestedDepth + 1;
+}
+}  // namespace
+
+bool DocumentStorage::bsonDepthWithin(size_t maxDepth) const {
+    if (_bsonDepthBound && _bsonDepthBound <= maxDepth) {
+        return true;
+    }
+
+    if (!_bsonDepth) {
+        _bsonDepth = computeBsonDepth(_bson);
+    }
+    return _bsonDepth <= maxDepth;
+}
+
+Position DocumentStorage::loadLazyFields(const StringData* name) {
+    while (_bsonNext) {
+        BSONElement elem(_bsonNext);
+        if (elem.eoo()) {
+            _bsonNext = nullptr;
+            break;
+        }
+        _bsonNext += elem.size();
+
+        auto fieldName = elem.fieldNameStringData();
+        if (_stripMetadata && fieldName[0] == '$' &&
+            (fieldName == Document::metaFieldTextScore ||
+             fieldName == Document::metaFieldRandVal || fieldName == Document::metaFieldSortKey)) {
+            continue;
+        }
+
+        // Nested objects share the backing BSON instead of copying it, and inherit a bound on
+        // their depth, so that serializing them does not need to walk their BSON again
+        const size_t depthBound = _bsonDepth ? _bsonDepth : _bsonDepthBound;
+        const Position pos = getNextPosition();
+        appendFieldToCache(fieldName) = Value(elem, _bson, depthBound ? depthBound - 1 : 0);
+        if (name && fieldName == *name)
+            return pos;
+    }
+
+    return Position();
 }
 
 // Call after adding field to _fields and increasing _numFields
 void DocumentStorage::addFieldToHashTable(Position pos) {
-    ValueElement& elem = getField(pos);
+    ValueElement& elem = getCachedField(pos);
     elem.nextCollision = Position();
 
     const unsigned bucket = bucketForKey(elem.nameSD());
@@ -127,7 +209,7 @@ void DocumentStorage::addFieldToHashTable(Position pos) {
     Position* posPtr = &_hashTab[bucket];
     while (posPtr->found()) {
         // collision: walk links and add new to end
-        posPtr = &getField(*posPtr).nextCollision;
+        posPtr = &getCachedField(*posPtr).nextCollision;
     }
     *posPtr = Position(pos.index);
 }
@@ -148,13 +230,14 @@ void DocumentStorage::alloc(unsigned newSize) {
 
     uassert(16490, "Tried to make oversized document", capacity <= size_t(BufferMaxSize));
 
-    std::unique_ptr<char[]> oldBuf(_buffer);
-    _buffer = new char[capacity];
+    char* const oldBuf = _buffer;
+    ValueArena::Block* const oldBlock = _bufferBlock;
+    _buffer = ValueArena::allocate(capacity, &_bufferBlock);
     _bufferEnd = _buffer + capacity - hashTabBytes();
 
     if (!firstAlloc) {
         // This just copies the elements
-        memcpy(_buffer, oldBuf.get(), _usedBytes);
+        memcpy(_buffer, oldBuf, _usedBytes);
 
         if (_numFields >= HASH_TAB_MIN) {
             // if we were hashing, deal with the hash table
@@ -162,9 +245,11 @@ void DocumentStorage::alloc(unsigned newSize) {
                 rehash();
             } else {
                 // no rehash needed so just slide table down to new position
-                memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                memcpy(_hashTab, oldBuf + oldCapacity, hashTabBytes());
             }
         }
+
+        ValueArena::deallocate(oldBuf, oldBlock);
     }
 }
 
@@ -181,7 +266,7 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 
     uassert(16491, "Tried to make oversized document", newSize <= size_t(BufferMaxSize));
 
-    _buffer = new char[newSize + hashTabBytes()];
+    _buffer = ValueArena::allocate(newSize + hashTabBytes(), &_bufferBlock);
     _bufferEnd = _buffer + newSize;
 }
 
@@ -191,9 +276,9 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     // Make a copy of the buffer.
     // It is very important that the positions of each field are the same after cloning.
     const size_t bufferBytes = allocatedBytes();
-    out->_buffer = new char[bufferBytes];
-    out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
     if (bufferBytes > 0) {
+        out->_buffer = ValueArena::allocate(bufferBytes, &out->_bufferBlock);
+        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
         memcpy(out->_buffer, _buffer, bufferBytes);
     }
 
@@ -205,33 +290,67 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     out->_textScore = _textScore;
     out->_randVal = _randVal;
     out->_sortKey = _sortKey.getOwned();
+    out->_bson = _bson;
+    out->_bsonNext = _bsonNext;
+    out->_stripMetadata = _stripMetadata;
+    out->_bsonDepth = _bsonDepth;
+    out->_bsonDepthBound = _bsonDepthBound;
 
     // Tell values that they have been memcpyed (updates ref counts)
-    for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+    for (DocumentStorageIterator it = out->cacheIterator(); !it.atEnd(); it.advance()) {
         it->val.memcpyed();
     }
 
     return out;
 }
 
-DocumentStorage::~DocumentStorage() {
-    std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
+intrusive_ptr<DocumentStorage> DocumentStorage::cloneOwned(bool outsideArena) const {
+    ValueArena::Scope heapScope(nullptr);
 
-    for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
-        it->val.~Value();  // explicit destructor call
+    if (!outsideArena && bsonIsView()) {
+        // The fields are loaded again from the copy when they are accessed.
+        intrusive_ptr<DocumentStorage> out(new DocumentStorage(
+            _bson.copy(), _stripMetadata, _bsonDepth ? _bsonDepth : _bsonDepthBound));
+        out->copyMetaDataFrom(*this);
+        return out;
     }
+
+    // Fields loaded later would be allocated from whichever arena is installed at the time.
+    if (outsideArena) {
+        loadAllLazyFields();
+    }
+    intrusive_ptr<DocumentStorage> out = clone();
+    if (outsideArena && bsonIsView()) {
+        // Every field is loaded, so the copy does not need the BSON it would keep alive.
+        out->_bson = BSONObj();
+        out->_stripMetadata = false;
+        out->_bsonDepth = 0;
+        out->_bsonDepthBound = 0;
+    }
+
+    // Replaced in place, since getField() would make the copy modifiable and drop its BSON.
+    for (DocumentStorageIterator it = out->cacheIterator(); !it.atEnd(); it.advance()) {
+        ValueElement* elem = out->_firstElement->plusBytes(it.position().index);
+        elem->val = elem->val.getOwned(outsideArena);
+    }
+
+    return out;
 }
 
-Document::Document(const BSONObj& bson) {
-    MutableDocument md(bson.nFields());
+DocumentStorage::~DocumentStorage() {
+    for (DocumentStorageIterator it = cacheIterator(); !it.atEnd(); it.advance()) {
+        it->val.~Value();  // explicit destructor call
+    }
 
-    BSONObjIterator it(bson);
-    while (it.more()) {
-        BSONElement bsonElement(it.next());
-        md.addField(bsonElement.fieldNameStringData(), Value(bsonElement));
+    if (_buffer) {
+        ValueArena::deallocate(_buffer, _bufferBlock);
     }
+}
 
-    *this = md.freeze();
+Document::Document(const BSONObj& bson) {
+    if (!bson.isEmpty()) {
+        _storage = new DocumentStorage(bson.getOwned(), false);
+    }
 }
 
 Document::Document(std::initializer_list<std::pair<StringData, ImplicitValue>> initializerList) {
@@ -258,12 +377,26 @@ void Document::toBson(BSONObjBuilder* builder, size_t recursionLevel) const {
                           << " levels of nesting",
             recursionLevel <= BSONDepth::getMaxAllowableDepth());
 
+    // An unmodified document can copy its backing BSON as is, unless that would exceed the
+    // nesting limit. In that case, fall through so that the limit is enforced as usual.
+    auto bson = storage().unmodifiedBson();
+    if (bson &&
+        storage().bsonDepthWithin(BSONDepth::getMaxAllowableDepth() + 1 - recursionLevel)) {
+        builder->appendElements(*bson);
+        return;
+    }
+
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
         it->val.addToBsonObj(builder, it->nameSD(), recursionLevel);
     }
 }
 
 BSONObj Document::toBson() const {
+    auto bson = storage().unmodifiedBson();
+    if (bson && storage().bsonDepthWithin(BSONDepth::getMaxAllowableDepth())) {
+        return *bson;
+    }
+
     BSONObjBuilder bb;
     toBson(&bb);
     return bb.obj();
@@ -286,30 +419,12 @@ BSONObj Document::toBsonWithMetaData() const {
 }
 
 Document Document::fromBsonWithMetaData(const BSONObj& bson) {
-    MutableDocument md;
-
-    BSONObjIterator it(bson);
-    while (it.more()) {
-        BSONElement elem(it.next());
-        auto fieldName = elem.fieldNameStringData();
-        if (fieldName[0] == '$') {
-            if (fieldName == metaFieldTextScore) {
-                md.setTextScore(elem.Double());
-                continue;
-            } else if (fieldName == metaFieldRandVal) {
-                md.setRandMetaField(elem.Double());
-                continue;
-            } else if (fieldName == metaFieldSortKey) {
-                md.setSortKeyMetaField(elem.Obj());
-                continue;
-            }
-        }
-
-        // Note: this will not parse out metadata in embedded documents.
-        md.addField(fieldName, Value(elem));
+    if (bson.isEmpty()) {
+        return Document();
     }
 
-    return md.freeze();
+    // Note: this will not parse out metadata in embedded documents.
+    return Document(new DocumentStorage(bson.getOwned(), true));
 }
 
 MutableDocument::MutableDocument(size_t expectedFields)
@@ -382,8 +497,10 @@ size_t Document::getApproximateSize() const {
 
     size_t size = sizeof(DocumentStorage);
     size += storage().allocatedBytes();
+    size += storage().bsonBytes();
 
-    for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+    // Only count the fields loaded so far; the rest are accounted for by the backing BSON.
+    for (DocumentStorageIterator it = storage().cacheIterator(); !it.atEnd(); it.advance()) {
         size += it->val.getApproximateSize();
         size -= sizeof(Value);  // already accounted for above
     }
@@ -391,6 +508,37 @@ size_t Document::getApproximateSize() const {
     return size;
 }
 
+Document Document::getOwned(bool outsideArena) const {
+    if (isOwned(outsideArena))
+        return *this;
+
+    return Document(storage().cloneOwned(outsideArena).get());
+}
+
+bool Document::isOwned(bool outsideArena) const {
+    if (!_storage)
+        return true;
+
+    if (outsideArena && (storage().usesArena() || storage().hasLazyFields()))
+        return false;
+
+    if (storage().bsonBytes()) {
+        if (storage().bsonIsView())
+            return false;
+
+        // The loaded fields share the BSON's own buffer, which getApproximateSize() counts.
+        if (!outsideArena)
+            return true;
+    }
+
+    for (DocumentStorageIterator it = storage().cacheIterator(); !it.atEnd(); it.advance()) {
+        if (!it->val.isOwned(outsideArena))
+            return false;
+    }
+
+    return true;
+}
+
 void Document::hash_combine(size_t& seed,
                             const StringData::ComparatorInterface* stringComparator) const {
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
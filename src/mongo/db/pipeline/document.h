@@ -273,9 +273,19 @@ public:
     int memUsageForSorter() const {
         return getApproximateSize();
     }
-    Document getOwned() const {
-        return *this;
-    }
+
+    /**
+     * Returns this document, or a copy of it for stages to retain beyond the current getNext()
+     * call. A retained document must not keep alive memory that its getApproximateSize() does not
+     * count: documents nested in lazily loaded BSON share their parent's buffer, so the copy gets
+     * its own BSON instead. If 'outsideArena' is set, which stages of pipelines using a ValueArena
+     * pass, the copy also has all its fields, and those of its subdocuments, loaded into heap
+     * buffers, so that neither it nor later accesses to it pin arena blocks.
+     */
+    Document getOwned(bool outsideArena = false) const;
+
+    /// Returns whether getOwned(outsideArena) would return this document itself.
+    bool isOwned(bool outsideArena = false) const;
 
     /// only for testing
     const void* getPtr() const {
@@ -287,6 +297,7 @@ private:
     friend class ValueStorage;
     friend class MutableDocument;
     friend class MutableValue;
+    friend class Value;  // to create Documents sharing ownership of their BSON
 
     explicit Document(const DocumentStorage* ptr) : _storage(ptr){};
 
@@ -34,7 +34,9 @@
 #include <boost/intrusive_ptr.hpp>
 
 #include "mongo/base/static_assert.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_arena.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
@@ -178,7 +180,14 @@ private:
     bool _includeMissing;
 };
 
-/// Storage class used by both Document and MutableDocument
+/** Storage class used by both Document and MutableDocument
+ *
+ *  A DocumentStorage may be backed by the BSONObj it was created from. Such a storage converts
+ *  fields into its buffer lazily, in BSON order, when they are first looked up, so the buffer
+ *  always holds a prefix of the BSON's fields and previously returned Positions stay valid. Any
+ *  modification first loads the remaining fields and drops the BSON. Because lookups on a const
+ *  storage may load fields, a Document must not be read concurrently from several threads.
+ */
 class DocumentStorage : public RefCountable {
 public:
     DocumentStorage()
@@ -187,10 +196,20 @@ public:
           _usedBytes(0),
           _numFields(0),
           _hashTabMask(0),
+          _bsonNext(nullptr),
+          _stripMetadata(false),
           _metaFields(),
           _textScore(0),
           _randVal(0) {}
 
+    /**
+     * Creates a storage lazily backed by 'bson', which must be owned. If 'stripMetadata' is true,
+     * top-level fields with the names of Document's metadata fields are parsed into metadata
+     * instead of being treated as fields. 'bsonDepthBound' is an upper bound on the nesting depth
+     * of 'bson', if known, or 0 otherwise.
+     */
+    DocumentStorage(BSONObj bson, bool stripMetadata, size_t bsonDepthBound = 0);
+
     ~DocumentStorage();
 
     enum MetaType : char {
@@ -207,6 +226,7 @@ public:
 
     size_t size() const {
         // can't use _numFields because it includes removed Fields
+        loadAllLazyFields();
         size_t count = 0;
         for (DocumentStorageIterator it = iterator(); !it.atEnd(); it.advance())
             count++;
@@ -219,7 +239,12 @@ public:
     }
 
     /// Returns the position of the named field (may be missing) or Position()
-    Position findField(StringData name) const;
+    Position findField(StringData name) const {
+        Position pos = findFieldInCache(name);
+        if (pos.found() || !_bsonNext)
+            return pos;
+        return const_cast<DocumentStorage*>(this)->loadLazyFields(&name);
+    }
 
     // Document uses these
     const ValueElement& getField(Position pos) const {
@@ -236,9 +261,11 @@ public:
     // MutableDocument uses these
     ValueElement& getField(Position pos) {
         verify(pos.found());
+        makeModifiable();
         return *(_firstElement->plusBytes(pos.index));
     }
     Value& getField(StringData name) {
+        makeModifiable();
         Position pos = findField(name);
         if (!pos.found())
             return appendField(name);  // TODO: find a way to avoid hashing name twice
@@ -246,7 +273,10 @@ public:
     }
 
     /// Adds a new field with missing Value at the end of the document
-    Value& appendField(StringData name);
+    Value& appendField(StringData name) {
+        makeModifiable();
+        return appendFieldToCache(name);
+    }
 
     /** Preallocates space for fields. Use this to attempt to prevent buffer growth.
      *  This is only valid to call before anything is added to the document.
@@ -255,21 +285,74 @@ public:
 
     /// This skips missing values
     DocumentStorageIterator iterator() const {
+        loadAllLazyFields();
         return DocumentStorageIterator(_firstElement, end(), false);
     }
 
     /// This includes missing values
     DocumentStorageIterator iteratorAll() const {
-        return DocumentStorageIterator(_firstElement, end(), true);
+        loadAllLazyFields();
+        return cacheIterator();
+    }
+
+    /**
+     * Returns the BSONObj backing this storage if the storage has not been modified since it was
+     * created from it and the BSON holds exactly the storage's fields, or nullptr otherwise.
+     */
+    const BSONObj* unmodifiedBson() const {
+        return _bson.isOwned() && !_stripMetadata ? &_bson : nullptr;
     }
 
+    /**
+     * Returns whether the nesting depth of the backing BSON, counting the BSON itself and each
+     * embedded object or array as one level, is at most 'maxDepth'. The depth is only computed if
+     * the bound inherited from the enclosing document does not already answer this.
+     */
+    bool bsonDepthWithin(size_t maxDepth) const;
+
     /// Shallow copy of this. Caller owns memory.
     boost::intrusive_ptr<DocumentStorage> clone() const;
 
+    /**
+     * Clones this storage for Document::getOwned(outsideArena). A storage whose BSON is part of a
+     * larger buffer gets a copy of it instead. Otherwise each loaded value is replaced with its
+     * getOwned() copy. If 'outsideArena' is set, all lazy fields are loaded first, and the clone
+     * is allocated from the heap.
+     */
+    boost::intrusive_ptr<DocumentStorage> cloneOwned(bool outsideArena) const;
+
+    /**
+     * Returns whether the backing BSON is a part of a larger buffer, such as that of the
+     * document it is nested in, which this storage keeps alive without counting it.
+     */
+    bool bsonIsView() const {
+        return _bson.isOwned() && _bson.objdata() != _bson.sharedBuffer().get();
+    }
+
+    /// Returns whether the buffer of this storage was allocated from a ValueArena.
+    bool usesArena() const {
+        return _bufferBlock;
+    }
+
+    /// Returns whether some fields of the backing BSON have not been loaded yet.
+    bool hasLazyFields() const {
+        return _bsonNext;
+    }
+
     size_t allocatedBytes() const {
         return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
     }
 
+    /// Size of the backing BSON, which is shared with other owners of the same buffer.
+    size_t bsonBytes() const {
+        return _bson.isOwned() ? _bson.objsize() : 0;
+    }
+
+    /// Iterates over the fields loaded so far, including missing values, without loading more.
+    DocumentStorageIterator cacheIterator() const {
+        return DocumentStorageIterator(_firstElement, end(), true);
+    }
+
     /**
      * Copies all metadata from source if it has any.
      * Note: does not clear metadata from this.
@@ -328,6 +411,38 @@ private:
     /// Allocates space in _buffer. Copies existing data if there is any.
     void alloc(unsigned newSize);
 
+    /// Like getField(Position), but does not make the storage modifiable.
+    ValueElement& getCachedField(Position pos) {
+        return *(_firstElement->plusBytes(pos.index));
+    }
+
+    /// Looks up a field among the fields loaded so far.
+    Position findFieldInCache(StringData name) const;
+
+    /// Adds a new field with missing Value at the end of the loaded fields.
+    Value& appendFieldToCache(StringData name);
+
+    /**
+     * Loads fields from the backing BSON in order until a field named '*name' has been loaded,
+     * and returns its Position. If 'name' is null or no such field remains, loads every remaining
+     * field and returns Position().
+     */
+    Position loadLazyFields(const StringData* name);
+
+    void loadAllLazyFields() const {
+        if (_bsonNext)
+            const_cast<DocumentStorage*>(this)->loadLazyFields(nullptr);
+    }
+
+    /// Loads all remaining fields and drops the backing BSON, which would not reflect changes.
+    void makeModifiable() {
+        if (_bson.isOwned()) {
+            loadAllLazyFields();
+            _bson = BSONObj();
+            _stripMetadata = false;
+        }
+    }
+
     /// Call after adding field to _buffer and increasing _numFields
     void addFieldToHashTable(Position pos);
 
@@ -363,7 +478,7 @@ private:
     /// Adds all fields to the hash table
     void rehash() {
         hashTabInit();
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance())
+        for (DocumentStorageIterator it = cacheIterator(); !it.atEnd(); it.advance())
             addFieldToHashTable(it.position());
     }
 
@@ -393,10 +508,18 @@ private:
         Position* _hashTab;  // table lazily initialized once _numFields == HASH_TAB_MIN
     };
 
+    ValueArena::Block* _bufferBlock = nullptr;  // arena block owning _buffer, or null for the heap
+
     unsigned _usedBytes;    // position where next field would start
     unsigned _numFields;    // this includes removed fields
     unsigned _hashTabMask;  // equal to hashTabBuckets()-1 but used more often
 
+    BSONObj _bson;          // owned BSON backing this storage, if any
+    const char* _bsonNext;  // next BSON element to load, or null once all fields are loaded
+    bool _stripMetadata;    // true if _bson has metadata fields which are not loaded as fields
+    mutable size_t _bsonDepth = 0;  // nesting depth of _bson, or 0 if not yet computed
+    size_t _bsonDepthBound = 0;     // upper bound on the depth of _bson, or 0 if unknown
+
     std::bitset<MetaType::NUM_FIELDS> _metaFields;
     double _textScore;
     double _randVal;
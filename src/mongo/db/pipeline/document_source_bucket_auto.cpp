@@ -104,10 +104,11 @@ DocumentSource::GetNextResult DocumentSourceBucketAuto::populateSorter() {
         _sorter.reset(Sorter<Value, Document>::make(opts, comparator));
     }
 
+    const bool outsideArena = bool(pExpCtx->valueArena);
     auto next = pSource->getNext();
     for (; next.isAdvanced(); next = pSource->getNext()) {
-        auto nextDoc = next.releaseDocument();
-        _sorter->add(extractKey(nextDoc), nextDoc);
+        auto nextDoc = next.releaseDocument().getOwned(outsideArena);
+        _sorter->add(extractKey(nextDoc).getOwned(outsideArena), nextDoc);
         _nDocuments++;
     }
     return next;
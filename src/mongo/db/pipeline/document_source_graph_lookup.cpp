@@ -251,7 +251,7 @@ bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long lo
     // '_frontier'.
     document_path_support::visitAllValuesAtPath(
         result, _connectFromField, [this](const Value& nextFrontierValue) {
-            _frontier.insert(nextFrontierValue);
+            _frontier.insert(nextFrontierValue.getOwned(bool(pExpCtx->valueArena)));
             _frontierUsageBytes += nextFrontierValue.getApproximateSize();
         });
 
@@ -259,7 +259,8 @@ bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long lo
     _visitedUsageBytes += id.getApproximateSize();
     _visitedUsageBytes += result.getApproximateSize();
 
-    _visited[id] = std::move(result);
+    const bool outsideArena = bool(pExpCtx->valueArena);
+    _visited[id.getOwned(outsideArena)] = result.getOwned(outsideArena);
 
     // We inserted into _visited, so return true.
     return true;
@@ -333,16 +334,17 @@ void DocumentSourceGraphLookUp::performSearch() {
     // Make sure _input is set before calling performSearch().
     invariant(_input);
 
+    const bool outsideArena = bool(pExpCtx->valueArena);
     Value startingValue = _startWith->evaluate(*_input);
 
     // If _startWith evaluates to an array, treat each value as a separate starting point.
     if (startingValue.isArray()) {
         for (auto value : startingValue.getArray()) {
-            _frontier.insert(value);
+            _frontier.insert(value.getOwned(outsideArena));
             _frontierUsageBytes += value.getApproximateSize();
         }
     } else {
-        _frontier.insert(startingValue);
+        _frontier.insert(startingValue.getOwned(outsideArena));
         _frontierUsageBytes += startingValue.getApproximateSize();
     }
 
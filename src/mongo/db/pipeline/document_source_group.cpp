@@ -39,6 +39,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 
@@ -110,17 +111,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         _firstPartOfNextGroup = _sorterIterator->next();
     }
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    return makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     // Not spilled, and not streaming.
-    if (_groups->empty())
+    if (!_groups || _groups->empty())
         return GetNextResult::makeEOF();
 
-    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    Document out = makeDocument(
+        _groups->getId(_nextGroup), _groups->getAccumulators(_nextGroup), pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (++_nextGroup == _groups->size())
         dispose();
 
     return std::move(out);
@@ -158,7 +160,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
         id = computeId(*_firstDocOfNextGroup);
     } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    Document out = makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
     _currentId = std::move(id);
 
     return std::move(out);
@@ -166,11 +168,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
-    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _groups = boost::none;
     _sorterIterator.reset();
 
     // Make us look done.
-    groupsIterator = _groups->end();
+    _nextGroup = 0;
 
     _firstDocOfNextGroup = boost::none;
 }
@@ -264,7 +266,6 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
-      _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
@@ -375,14 +376,16 @@ private:
 
 class SpillSTLComparator {
 public:
-    SpillSTLComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
+    SpillSTLComparator(ValueComparator valueComparator, const GroupsMap* groups)
+        : _valueComparator(valueComparator), _groups(groups) {}
 
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return _valueComparator.evaluate(lhs->first < rhs->first);
+    bool operator()(size_t lhs, size_t rhs) const {
+        return _valueComparator.evaluate(_groups->getId(lhs) < _groups->getId(rhs));
     }
 
 private:
     ValueComparator _valueComparator;
+    const GroupsMap* _groups;
 };
 
 bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
@@ -478,9 +481,32 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     }
 
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'. Documents are
+    // accumulated in batches. A batch is processed early when its values could push the memory
+    // usage over the limit, so that the limit is checked as often as it would be without batching.
+    const bool outsideArena = bool(pExpCtx->valueArena);
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
+        // We release the result document here so that it does not outlive the end of this loop
+        // iteration. Not releasing could lead to an array copy when this group follows an unwind.
+        auto rootDocument = input.releaseDocument();
+        // Ids and accumulator inputs may be retained by the groups.
+        Value id = computeId(rootDocument).getOwned(outsideArena);
+        size_t rowBytes = id.getApproximateSize();
+        _inputBatch.ids.push_back(std::move(id));
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _inputBatch.inputs.push_back(
+                accumulatedField.expression->evaluate(rootDocument).getOwned(outsideArena));
+            rowBytes += _inputBatch.inputs.back().getApproximateSize();
+        }
+
+        const size_t batchSize = _inputBatch.ids.size();
+        if (batchSize > 1 &&
+            (batchSize > kMaxInputBatchSize ||
+             _memoryUsageBytes + _inputBatch.bytes + rowBytes > _maxMemoryUsageBytes)) {
+            processInputBatch(batchSize - 1);
+        }
+
         if (_memoryUsageBytes > _maxMemoryUsageBytes) {
             uassert(16945,
                     "Exceeded memory limit for $group, but didn't allow external sort."
@@ -490,55 +516,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             _memoryUsageBytes = 0;
         }
 
-        // We release the result document here so that it does not outlive the end of this loop
-        // iteration. Not releasing could lead to an array copy when this group follows an unwind.
-        auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
-                              _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
-
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+        _inputBatch.bytes += rowBytes;
     }
 
+    processInputBatch(_inputBatch.ids.size());
+
     switch (input.getStatus()) {
         case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
             MONGO_UNREACHABLE;  // We consumed all advances above.
@@ -550,12 +532,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             // Do any final steps necessary to prepare to output results.
             if (!_sortedFiles.empty()) {
                 _spilled = true;
-                if (!_groups->empty()) {
+                if (_groups && !_groups->empty()) {
                     _sortedFiles.push_back(spill());
                 }
 
                 // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+                _groups = boost::none;
 
                 _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
                     _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
@@ -570,7 +552,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                 _firstPartOfNextGroup = _sorterIterator->next();
             } else {
                 // start the group iterator
-                groupsIterator = _groups->begin();
+                _nextGroup = 0;
             }
 
             // This must happen last so that, unless control gets here, we will re-enter
@@ -582,37 +564,123 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+void DocumentSourceGroup::processInputBatch(size_t numRows) {
+    const size_t numAccumulators = _accumulatedFields.size();
+    invariant(numRows <= _inputBatch.ids.size());
+
+    if (!_groups) {
+        _groups.emplace(pExpCtx->getValueComparator(), numAccumulators);
+    }
+
+    // Look up the group of each row, adding a new entry with blank accumulators for ids which are
+    // not in the map yet, and gather the positions in the batch of each group's rows. Groups are
+    // referred to by index, since adding a group may move the accumulators of the others.
+    std::vector<std::pair<size_t, std::vector<size_t>>> batchGroups;
+    stdx::unordered_map<size_t, size_t> batchGroupIndexes;
+    bool sawDuplicate = false;
+    for (size_t row = 0; row < numRows; ++row) {
+        const Value& id = _inputBatch.ids[row];
+
+        const size_t oldTableBytes = _groups->memUsageBytes();
+        bool inserted;
+        const size_t groupIndex = _groups->findOrInsert(id, &inserted);
+
+        if (inserted) {
+            // The memory of the table itself includes the Value holding the id, so only the memory
+            // owned by the id is added on top of it.
+            _memoryUsageBytes += _groups->memUsageBytes() - oldTableBytes;
+            _memoryUsageBytes += id.getApproximateSize() - sizeof(Value);
+
+            // Add the accumulators
+            auto group = _groups->getAccumulators(groupIndex);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i] = _accumulatedFields[i].makeAccumulator(pExpCtx);
+                _memoryUsageBytes += group[i]->memUsageForSorter();
+            }
+        } else {
+            sawDuplicate = true;
+        }
+
+        auto indexIt = batchGroupIndexes.emplace(groupIndex, batchGroups.size());
+        if (indexIt.second) {
+            batchGroups.emplace_back(groupIndex, std::vector<size_t>());
+        }
+        batchGroups[indexIt.first->second].second.push_back(row);
+    }
+
+    /* tickle all the accumulators for the groups we found */
+    std::vector<Value> inputs;
+    for (auto&& batchGroup : batchGroups) {
+        auto group = _groups->getAccumulators(batchGroup.first);
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            inputs.clear();
+            for (size_t row : batchGroup.second) {
+                inputs.push_back(std::move(_inputBatch.inputs[row * numAccumulators + i]));
+            }
+
+            // Subtract the old memory usage, and add back the new usage after processing.
+            _memoryUsageBytes -= group[i]->memUsageForSorter();
+            group[i]->processBatch(inputs.data(), inputs.size(), _doingMerge);
+            _memoryUsageBytes += group[i]->memUsageForSorter();
+        }
+    }
+
+    // Keep any rows past 'numRows' for the next batch.
+    _inputBatch.ids.erase(_inputBatch.ids.begin(), _inputBatch.ids.begin() + numRows);
+    _inputBatch.inputs.erase(_inputBatch.inputs.begin(),
+                             _inputBatch.inputs.begin() + numRows * numAccumulators);
+    _inputBatch.bytes = 0;
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (sawDuplicate &&              // is a dup
+            !pExpCtx->inMongos &&        // can't spill to disk in mongos
+            !_allowDiskUse &&            // don't change behavior when testing external sort
+            _sortedFiles.size() < 20) {  // don't open too many FDs
+
+            _sortedFiles.push_back(spill());
+            _memoryUsageBytes = 0;
+        }
+    }
+}
+
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    vector<size_t> groups;  // using indexes to speed sorting
+    groups.reserve(_groups->size());
+    for (size_t i = 0; i < _groups->size(); i++) {
+        groups.push_back(i);
     }
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+    stable_sort(groups.begin(),
+                groups.end(),
+                SpillSTLComparator(pExpCtx->getValueComparator(), _groups.get_ptr()));
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+    const size_t numAccumulators = _groups->getNumAccumulators();
+    switch (numAccumulators) {
+        case 0:  // no values, essentially a distinct
+            for (size_t i = 0; i < groups.size(); i++) {
+                writer.addAlreadySorted(_groups->getId(groups[i]), Value());
             }
             break;
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+            for (size_t i = 0; i < groups.size(); i++) {
+                writer.addAlreadySorted(
+                    _groups->getId(groups[i]),
+                    _groups->getAccumulators(groups[i])[0]->getValue(/*toBeMerged=*/true));
             }
             break;
 
         default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
+            for (size_t i = 0; i < groups.size(); i++) {
+                auto group = _groups->getAccumulators(groups[i]);
                 vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+                for (size_t j = 0; j < numAccumulators; j++) {
+                    accums.push_back(group[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer.addAlreadySorted(_groups->getId(groups[i]), Value(std::move(accums)));
             }
             break;
     }
@@ -806,7 +874,7 @@ Value DocumentSourceGroup::expandId(const Value& val) {
 }
 
 Document DocumentSourceGroup::makeDocument(const Value& id,
-                                           const Accumulators& accums,
+                                           const intrusive_ptr<Accumulator>* accums,
                                            bool mergeableOutput) {
     const size_t n = _accumulatedFields.size();
     MutableDocument out(1 + n);
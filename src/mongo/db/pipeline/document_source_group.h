@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/group_table.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -41,7 +42,7 @@ namespace mongo {
 class DocumentSourceGroup final : public DocumentSource, public SplittableDocumentSource {
 public:
     using Accumulators = std::vector<boost::intrusive_ptr<Accumulator>>;
-    using GroupsMap = ValueUnorderedMap<Accumulators>;
+    using GroupsMap = GroupTable;
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
@@ -143,7 +144,16 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
-    Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+    /**
+     * Accumulates the first 'numRows' rows of '_inputBatch' into their groups and removes them from
+     * the batch. The inputs of each group are handed to each of its accumulators in a single
+     * processBatch() call, in their original order.
+     */
+    void processInputBatch(size_t numRows);
+
+    Document makeDocument(const Value& id,
+                          const boost::intrusive_ptr<Accumulator>* accums,
+                          bool mergeableOutput);
 
     /**
      * Computes the internal representation of the group key.
@@ -171,16 +181,29 @@ private:
     Value _currentId;
     Accumulators _currentAccumulators;
 
-    // We use boost::optional to defer initialization until the ExpressionContext containing the
-    // correct comparator is injected, since the groups must be built using the comparator's
-    // definition of equality.
+    // We use boost::optional to defer initialization until the first group is added, since the
+    // groups must be built using the definition of equality of the comparator in the
+    // ExpressionContext, which may be injected after construction.
     boost::optional<GroupsMap> _groups;
 
+    // The maximum number of documents an unsorted $group buffers before accumulating them.
+    static const size_t kMaxInputBatchSize = 128;
+
+    // The group ids and accumulator inputs computed by initialize() from documents which have not
+    // been accumulated yet. Row 'r' has the id 'ids[r]' and the input for accumulator 'i' at
+    // 'inputs[r * numAccumulators + i]'. 'bytes' estimates the size of the rows.
+    struct InputBatch {
+        std::vector<Value> ids;
+        std::vector<Value> inputs;
+        size_t bytes = 0;
+    };
+    InputBatch _inputBatch;
+
     std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     bool _spilled;
 
-    // Only used when '_spilled' is false.
-    GroupsMap::iterator groupsIterator;
+    // The index in '_groups' of the next group to return. Only used when '_spilled' is false.
+    size_t _nextGroup = 0;
 
     // Only used when '_spilled' is true.
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
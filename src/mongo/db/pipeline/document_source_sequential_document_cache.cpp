@@ -64,7 +64,7 @@ DocumentSource::GetNextResult DocumentSourceSequentialDocumentCache::getNext() {
         if (nextResult.isEOF()) {
             _cache->freeze();
         } else {
-            _cache->add(nextResult.getDocument());
+            _cache->add(nextResult.getDocument().getOwned(bool(pExpCtx->valueArena)));
         }
     }
 
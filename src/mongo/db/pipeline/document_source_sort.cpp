@@ -362,7 +362,8 @@ void DocumentSourceSort::loadDocument(Document&& doc) {
     // already computed the sort key we'd have split the pipeline there, would be merging presorted
     // documents, and wouldn't use this method.
     std::tie(sortKey, docForSorter) = extractSortKey(std::move(doc));
-    _sorter->add(sortKey, docForSorter);
+    const bool outsideArena = bool(pExpCtx->valueArena);
+    _sorter->add(sortKey.getOwned(outsideArena), docForSorter.getOwned(outsideArena));
 }
 
 void DocumentSourceSort::loadingDone() {
@@ -111,6 +111,80 @@ TEST(DocumentConstruction, FromEmptyDocumentClone) {
     ASSERT_DOCUMENT_EQ(document, documentClone);
 }
 
+TEST(DocumentConstruction, FromBsonLoadsFieldsInOrderOnDemand) {
+    BSONObj obj = BSON("a" << 1 << "b" << 2 << "c" << BSON("d" << 3));
+    Document document = fromBson(obj);
+    // Looking up a later field first must not change the order or Positions of the fields.
+    ASSERT_EQUALS(3, document["c"]["d"].getInt());
+    ASSERT_EQUALS(1, document["a"].getInt());
+    ASSERT_TRUE(document["z"].missing());
+    ASSERT_EQUALS(3U, document.size());
+    ASSERT_EQUALS("b", getNthField(document, 1).first.toString());
+    ASSERT_EQUALS(2, document[document.positionOf("b")].getInt());
+    assertRoundTrips(document);
+}
+
+TEST(DocumentSerialization, UnmodifiedDocumentSerializesToItsBson) {
+    BSONObj obj = BSON("a" << 1 << "b" << BSON("c" << 2));
+    Document document = fromBson(obj);
+    ASSERT_EQUALS(2, document["b"]["c"].getInt());
+    ASSERT_EQUALS(obj.objdata(), toBson(document).objdata());
+}
+
+TEST(DocumentSerialization, NestedDocumentsShareTheBsonOfTheirParent) {
+    BSONObj obj = BSON("a" << BSON("b" << BSON("c" << 1)) << "d" << BSON_ARRAY(BSON("e" << 2)));
+    Document document = fromBson(obj);
+
+    const Document a = document["a"].getDocument();
+    ASSERT_EQUALS(obj["a"].Obj().objdata(), a.toBson().objdata());
+    ASSERT_EQUALS(obj["a"]["b"].Obj().objdata(), a["b"].getDocument().toBson().objdata());
+
+    const Document inArray = document["d"][0].getDocument();
+    ASSERT_EQUALS(obj["d"].Obj()["0"].Obj().objdata(), inArray.toBson().objdata());
+    ASSERT_EQUALS(2, inArray["e"].getInt());
+}
+
+TEST(DocumentSerialization, RetainedNestedDocumentsGetTheirOwnBson) {
+    BSONObj obj = BSON("a" << BSON("b" << 1) << "d" << BSON_ARRAY(BSON("e" << 2)) << "padding"
+                           << std::string(1000, 'x'));
+    Document document = fromBson(obj);
+    ASSERT_TRUE(document.isOwned());
+
+    // A nested document keeps its parent's buffer alive, so it is copied when retained.
+    const Value a = document["a"];
+    ASSERT_FALSE(a.isOwned());
+    const Value ownedA = a.getOwned();
+    ASSERT_TRUE(ownedA.isOwned());
+    ASSERT_VALUE_EQ(a, ownedA);
+    ASSERT_NOT_EQUALS(obj["a"].Obj().objdata(), ownedA.getDocument().toBson().objdata());
+
+    // So is one held in an array or in a newly built document.
+    const Value ownedD = document["d"].getOwned();
+    ASSERT_TRUE(ownedD.isOwned());
+    ASSERT_VALUE_EQ(document["d"], ownedD);
+
+    const Document built{{"a", a}, {"n", 1}};
+    ASSERT_FALSE(built.isOwned());
+    ASSERT_TRUE(built.getOwned().isOwned());
+    ASSERT_DOCUMENT_EQ(built, built.getOwned());
+
+    // The parent counts its whole buffer, so retaining it does not copy it.
+    ASSERT_EQUALS(document.getPtr(), document.getOwned().getPtr());
+}
+
+TEST(DocumentSerialization, ModifiedDocumentDoesNotAffectTheOriginal) {
+    BSONObj obj = BSON("a" << 1 << "b" << 2);
+    Document document = fromBson(obj);
+    MutableDocument md(document);
+    md["b"] = Value(3);
+    md.addField("c", Value(4));
+    Document modified = md.freeze();
+
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "b" << 3 << "c" << 4), toBson(modified));
+    ASSERT_EQUALS(obj.objdata(), toBson(document).objdata());
+    ASSERT_EQUALS(2, document["b"].getInt());
+}
+
 /**
  * Appends to 'builder' an object nested 'depth' levels deep.
  */
@@ -568,6 +642,17 @@ TEST(MetaFields, ToAndFromBson) {
     ASSERT_EQ(20, fromBson.getRandMetaField());
 }
 
+TEST(MetaFields, FromBsonWithMetaDataStripsMetaFields) {
+    BSONObj obj = BSON("a" << 1 << Document::metaFieldTextScore << 10.0 << "b" << 2);
+    Document doc = Document::fromBsonWithMetaData(obj);
+    ASSERT_TRUE(doc.hasTextScore());
+    ASSERT_EQ(10.0, doc.getTextScore());
+    ASSERT_EQUALS(2, doc["b"].getInt());
+    ASSERT_TRUE(doc[Document::metaFieldTextScore].missing());
+    ASSERT_EQUALS(2U, doc.size());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "b" << 2), doc.toBson());
+}
+
 TEST(MetaFields, BadSerialization) {
     // Write an unrecognized option to the buffer.
     BufBuilder bb;
@@ -651,6 +651,11 @@ public:
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 
+    /**
+     * Returns the result of {$add: [lhs, rhs]}.
+     */
+    static Value apply(const Value& lhs, const Value& rhs);
+
     bool isAssociative() const final {
         return true;
     }
@@ -791,6 +796,11 @@ public:
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 
+    /**
+     * Returns the result of this comparison on the values of its operands, 'lhs' and 'rhs'.
+     */
+    Value apply(const Value& lhs, const Value& rhs) const;
+
     CmpOp getOp() const {
         return cmpOp;
     }
@@ -1382,6 +1392,11 @@ public:
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
 
+    /**
+     * Returns the result of {$multiply: [lhs, rhs]}.
+     */
+    static Value apply(const Value& lhs, const Value& rhs);
+
     bool isAssociative() const final {
         return true;
     }
@@ -1732,6 +1747,11 @@ public:
 
     Value evaluate(const Document& root) const final;
     const char* getOpName() const final;
+
+    /**
+     * Returns the result of {$subtract: [lhs, rhs]}.
+     */
+    static Value apply(const Value& lhs, const Value& rhs);
 };
 
 
@@ -32,6 +32,8 @@
 #include "mongo/db/pipeline/stub_mongo_process_interface.h"
 #include "mongo/db/query/collation/collation_spec.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/memory.h"
 
 namespace mongo {
 
@@ -58,6 +60,10 @@ ExpressionContext::ExpressionContext(OperationContext* opCtx,
     collation = request.getCollation();
     _ownedCollator = std::move(collator);
     _resolvedNamespaces = std::move(resolvedNamespaces);
+
+    if (internalPipelineUseValueArena.load()) {
+        valueArena = stdx::make_unique<ValueArena>();
+    }
 }
 
 ExpressionContext::ExpressionContext(OperationContext* opCtx, const CollatorInterface* collator)
@@ -146,6 +152,10 @@ intrusive_ptr<ExpressionContext> ExpressionContext::copyWith(
     expCtx->bypassDocumentValidation = bypassDocumentValidation;
     expCtx->subPipelineDepth = subPipelineDepth;
 
+    if (valueArena) {
+        expCtx->valueArena = stdx::make_unique<ValueArena>();
+    }
+
     expCtx->tempDir = tempDir;
 
     expCtx->opCtx = opCtx;
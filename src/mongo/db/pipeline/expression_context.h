@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/aggregation_request.h"
 #include "mongo/db/pipeline/document_comparator.h"
 #include "mongo/db/pipeline/mongo_process_interface.h"
+#include "mongo/db/pipeline/value_arena.h"
 #include "mongo/db/pipeline/value_comparator.h"
 #include "mongo/db/pipeline/variables.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -202,6 +203,11 @@ public:
     // Tracks the depth of nested aggregation sub-pipelines. Used to enforce depth limits.
     size_t subPipelineDepth = 0;
 
+    // The arena for the buffers of Documents produced while executing a Pipeline with this
+    // ExpressionContext, or null if Documents are allocated on the heap. Only set for aggregations
+    // when 'internalPipelineUseValueArena' is enabled.
+    std::unique_ptr<ValueArena> valueArena;
+
 protected:
     static const int kInterruptCheckPeriod = 128;
 
@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_table.h"
+
+namespace mongo {
+
+constexpr size_t GroupTable::kEmptySlot;
+constexpr size_t GroupTable::kMinCapacity;
+
+GroupTable::GroupTable(ValueComparator comparator, size_t numAccumulators)
+    : _comparator(comparator), _numAccumulators(numAccumulators) {}
+
+uint64_t GroupTable::hash(const Value& id) const {
+    // Value hashes are built with hash_combine, which leaves the low bits of similar ids
+    // correlated. Mix the bits, since only the low bits are used to pick a slot.
+    uint64_t h = _comparator.hash(id);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+size_t GroupTable::findOrInsert(const Value& id, bool* inserted) {
+    const uint64_t idHash = hash(id);
+    size_t mask = _slots.size() - 1;
+    size_t pos = idHash & mask;
+    if (!_slots.empty()) {
+        for (; _slots[pos].group != kEmptySlot; pos = (pos + 1) & mask) {
+            const Slot& slot = _slots[pos];
+            if (slot.hash == idHash && _comparator.compare(_ids[slot.group], id) == 0) {
+                *inserted = false;
+                return slot.group;
+            }
+        }
+    }
+
+    // The table only grows when a group is added, so that callers only see its memory usage
+    // change on insertion.
+    if ((_ids.size() + 1) * 4 > _slots.size() * 3) {
+        grow();
+        mask = _slots.size() - 1;
+        pos = idHash & mask;
+        while (_slots[pos].group != kEmptySlot) {
+            pos = (pos + 1) & mask;
+        }
+    }
+
+    const size_t group = _ids.size();
+    _slots[pos] = {idHash, group};
+    _ids.push_back(id);
+    _accumulators.resize(_accumulators.size() + _numAccumulators);
+    *inserted = true;
+    return group;
+}
+
+void GroupTable::grow() {
+    const size_t newCapacity = _slots.empty() ? kMinCapacity : _slots.size() * 2;
+    std::vector<Slot> newSlots(newCapacity, Slot{0, kEmptySlot});
+    const size_t mask = newCapacity - 1;
+    for (auto&& slot : _slots) {
+        if (slot.group == kEmptySlot) {
+            continue;
+        }
+
+        size_t pos = slot.hash & mask;
+        while (newSlots[pos].group != kEmptySlot) {
+            pos = (pos + 1) & mask;
+        }
+        newSlots[pos] = slot;
+    }
+    _slots.swap(newSlots);
+}
+
+void GroupTable::clear() {
+    // Swap with empty vectors, since clear() would keep the memory.
+    std::vector<Slot>().swap(_slots);
+    std::vector<Value>().swap(_ids);
+    std::vector<AccumulatorPtr>().swap(_accumulators);
+}
+
+size_t GroupTable::memUsageBytes() const {
+    return _slots.capacity() * sizeof(Slot) + _ids.capacity() * sizeof(Value) +
+        _accumulators.capacity() * sizeof(AccumulatorPtr);
+}
+
+}  // namespace mongo
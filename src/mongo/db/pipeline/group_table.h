@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * The groups of a $group stage: a map from group id to the accumulators of the group.
+ *
+ * This is an open-addressing hash table with linear probing. Its slots hold only the hash of an id
+ * and the index of its group, so probing does not touch the ids unless the hashes match, and
+ * growing the table does not rehash them. The ids and the accumulators of all groups are stored
+ * densely in insertion order, the accumulators of each group next to each other, instead of in one
+ * node and one vector per group. Groups are identified by their index, which is stable until the
+ * table is cleared; pointers into the table are invalidated by inserting a group.
+ */
+class GroupTable {
+public:
+    using AccumulatorPtr = boost::intrusive_ptr<Accumulator>;
+
+    /**
+     * Groups ids are compared using 'comparator'. Each group has 'numAccumulators' accumulators.
+     */
+    GroupTable(ValueComparator comparator, size_t numAccumulators);
+
+    /**
+     * Returns the index of the group with the id 'id', adding a group with a copy of 'id' if there
+     * is none. Sets '*inserted' to whether a group was added. The accumulators of a new group are
+     * null, and must be set by the caller. The memory usage of the table only changes when a group
+     * is added.
+     */
+    size_t findOrInsert(const Value& id, bool* inserted);
+
+    const Value& getId(size_t group) const {
+        return _ids[group];
+    }
+
+    /**
+     * Returns the accumulators of 'group', of which there are getNumAccumulators().
+     */
+    AccumulatorPtr* getAccumulators(size_t group) {
+        return _accumulators.data() + group * _numAccumulators;
+    }
+
+    const AccumulatorPtr* getAccumulators(size_t group) const {
+        return _accumulators.data() + group * _numAccumulators;
+    }
+
+    size_t getNumAccumulators() const {
+        return _numAccumulators;
+    }
+
+    size_t size() const {
+        return _ids.size();
+    }
+
+    bool empty() const {
+        return _ids.empty();
+    }
+
+    /**
+     * Removes all groups and releases the memory of the table.
+     */
+    void clear();
+
+    /**
+     * Returns the number of bytes allocated by the table itself. This does not include the memory
+     * owned by the ids or the accumulators.
+     */
+    size_t memUsageBytes() const;
+
+private:
+    struct Slot {
+        uint64_t hash;
+        size_t group;
+    };
+
+    static constexpr size_t kEmptySlot = static_cast<size_t>(-1);
+
+    // The smallest capacity the slots grow to, which must be a power of two.
+    static constexpr size_t kMinCapacity = 8;
+
+    uint64_t hash(const Value& id) const;
+
+    /**
+     * Doubles the number of slots, and reinserts the groups using their stored hashes.
+     */
+    void grow();
+
+    ValueComparator _comparator;
+    size_t _numAccumulators;
+
+    // The number of slots is zero or a power of two, and is kept at most 3/4 full.
+    std::vector<Slot> _slots;
+    std::vector<Value> _ids;
+    std::vector<AccumulatorPtr> _accumulators;
+};
+
+}  // namespace mongo
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_table.h"
+
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(GroupTableTest, FindsTheGroupOfAnEqualId) {
+    GroupTable groups(ValueComparator(), 0);
+    bool inserted;
+    ASSERT_EQ(0UL, groups.findOrInsert(Value(1), &inserted));
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(1UL, groups.findOrInsert(Value("a"_sd), &inserted));
+    ASSERT_TRUE(inserted);
+
+    // Numbers of different types which compare equal are in the same group.
+    ASSERT_EQ(0UL, groups.findOrInsert(Value(1.0), &inserted));
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(1UL, groups.findOrInsert(Value("a"_sd), &inserted));
+    ASSERT_FALSE(inserted);
+
+    ASSERT_EQ(2UL, groups.size());
+    ASSERT_VALUE_EQ(Value(1), groups.getId(0));
+    ASSERT_VALUE_EQ(Value("a"_sd), groups.getId(1));
+}
+
+TEST(GroupTableTest, UsesTheComparatorForEquality) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    GroupTable groups(ValueComparator(&collator), 0);
+    bool inserted;
+    ASSERT_EQ(0UL, groups.findOrInsert(Value("abc"_sd), &inserted));
+    ASSERT_EQ(0UL, groups.findOrInsert(Value("ABC"_sd), &inserted));
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(1UL, groups.findOrInsert(Value("abd"_sd), &inserted));
+    ASSERT_TRUE(inserted);
+}
+
+TEST(GroupTableTest, KeepsGroupsAsItGrows) {
+    GroupTable groups(ValueComparator(), 2);
+    const int numGroups = 10000;
+    bool inserted;
+    for (int i = 0; i < numGroups; ++i) {
+        ASSERT_EQ(static_cast<size_t>(i), groups.findOrInsert(Value(i * 1024), &inserted));
+        ASSERT_TRUE(inserted);
+        ASSERT_FALSE(groups.getAccumulators(i)[0]);
+        ASSERT_FALSE(groups.getAccumulators(i)[1]);
+    }
+
+    for (int i = 0; i < numGroups; ++i) {
+        ASSERT_EQ(static_cast<size_t>(i), groups.findOrInsert(Value(i * 1024), &inserted));
+        ASSERT_FALSE(inserted);
+    }
+    ASSERT_EQ(static_cast<size_t>(numGroups), groups.size());
+}
+
+TEST(GroupTableTest, StoresTheAccumulatorsOfEachGroup) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto factory = AccumulationStatement::getFactory("$sum");
+    GroupTable groups(ValueComparator(), 2);
+    bool inserted;
+    for (int i = 0; i < 3; ++i) {
+        auto accumulators = groups.getAccumulators(groups.findOrInsert(Value(i), &inserted));
+        accumulators[0] = factory(expCtx);
+        accumulators[1] = factory(expCtx);
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        auto accumulators = groups.getAccumulators(groups.findOrInsert(Value(i % 3), &inserted));
+        accumulators[0]->process(Value(1), false);
+        accumulators[1]->process(Value(i), false);
+    }
+
+    ASSERT_VALUE_EQ(Value(2), groups.getAccumulators(0)[0]->getValue(false));
+    ASSERT_VALUE_EQ(Value(3), groups.getAccumulators(0)[1]->getValue(false));
+    ASSERT_VALUE_EQ(Value(5), groups.getAccumulators(1)[1]->getValue(false));
+    ASSERT_VALUE_EQ(Value(7), groups.getAccumulators(2)[1]->getValue(false));
+}
+
+TEST(GroupTableTest, MemoryUsageOnlyChangesOnInsertion) {
+    GroupTable groups(ValueComparator(), 1);
+    bool inserted;
+    groups.findOrInsert(Value(0), &inserted);
+    for (int i = 1; i < 100; ++i) {
+        // Finding an existing group must not grow the table, even when the next insertion will.
+        const size_t bytes = groups.memUsageBytes();
+        groups.findOrInsert(Value(i - 1), &inserted);
+        ASSERT_FALSE(inserted);
+        ASSERT_EQ(bytes, groups.memUsageBytes());
+
+        groups.findOrInsert(Value(i), &inserted);
+        ASSERT_TRUE(inserted);
+    }
+}
+
+TEST(GroupTableTest, ClearReleasesMemory) {
+    GroupTable groups(ValueComparator(), 1);
+    ASSERT_EQ(0UL, groups.memUsageBytes());
+
+    bool inserted;
+    for (int i = 0; i < 100; ++i) {
+        groups.findOrInsert(Value(i), &inserted);
+    }
+    ASSERT_GTE(groups.memUsageBytes(), 100 * (sizeof(Value) + sizeof(GroupTable::AccumulatorPtr)));
+
+    groups.clear();
+    ASSERT_TRUE(groups.empty());
+    ASSERT_EQ(0UL, groups.memUsageBytes());
+    ASSERT_EQ(0UL, groups.findOrInsert(Value(50), &inserted));
+    ASSERT_TRUE(inserted);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -33,6 +33,7 @@
 #include <algorithm>
 
 #include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value_arena.h"
 
 namespace mongo {
 
@@ -79,8 +80,14 @@ void TeeBuffer::loadNextBatch() {
     _buffer.clear();
     size_t bytesInBuffer = 0;
 
+    // The batch outlives the getNext() call that loads it. An arena is only installed while a
+    // pipeline which uses one is executing.
+    const bool outsideArena = ValueArena::current();
     auto input = _source->getNext();
     for (; input.isAdvanced(); input = _source->getNext()) {
+        if (outsideArena) {
+            input = DocumentSource::GetNextResult(input.releaseDocument().getOwned(true));
+        }
         bytesInBuffer += input.getDocument().getApproximateSize();
         _buffer.push_back(std::move(input));
 
@@ -154,7 +154,10 @@ Document ValueStorage::getDocument() const {
 // not in header because document is fwd declared
 Value::Value(const BSONObj& obj) : _storage(Object, Document(obj)) {}
 
-Value::Value(const BSONElement& elem) : _storage(elem.type()) {
+Value::Value(const BSONElement& elem) : Value(elem, BSONObj(), 0) {}
+
+Value::Value(const BSONElement& elem, const BSONObj& owner, size_t depthBound)
+    : _storage(elem.type()) {
     switch (elem.type()) {
         // These are all type-only, no data
         case EOO:
@@ -175,14 +178,25 @@ Value::Value(const BSONElement& elem) : _storage(elem.type()) {
             break;
 
         case Object: {
-            _storage.putDocument(Document(elem.embeddedObject()));
+            if (!owner.isOwned()) {
+                _storage.putDocument(Document(elem.embeddedObject()));
+                break;
+            }
+
+            BSONObj obj = elem.embeddedObject();
+            if (obj.isEmpty()) {
+                _storage.putDocument(Document());
+                break;
+            }
+            obj.shareOwnershipWith(owner);
+            _storage.putDocument(Document(new DocumentStorage(std::move(obj), false, depthBound)));
             break;
         }
 
         case Array: {
             intrusive_ptr<RCVector> vec(new RCVector);
             BSONForEach(sub, elem.embeddedObject()) {
-                vec->vec.push_back(Value(sub));
+                vec->vec.push_back(Value(sub, owner, depthBound > 1 ? depthBound - 1 : 0));
             }
             _storage.putVector(vec.get());
             break;
@@ -1048,6 +1062,39 @@ bool Value::integral64Bit() const {
     }
 }
 
+Value Value::getOwned(bool outsideArena) const {
+    if (isOwned(outsideArena))
+        return *this;
+
+    if (getType() == Object)
+        return Value(getDocument().getOwned(outsideArena));
+
+    // Otherwise this is an array holding such a document.
+    std::vector<Value> owned;
+    owned.reserve(getArrayLength());
+    for (auto&& value : getArray()) {
+        owned.push_back(value.getOwned(outsideArena));
+    }
+    return Value(std::move(owned));
+}
+
+bool Value::isOwned(bool outsideArena) const {
+    switch (getType()) {
+        case Object:
+            return getDocument().isOwned(outsideArena);
+
+        case Array:
+            for (auto&& value : getArray()) {
+                if (!value.isOwned(outsideArena))
+                    return false;
+            }
+            return true;
+
+        default:
+            return true;
+    }
+}
+
 size_t Value::getApproximateSize() const {
     switch (getType()) {
         case Code:
@@ -123,10 +123,16 @@ public:
     explicit Value(const char*) = delete;  // Use StringData instead to prevent accidentally
                                            // terminating the string at the first null byte.
 
-    // TODO: add an unsafe version that can share storage with the BSONElement
     /// Deep-convert from BSONElement to Value
     explicit Value(const BSONElement& elem);
 
+    /**
+     * Like Value(const BSONElement&), but embedded objects become Documents, which share ownership
+     * of 'owner' (the owned BSON 'elem' lives in) instead of copying their BSON. 'depthBound' is an
+     * upper bound on the nesting depth of the embedded object or array, if known, or 0 otherwise.
+     */
+    Value(const BSONElement& elem, const BSONObj& owner, size_t depthBound);
+
     /** Construct a long or integer-valued Value.
      *
      *  Used when preforming arithmetic operations with int where the
@@ -339,9 +345,12 @@ public:
     int memUsageForSorter() const {
         return getApproximateSize();
     }
-    Value getOwned() const {
-        return *this;
-    }
+
+    /// Returns this value, or a copy of it for stages to retain. See Document::getOwned().
+    Value getOwned(bool outsideArena = false) const;
+
+    /// Returns whether getOwned(outsideArena) would return this value itself.
+    bool isOwned(bool outsideArena = false) const;
 
     /// Members to support parsing/deserialization from IDL generated code.
     void serializeForIDL(StringData fieldName, BSONObjBuilder* builder) const;
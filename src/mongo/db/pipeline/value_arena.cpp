@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/value_arena.h"
+
+#include <cstdlib>
+#include <new>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/allocator.h"
+
+namespace mongo {
+
+namespace {
+constexpr size_t kAlignment = alignof(std::max_align_t);
+
+size_t alignUp(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+thread_local ValueArena* currentArena = nullptr;
+}  // namespace
+
+/**
+ * The header at the start of each block. The count holds one reference for each live allocation
+ * in the block, plus one for the arena while the block is its current block.
+ */
+class ValueArena::Block {
+public:
+    AtomicUInt32 refs;
+};
+
+namespace {
+const size_t kBlockHeaderSize = alignUp(sizeof(ValueArena::Block));
+
+void releaseBlock(ValueArena::Block* block) {
+    if (block->refs.subtractAndFetch(1) == 0) {
+        block->~Block();
+        std::free(block);
+    }
+}
+}  // namespace
+
+ValueArena::Scope::Scope(ValueArena* arena) : _previous(currentArena) {
+    currentArena = arena;
+}
+
+ValueArena::Scope::~Scope() {
+    currentArena = _previous;
+}
+
+ValueArena::~ValueArena() {
+    _releaseCurrentBlock();
+}
+
+ValueArena* ValueArena::current() {
+    return currentArena;
+}
+
+char* ValueArena::allocate(size_t size, Block** block) {
+    if (currentArena && size <= kMaxArenaAllocationSize) {
+        return currentArena->_allocate(size, block);
+    }
+
+    char* out = new char[size];
+    *block = nullptr;
+    return out;
+}
+
+void ValueArena::deallocate(char* ptr, Block* block) {
+    if (!block) {
+        delete[] ptr;
+        return;
+    }
+
+    releaseBlock(block);
+}
+
+char* ValueArena::_allocate(size_t size, Block** block) {
+    size = alignUp(size);
+    if (!_current || size > size_t(_end - _next)) {
+        _releaseCurrentBlock();
+
+        char* memory = static_cast<char*>(mongoMalloc(kBlockSize));
+        _current = new (memory) Block();
+        _current->refs.store(1);
+        _next = memory + kBlockHeaderSize;
+        _end = memory + kBlockSize;
+        ++_blocksAllocated;
+    }
+
+    char* out = _next;
+    _next += size;
+    _current->refs.fetchAndAdd(1);
+    *block = _current;
+    return out;
+}
+
+void ValueArena::_releaseCurrentBlock() {
+    if (!_current) {
+        return;
+    }
+
+    releaseBlock(_current);
+    _current = nullptr;
+    _next = nullptr;
+    _end = nullptr;
+}
+
+}  // namespace mongo
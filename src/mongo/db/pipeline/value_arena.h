@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+/**
+ * A bump allocator for the buffers of pipeline Documents. An aggregation enables one per
+ * ExpressionContext and installs it on the executing thread with a ValueArena::Scope while it
+ * produces results, so that the many short-lived Documents built by its stages are carved out of
+ * a few large blocks instead of each going through malloc and free.
+ *
+ * Memory is never returned to a block individually. Instead, each block counts the allocations
+ * still live in it and is freed once they are all released and the arena has moved on to a new
+ * block. Documents may therefore safely outlive the arena, and may be released on any thread.
+ * The arena itself must only be used by one thread at a time.
+ *
+ * Since a single live allocation keeps its whole block alive, stages that retain Documents or
+ * Values past the current getNext() call, such as $sort and $group, keep getOwned(true) copies of
+ * them when their pipeline uses an arena. Those copies have all their fields loaded into heap
+ * buffers, and so are counted in full by the stages' memory accounting.
+ */
+class ValueArena {
+    MONGO_DISALLOW_COPYING(ValueArena);
+
+public:
+    class Block;
+
+    // The size of each block, including its header.
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    // Requests larger than this are served from the heap, so that one large Document does not
+    // waste most of a block.
+    static constexpr size_t kMaxArenaAllocationSize = 4 * 1024;
+
+    /**
+     * Installs 'arena' as the arena for allocations on the current thread for the lifetime of this
+     * object, restoring the previously installed arena afterwards. A null 'arena' means that
+     * allocations in this scope use the heap.
+     */
+    class Scope {
+        MONGO_DISALLOW_COPYING(Scope);
+
+    public:
+        explicit Scope(ValueArena* arena);
+        ~Scope();
+
+    private:
+        ValueArena* _previous;
+    };
+
+    ValueArena() = default;
+    ~ValueArena();
+
+    /**
+     * Allocates 'size' bytes, aligned for any type, from the arena installed on this thread, or
+     * from the heap if there is none or 'size' is too large. Sets '*block' to the block that owns
+     * the memory, or to null for heap memory. The memory must be released by passing the same
+     * pointer and block to deallocate().
+     */
+    static char* allocate(size_t size, Block** block);
+
+    static void deallocate(char* ptr, Block* block);
+
+    /**
+     * Returns the arena installed on the current thread, or null if there is none.
+     */
+    static ValueArena* current();
+
+    /**
+     * Returns the number of blocks this arena has allocated over its lifetime.
+     */
+    size_t blocksAllocated() const {
+        return _blocksAllocated;
+    }
+
+private:
+    char* _allocate(size_t size, Block** block);
+
+    /**
+     * Gives up the arena's reference to the current block, freeing it if no allocations in it
+     * remain.
+     */
+    void _releaseCurrentBlock();
+
+    Block* _current = nullptr;
+    char* _next = nullptr;  // start of the free space in '_current'
+    char* _end = nullptr;   // end of '_current'
+    size_t _blocksAllocated = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/value_arena.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(ValueArenaTest, AllocatesFromHeapWithoutScope) {
+    ValueArena::Block* block;
+    char* ptr = ValueArena::allocate(64, &block);
+    ASSERT(ptr);
+    ASSERT_FALSE(block);
+    ValueArena::deallocate(ptr, block);
+}
+
+TEST(ValueArenaTest, AllocatesFromInstalledArena) {
+    ValueArena arena;
+    {
+        ValueArena::Scope scope(&arena);
+        ASSERT_EQ(&arena, ValueArena::current());
+
+        ValueArena::Block* block1;
+        ValueArena::Block* block2;
+        char* ptr1 = ValueArena::allocate(3, &block1);
+        char* ptr2 = ValueArena::allocate(64, &block2);
+        ASSERT(block1);
+        ASSERT_EQ(block1, block2);
+        ASSERT_LT(ptr1, ptr2);
+        ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(ptr2) % alignof(std::max_align_t));
+        ASSERT_EQ(1U, arena.blocksAllocated());
+
+        ValueArena::deallocate(ptr1, block1);
+        ValueArena::deallocate(ptr2, block2);
+    }
+    ASSERT_FALSE(ValueArena::current());
+}
+
+TEST(ValueArenaTest, LargeAllocationsBypassArena) {
+    ValueArena arena;
+    ValueArena::Scope scope(&arena);
+
+    ValueArena::Block* block;
+    char* ptr = ValueArena::allocate(ValueArena::kMaxArenaAllocationSize + 1, &block);
+    ASSERT_FALSE(block);
+    ASSERT_EQ(0U, arena.blocksAllocated());
+    ValueArena::deallocate(ptr, block);
+}
+
+TEST(ValueArenaTest, StartsNewBlockWhenFull) {
+    ValueArena arena;
+    ValueArena::Scope scope(&arena);
+
+    std::vector<std::pair<char*, ValueArena::Block*>> allocations;
+    const size_t count = 2 * ValueArena::kBlockSize / ValueArena::kMaxArenaAllocationSize;
+    for (size_t i = 0; i < count; ++i) {
+        ValueArena::Block* block;
+        char* ptr = ValueArena::allocate(ValueArena::kMaxArenaAllocationSize, &block);
+        allocations.emplace_back(ptr, block);
+    }
+    ASSERT_EQ(3U, arena.blocksAllocated());
+    ASSERT_NE(allocations.front().second, allocations.back().second);
+
+    for (auto&& allocation : allocations) {
+        ValueArena::deallocate(allocation.first, allocation.second);
+    }
+}
+
+TEST(ValueArenaTest, ScopesNest) {
+    ValueArena outer;
+    ValueArena inner;
+    ValueArena::Scope outerScope(&outer);
+    {
+        ValueArena::Scope innerScope(&inner);
+        ASSERT_EQ(&inner, ValueArena::current());
+        {
+            ValueArena::Scope heapScope(nullptr);
+            ASSERT_FALSE(ValueArena::current());
+        }
+        ASSERT_EQ(&inner, ValueArena::current());
+    }
+    ASSERT_EQ(&outer, ValueArena::current());
+}
+
+TEST(ValueArenaTest, DocumentsOutliveTheirArena) {
+    Document doc;
+    Document clone;
+    {
+        auto arena = stdx::make_unique<ValueArena>();
+        ValueArena::Scope scope(arena.get());
+
+        MutableDocument md;
+        for (int i = 0; i < 20; ++i) {
+            md.addField(std::to_string(i), Value(i));
+        }
+        doc = md.freeze();
+
+        MutableDocument copy(doc);
+        copy["0"] = Value("modified"_sd);
+        clone = copy.freeze();
+        ASSERT_EQ(1U, arena->blocksAllocated());
+    }
+
+    ASSERT_EQ(20U, doc.size());
+    ASSERT_VALUE_EQ(Value(19), doc["19"]);
+    ASSERT_VALUE_EQ(Value(0), doc["0"]);
+    ASSERT_VALUE_EQ(Value("modified"_sd), clone["0"]);
+    ASSERT_VALUE_EQ(Value(12), clone["12"]);
+}
+
+TEST(ValueArenaTest, OwnedDocumentsDoNotUseTheArena) {
+    ValueArena arena;
+    ValueArena::Scope scope(&arena);
+
+    Document inner{{"b", 1}};
+    Document doc{{"a", inner}, {"list", Value(std::vector<Value>{Value(inner), Value(2)})}};
+    ASSERT_FALSE(doc.isOwned(true));
+    ASSERT_FALSE(Value(doc).isOwned(true));
+
+    // Without 'outsideArena', documents are retained as they are.
+    ASSERT_TRUE(doc.isOwned());
+    ASSERT_EQ(doc.getPtr(), doc.getOwned().getPtr());
+
+    Document owned = doc.getOwned(true);
+    ASSERT_TRUE(owned.isOwned(true));
+    ASSERT_DOCUMENT_EQ(doc, owned);
+    ASSERT_EQ(1U, arena.blocksAllocated());
+
+    Value ownedList = doc["list"].getOwned(true);
+    ASSERT_TRUE(ownedList.isOwned(true));
+    ASSERT_VALUE_EQ(doc["list"], ownedList);
+
+    ASSERT_EQ(owned.getPtr(), owned.getOwned(true).getPtr());
+}
+
+TEST(ValueArenaTest, OwnedLazyDocumentsLoadTheirFieldsOutsideTheArena) {
+    ValueArena arena;
+    ValueArena::Scope scope(&arena);
+
+    // No fields of this document are loaded yet, so it has no buffer at all.
+    Document lazy(BSON("a" << BSON("b" << 1 << "c" << BSON_ARRAY(BSON("d" << 2))) << "e" << 3));
+    ASSERT_FALSE(lazy.isOwned(true));
+
+    Document owned = lazy.getOwned(true);
+    ASSERT_TRUE(owned.isOwned(true));
+    ASSERT_VALUE_EQ(Value(2), owned.getNestedField(FieldPath("a.c")).getArray()[0]["d"]);
+    ASSERT_VALUE_EQ(Value(3), owned["e"]);
+    ASSERT_EQ(0U, arena.blocksAllocated());
+}
+
+}  // namespace
+}  // namespace mongo
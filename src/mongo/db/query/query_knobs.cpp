@@ -81,4 +81,8 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryProhibitBlockingMergeOnMongoS, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalPipelineUseValueArena, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalPipelineCompileExpressions, bool, true);
 }  // namespace mongo
@@ -123,4 +123,10 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
+
+// Whether $project and $addFields compile their expressions before evaluating them.
+extern AtomicBool internalPipelineCompileExpressions;
+
+// Whether aggregations allocate the buffers of their Documents from a per-ExpressionContext arena.
+extern AtomicBool internalPipelineUseValueArena;
 }  // namespace mongo
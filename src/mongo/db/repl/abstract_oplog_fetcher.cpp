@@ -54,6 +54,10 @@ ServerStatusMetricField<Counter64> displayReadersCreated("repl.network.readersCr
 // Number of seconds for the `maxTimeMS` on the initial `find` command.
 MONGO_EXPORT_SERVER_PARAMETER(oplogInitialFindMaxSeconds, int, 60);
 
+// Whether the `getMore` for the next batch is sent before the current batch is processed, so that
+// transferring a batch overlaps with processing the previous one.
+MONGO_EXPORT_SERVER_PARAMETER(oplogFetcherPrefetchGetMore, bool, false);
+
 // Number of milliseconds to add to the `find` and `getMore` timeouts to calculate the network
 // timeout for the requests.
 const Milliseconds kNetworkTimeoutBufferMS{5000};
@@ -105,6 +109,11 @@ Milliseconds AbstractOplogFetcher::_getGetMoreMaxTime() const {
     return kDefaultOplogGetMoreMaxMS;
 }
 
+BSONObj AbstractOplogFetcher::_makePrefetchGetMoreCommandObject(
+    const Fetcher::QueryResponse& queryResponse) const {
+    return BSONObj();
+}
+
 std::string AbstractOplogFetcher::toString() const {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     str::stream msg;
@@ -319,6 +328,13 @@ void AbstractOplogFetcher::_finishCallback(Status status) {
 
 std::unique_ptr<Fetcher> AbstractOplogFetcher::_makeFetcher(const BSONObj& findCommandObj,
                                                             const BSONObj& metadataObj) {
+    Fetcher::GetMoreCommandFn prefetchGetMoreCommandFn;
+    if (oplogFetcherPrefetchGetMore.load()) {
+        prefetchGetMoreCommandFn = [this](const Fetcher::QueryResponse& queryResponse) {
+            return _makePrefetchGetMoreCommandObject(queryResponse);
+        };
+    }
+
     return stdx::make_unique<Fetcher>(
         _getExecutor(),
         _source,
@@ -329,7 +345,9 @@ std::unique_ptr<Fetcher> AbstractOplogFetcher::_makeFetcher(const BSONObj& findC
                BSONObjBuilder* builder) { return _callback(resp, builder); },
         metadataObj,
         _getFindMaxTime() + kNetworkTimeoutBufferMS,
-        _getGetMoreMaxTime() + kNetworkTimeoutBufferMS);
+        _getGetMoreMaxTime() + kNetworkTimeoutBufferMS,
+        RemoteCommandRetryScheduler::makeNoRetryPolicy(),
+        std::move(prefetchGetMoreCommandFn));
 }
 
 }  // namespace repl
@@ -173,6 +173,14 @@ private:
      */
     virtual StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) = 0;
 
+    /**
+     * Returns the `getMore` command to send for the batch following 'queryResponse' before
+     * 'queryResponse' is passed to _onSuccessfulBatch, when getMore prefetching is enabled. Returns
+     * an empty object, which disables prefetching, by default.
+     */
+    virtual BSONObj _makePrefetchGetMoreCommandObject(
+        const Fetcher::QueryResponse& queryResponse) const;
+
     /**
      * This function creates a Fetcher with the given `find` command and metadata.
      */
@@ -391,6 +391,19 @@ Milliseconds OplogFetcher::_getGetMoreMaxTime() const {
     return _awaitDataTimeout;
 }
 
+BSONObj OplogFetcher::_makePrefetchGetMoreCommandObject(
+    const Fetcher::QueryResponse& queryResponse) const {
+    // The term and commit point are those known before the batch is processed. The getMore sent
+    // after the next batch carries any update made while processing this one.
+    auto lastCommittedWithCurrentTerm =
+        _dataReplicatorExternalState->getCurrentTermAndLastCommittedOpTime();
+    return makeGetMoreCommandObject(queryResponse.nss,
+                                    queryResponse.cursorId,
+                                    lastCommittedWithCurrentTerm,
+                                    _getGetMoreMaxTime(),
+                                    _batchSize);
+}
+
 StatusWith<BSONObj> OplogFetcher::_onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) {
 
     // Stop fetching and return on fail point.
@@ -157,6 +157,9 @@ private:
      */
     StatusWith<BSONObj> _onSuccessfulBatch(const Fetcher::QueryResponse& queryResponse) override;
 
+    BSONObj _makePrefetchGetMoreCommandObject(
+        const Fetcher::QueryResponse& queryResponse) const override;
+
     // The metadata object sent with the Fetcher queries.
     const BSONObj _metadataObject;
 
@@ -32,6 +32,7 @@
 
 #include "mongo/db/s/balancer/balancer_policy.h"
 
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
 #include "mongo/util/log.h"
@@ -52,8 +53,17 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+/**
+ * Returns the operation rate of the specified shard or zero if it did not report load metrics.
+ */
+double opsPerSecond(const ClusterStatistics::ShardStatistics& stat) {
+    return stat.loadMetrics ? stat.loadMetrics->opsPerSecond : 0;
+}
+
 }  // namespace
 
+MONGO_EXPORT_SERVER_PARAMETER(balancerBreakTiesByShardLoad, bool, false);
+
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
     : _nss(std::move(nss)),
       _shardChunks(std::move(shardToChunksMap)),
@@ -241,8 +251,11 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
                                                      const DistributionStatus& distribution,
                                                      const string& tag,
                                                      const set<ShardId>& excludedShards) {
+    const bool breakTiesByLoad = balancerBreakTiesByShardLoad.load();
+
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
+    double minOpsPerSecond = 0;
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
@@ -253,13 +266,17 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
             continue;
         }
 
+        // Among the shards with the same number of chunks, prefer the one with the least load
         unsigned myChunks = distribution.numberOfChunksInShard(stat.shardId);
-        if (myChunks >= minChunks) {
+        if (myChunks > minChunks ||
+            (myChunks == minChunks &&
+             (!breakTiesByLoad || opsPerSecond(stat) >= minOpsPerSecond))) {
             continue;
         }
 
         best = stat.shardId;
         minChunks = myChunks;
+        minOpsPerSecond = opsPerSecond(stat);
     }
 
     return best;
@@ -269,20 +286,28 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
                                                 const DistributionStatus& distribution,
                                                 const string& chunkTag,
                                                 const set<ShardId>& excludedShards) {
+    const bool breakTiesByLoad = balancerBreakTiesByShardLoad.load();
+
     ShardId worst;
     unsigned maxChunks = 0;
+    double maxOpsPerSecond = 0;
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
             continue;
 
+        // Among the shards with the same number of chunks, prefer the one with the most load
         const unsigned shardChunkCount =
             distribution.numberOfChunksInShardWithTag(stat.shardId, chunkTag);
-        if (shardChunkCount <= maxChunks)
+        if (shardChunkCount == 0 || shardChunkCount < maxChunks ||
+            (shardChunkCount == maxChunks &&
+             (!breakTiesByLoad || opsPerSecond(stat) <= maxOpsPerSecond))) {
             continue;
+        }
 
         worst = stat.shardId;
         maxChunks = shardChunkCount;
+        maxOpsPerSecond = opsPerSecond(stat);
     }
 
     return worst;
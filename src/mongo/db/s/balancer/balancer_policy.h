@@ -36,11 +36,16 @@
 #include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_id.h"
 
 namespace mongo {
 
+// Whether the balancer uses the shards' operation rate to choose between donor or recipient shards,
+// which have the same number of chunks. The chunks to move are still chosen by chunk count alone.
+extern AtomicBool balancerBreakTiesByShardLoad;
+
 struct ZoneRange {
     ZoneRange(const BSONObj& a_min, const BSONObj& a_max, const std::string& _zone);
 
@@ -184,6 +189,11 @@ public:
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
      *
+     * If balancerBreakTiesByShardLoad is enabled, the shards' load is used to break ties between
+     * donor and recipient candidates with the same number of chunks. The load is only reported for
+     * the shard as a whole and not for the collection's chunks, so it never causes migrations on
+     * its own.
+     *
      * The usedShards parameter is in/out and it contains the set of shards, which have already been
      * used for migrations. Used so we don't return multiple conflicting migrations for the same
      * shard.
@@ -204,7 +214,8 @@ public:
 private:
     /**
      * Return the shard with the specified tag, which has the least number of chunks. If the tag is
-     * empty, considers all shards.
+     * empty, considers all shards. With balancerBreakTiesByShardLoad, ties are broken by the lowest
+     * load.
      */
     static ShardId _getLeastLoadedReceiverShard(const ShardStatisticsVector& shardStats,
                                                 const DistributionStatus& distribution,
@@ -212,8 +223,9 @@ private:
                                                 const std::set<ShardId>& excludedShards);
 
     /**
-     * Return the shard which has the least number of chunks with the specified tag. If the tag is
-     * empty, considers all chunks.
+     * Return the shard which has the most number of chunks with the specified tag. If the tag is
+     * empty, considers all chunks. With balancerBreakTiesByShardLoad, ties are broken by the
+     * highest load.
      */
     static ShardId _getMostOverloadedShard(const ShardStatisticsVector& shardStats,
                                            const DistributionStatus& distribution,
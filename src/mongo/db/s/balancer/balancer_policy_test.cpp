@@ -118,6 +118,30 @@ std::vector<MigrateInfo> balanceChunks(const ShardStatisticsVector& shardStats,
         shardStats, distribution, shouldAggressivelyBalance, &usedShards);
 }
 
+/**
+ * Returns statistics for a shard without tags, which reported the specified load.
+ */
+ShardStatistics shardWithLoad(const ShardId& shardId, double opsPerSecond) {
+    ShardStatistics stat(shardId, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion);
+    stat.loadMetrics.emplace();
+    stat.loadMetrics->opsPerSecond = opsPerSecond;
+    return stat;
+}
+
+/**
+ * Makes the balancer break ties by shard load for the lifetime of the object.
+ */
+class BreakTiesByShardLoadEnabled {
+public:
+    BreakTiesByShardLoadEnabled() {
+        balancerBreakTiesByShardLoad.store(true);
+    }
+
+    ~BreakTiesByShardLoadEnabled() {
+        balancerBreakTiesByShardLoad.store(false);
+    }
+};
+
 TEST(BalancerPolicy, Basic) {
     auto cluster = generateCluster(
         {{ShardStatistics(kShardId0, kNoMaxSize, 4, false, emptyTagSet, emptyShardVersion), 4},
@@ -609,6 +633,58 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(balanceChunks(cluster.first, distribution, false).empty());
 }
 
+TEST(BalancerPolicy, LoadIsIgnoredUnlessBreakingTiesByShardLoad) {
+    auto cluster = generateCluster({{shardWithLoad(kShardId0, 1000), 6},
+                                    {shardWithLoad(kShardId1, 100), 6},
+                                    {shardWithLoad(kShardId2, 100), 6},
+                                    {shardWithLoad(kShardId3, 100), 6}});
+
+    ASSERT(balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false)
+               .empty());
+}
+
+TEST(BalancerPolicy, BreakTiesByShardLoadDoesNotMoveChunksWhenChunkCountsAreBalanced) {
+    BreakTiesByShardLoadEnabled breakTiesByShardLoad;
+
+    // The shard-wide load says nothing about the load of this collection's chunks, so it must not
+    // cause migrations on its own
+    auto cluster = generateCluster({{shardWithLoad(kShardId0, 1000), 6},
+                                    {shardWithLoad(kShardId1, 100), 6},
+                                    {shardWithLoad(kShardId2, 100), 6},
+                                    {shardWithLoad(kShardId3, 100), 6}});
+
+    ASSERT(balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false)
+               .empty());
+}
+
+TEST(BalancerPolicy, BreakTiesByShardLoadPrefersMostLoadedDonorWithSameChunkCount) {
+    BreakTiesByShardLoadEnabled breakTiesByShardLoad;
+
+    auto cluster = generateCluster({{shardWithLoad(kShardId0, 100), 10},
+                                    {shardWithLoad(kShardId1, 900), 10},
+                                    {shardWithLoad(kShardId2, 50), 2}});
+
+    const auto migrations(
+        balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId1, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
+TEST(BalancerPolicy, BreakTiesByShardLoadPrefersLeastLoadedRecipientWithSameChunkCount) {
+    BreakTiesByShardLoadEnabled breakTiesByShardLoad;
+
+    auto cluster = generateCluster({{shardWithLoad(kShardId0, 100), 10},
+                                    {shardWithLoad(kShardId1, 500), 2},
+                                    {shardWithLoad(kShardId2, 50), 2}});
+
+    const auto migrations(
+        balanceChunks(cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
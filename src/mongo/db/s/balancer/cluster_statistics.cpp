@@ -72,6 +72,17 @@ BSONObj ClusterStatistics::ShardStatistics::toBSON() const {
     }
 
     builder.append("version", mongoVersion);
+
+    if (loadMetrics) {
+        builder.append("load", loadMetrics->toBSON());
+    }
+
+    return builder.obj();
+}
+
+BSONObj ClusterStatistics::ShardStatistics::LoadMetrics::toBSON() const {
+    BSONObjBuilder builder;
+    builder.append("opsPerSecond", opsPerSecond);
     return builder.obj();
 }
 
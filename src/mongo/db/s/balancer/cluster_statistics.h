@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 #include <set>
 #include <string>
@@ -57,6 +58,22 @@ public:
      */
     struct ShardStatistics {
     public:
+        /**
+         * Load of the shard's primary, as reported by its serverStatus. The operation rate is
+         * derived from two consecutive opcounters samples, so these metrics are only available
+         * starting from the second statistics collection round.
+         */
+        struct LoadMetrics {
+            /**
+             * Returns BSON representation of the load metrics, for reporting purposes.
+             */
+            BSONObj toBSON() const;
+
+            // Number of operations (inserts, queries, updates, deletes, getMores and commands) per
+            // second executed on the shard's primary since the previous sample
+            double opsPerSecond{0};
+        };
+
         ShardStatistics(ShardId shardId,
                         uint64_t maxSizeMB,
                         uint64_t currSizeMB,
@@ -92,6 +109,9 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // Load of the shard's primary, if it could be obtained
+        boost::optional<LoadMetrics> loadMetrics;
     };
 
     virtual ~ClusterStatistics();
@@ -46,16 +46,16 @@ namespace mongo {
 namespace {
 
 const char kVersionField[] = "version";
+const char kLocalTimeField[] = "localTime";
+const char kOpCountersField[] = "opcounters";
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * Executes the serverStatus command against the primary of the specified shard.
  *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Returns the serverStatus response or an error. Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> retrieveShardServerStatus(OperationContext* opCtx, ShardId shardId) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -76,15 +76,21 @@ StatusWith<std::string> retrieveShardMongoDVersion(OperationContext* opCtx, Shar
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
+    return std::move(commandResponse.getValue().response);
+}
 
-    std::string version;
-    Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
-    if (!status.isOK()) {
-        return status;
+/**
+ * Sums up all the operation counters from the opcounters section of a serverStatus response.
+ */
+long long sumOpCounters(const BSONObj& opCounters) {
+    long long total = 0;
+    for (const auto& elem : opCounters) {
+        if (elem.isNumber()) {
+            total += elem.safeNumberLong();
+        }
     }
 
-    return version;
+    return total;
 }
 
 }  // namespace
@@ -95,6 +101,46 @@ ClusterStatisticsImpl::ClusterStatisticsImpl() = default;
 
 ClusterStatisticsImpl::~ClusterStatisticsImpl() = default;
 
+boost::optional<ShardStatistics::LoadMetrics> ClusterStatisticsImpl::_computeLoadMetrics(
+    const ShardId& shardId, const BSONObj& serverStatus) {
+    const auto localTimeElem = serverStatus[kLocalTimeField];
+    const auto opCountersElem = serverStatus[kOpCountersField];
+    if (localTimeElem.type() != Date || opCountersElem.type() != Object) {
+        return boost::none;
+    }
+
+    OpCountersSample sample;
+    sample.localTime = localTimeElem.date();
+    sample.totalOps = sumOpCounters(opCountersElem.Obj());
+
+    ShardStatistics::LoadMetrics metrics;
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        auto it = _lastOpCounters.find(shardId);
+        if (it == _lastOpCounters.end()) {
+            _lastOpCounters.emplace(shardId, sample);
+            return boost::none;
+        }
+
+        const OpCountersSample prevSample = it->second;
+        it->second = sample;
+
+        // A primary failover or restart resets the counters, so the previous sample cannot be
+        // used as a baseline
+        const auto elapsed = sample.localTime - prevSample.localTime;
+        if (elapsed <= Milliseconds(0) || sample.totalOps < prevSample.totalOps) {
+            return boost::none;
+        }
+
+        metrics.opsPerSecond = static_cast<double>(sample.totalOps - prevSample.totalOps) * 1000 /
+            durationCount<Milliseconds>(elapsed);
+    }
+
+    return metrics;
+}
+
 StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationContext* opCtx) {
     // Get a list of all the shards that are participating in this balance round along with any
     // maximum allowed quotas and current utilization. We get the latter by issuing
@@ -129,15 +175,26 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
         }
 
         std::string mongoDVersion;
+        boost::optional<ShardStatistics::LoadMetrics> loadMetrics;
+
+        // Since the mongod version and load are only used for reporting and as a hint for the
+        // balancer policy, there is no need to fail the entire round if they cannot be retrieved,
+        // so just leave them empty
+        auto serverStatusStatus = retrieveShardServerStatus(opCtx, shard.getName());
+        if (serverStatusStatus.isOK()) {
+            const BSONObj& serverStatus = serverStatusStatus.getValue();
+
+            Status versionStatus =
+                bsonExtractStringField(serverStatus, kVersionField, &mongoDVersion);
+            if (!versionStatus.isOK()) {
+                log() << "Unable to obtain shard version for " << shard.getName()
+                      << causedBy(versionStatus);
+            }
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
-        if (mongoDVersionStatus.isOK()) {
-            mongoDVersion = std::move(mongoDVersionStatus.getValue());
+            loadMetrics = _computeLoadMetrics(shard.getName(), serverStatus);
         } else {
-            // Since the mongod version is only used for reporting, there is no need to fail the
-            // entire round if it cannot be retrieved, so just leave it empty
             log() << "Unable to obtain shard version for " << shard.getName()
-                  << causedBy(mongoDVersionStatus.getStatus());
+                  << causedBy(serverStatusStatus.getStatus());
         }
 
         std::set<std::string> shardTags;
@@ -152,6 +209,7 @@ StatusWith<std::vector<ShardStatistics>> ClusterStatisticsImpl::getStats(Operati
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+        stats.back().loadMetrics = std::move(loadMetrics);
     }
 
     return stats;
@@ -28,7 +28,11 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -43,6 +47,30 @@ public:
     ~ClusterStatisticsImpl();
 
     StatusWith<std::vector<ShardStatistics>> getStats(OperationContext* opCtx) override;
+
+private:
+    /**
+     * Cumulative operation count reported by a shard's primary at a given point in its local time.
+     */
+    struct OpCountersSample {
+        Date_t localTime;
+        long long totalOps{0};
+    };
+
+    /**
+     * Computes the load metrics for the specified shard given its latest serverStatus response and
+     * records the opcounters sample so that the next round can derive the operation rate from it.
+     * Returns boost::none if the response does not contain the required fields or if there is no
+     * usable previous sample yet.
+     */
+    boost::optional<ShardStatistics::LoadMetrics> _computeLoadMetrics(const ShardId& shardId,
+                                                                      const BSONObj& serverStatus);
+
+    // Protects the state below
+    stdx::mutex _mutex;
+
+    // The most recent opcounters sample obtained from each shard
+    std::map<ShardId, OpCountersSample> _lastOpCounters;
 };
 
 }  // namespace mongo
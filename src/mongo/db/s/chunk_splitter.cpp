@@ -32,6 +32,7 @@
 
 #include "mongo/db/s/chunk_splitter.h"
 
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/query.h"
 #include "mongo/db/client.h"
@@ -45,6 +46,7 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
+#include "mongo/s/chunk_writes_tracker.h"
 #include "mongo/s/config_server_client.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -54,6 +56,9 @@
 namespace mongo {
 namespace {
 
+// Minimum number of sampled writes to a chunk before its split points are chosen by write load
+const size_t kMinSamplesForLoadBasedSplit = 32;
+
 /**
  * Constructs the default options for the thread pool used to schedule splits.
  */
@@ -191,6 +196,31 @@ BSONObj findExtremeKeyForShard(OperationContext* opCtx,
     return shardKeyPattern.extractShardKeyFromDoc(end);
 }
 
+/**
+ * Applies the top chunk optimization to the first (if 'isMin') or last split point, by replacing it
+ * with the extreme shard key found on the shard. The replacement is only done if the split points
+ * stay strictly ascending, since they may have been moved by the write load balancing. Returns
+ * whether the split point was replaced.
+ */
+bool replaceExtremeSplitPoint(std::vector<BSONObj>* splitPoints, const BSONObj& key, bool isMin) {
+    const auto lessThan = SimpleBSONObjComparator::kInstance.makeLessThan();
+    const size_t numPoints = splitPoints->size();
+
+    if (isMin) {
+        if (numPoints > 1 && !lessThan(key, (*splitPoints)[1])) {
+            return false;
+        }
+        splitPoints->front() = key.getOwned();
+    } else {
+        if (numPoints > 1 && !lessThan((*splitPoints)[numPoints - 2], key)) {
+            return false;
+        }
+        splitPoints->back() = key.getOwned();
+    }
+
+    return true;
+}
+
 /**
  * Checks if autobalance is enabled on the current sharded collection.
  */
@@ -325,6 +355,20 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
             return;
         }
 
+        // If enough writes to the chunk have been sampled, place the split points so that the
+        // resulting chunks receive similar write load, rather than just similar amounts of data.
+        // This keeps hot ranges of skewed shard keys from remaining in a single chunk.
+        auto& writesTracker = chunk->getWritesTracker();
+        if (writesTracker.getSamplesCount() >= kMinSamplesForLoadBasedSplit) {
+            splitPoints = ChunkWritesTracker::balanceSplitPoints(
+                splitPoints,
+                writesTracker.getLoadBalancedSplitPoints(chunk->getMin(), splitPoints.size() + 1));
+
+            LOG(1) << "chose " << splitPoints.size() << " split points for " << nss
+                   << " based on " << writesTracker.getSamplesCount()
+                   << " sampled writes out of " << writesTracker.getWritesCount();
+        }
+
         // We assume that if the chunk being split is the first (or last) one on the collection,
         // this chunk is likely to see more insertions. Instead of splitting mid-chunk, we use the
         // very first (or last) key as a split point.
@@ -341,8 +385,7 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                 // MinKey is infinity (This is the first chunk on the collection)
                 BSONObj key =
                     findExtremeKeyForShard(opCtx.get(), nss, cm->getShardKeyPattern(), true);
-                if (!key.isEmpty()) {
-                    splitPoints.front() = key.getOwned();
+                if (!key.isEmpty() && replaceExtremeSplitPoint(&splitPoints, key, true)) {
                     topChunkMinKey = cm->getShardKeyPattern().getKeyPattern().globalMin();
                 }
             } else if (0 ==
@@ -351,8 +394,7 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                 // MaxKey is infinity (This is the last chunk on the collection)
                 BSONObj key =
                     findExtremeKeyForShard(opCtx.get(), nss, cm->getShardKeyPattern(), false);
-                if (!key.isEmpty()) {
-                    splitPoints.back() = key.getOwned();
+                if (!key.isEmpty() && replaceExtremeSplitPoint(&splitPoints, key, false)) {
                     topChunkMinKey = key.getOwned();
                 }
             }
@@ -366,6 +408,9 @@ void ChunkSplitter::_runAutosplit(const NamespaceString& nss,
                                                    chunkRange,
                                                    splitPoints));
 
+        // The sampled writes describe the range, which was just split, so start sampling afresh
+        writesTracker.clear();
+
         const bool shouldBalance = isAutoBalanceEnabled(opCtx.get(), nss, balancerConfig);
 
         log() << "autosplitted " << nss << " chunk: " << redact(chunk->toString()) << " into "
@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/catalog/catalog_raii.h"
 #include "mongo/db/catalog/index_catalog.h"
@@ -50,14 +51,20 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 0);
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 0);
+
 namespace {
 
 using Deletion = CollectionRangeDeleter::Deletion;
@@ -227,6 +234,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     const auto clientOpTime = repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp();
 
     // Wait for replication outside the lock
+    Timer replicationTimer;
     const auto status = [&] {
         try {
             WriteConcernResult unusedWCResult;
@@ -256,12 +264,23 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             self->_pop(status);
         }
     } else {
-        LOG(1) << "Deleted " << wrote.getValue() << " documents in " << nss.ns() << " range "
+        LOG(1) << "Processed a batch of " << wrote.getValue() << " documents in " << nss.ns()
+               << " range "
                << redact(range->toString());
     }
 
     notification.abandon();
-    return Date_t{};
+
+    // If pacing is enabled, also wait for at least as long as the batch took to replicate, so that
+    // the deletes do not build up replication lag on the secondaries
+    const Milliseconds batchDelay(rangeDeleterBatchDelayMS.load());
+    if (batchDelay <= Milliseconds(0)) {
+        return Date_t{};
+    }
+
+    const Milliseconds delay = std::max(batchDelay, Milliseconds(replicationTimer.millis()));
+
+    return Date_t::now() + delay;
 }
 
 StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
@@ -310,42 +329,63 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
-    int numDeleted = 0;
-    do {
-        auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
-        auto manual = PlanExecutor::YIELD_MANUAL;
-        auto forward = InternalPlanner::FORWARD;
-        auto fetch = InternalPlanner::IXSCAN_FETCH;
-
-        auto exec = InternalPlanner::indexScan(
-            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
-
-        RecordId rloc;
-        BSONObj obj;
-        PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
-        if (state == PlanExecutor::IS_EOF) {
-            break;
-        }
-        if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
-            warning() << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                      << redact(min) << " to " << redact(max) << " in " << nss << ": "
-                      << redact(WorkingSetCommon::toStatusString(obj))
-                      << ", stats: " << Explain::getWinningPlanStats(exec.get());
-            break;
-        }
-        invariant(PlanExecutor::ADVANCED == state);
+    // Collect the batch in shard key index order first, so that the deletes themselves can be done
+    // in a single storage transaction without having to keep the index scan open across them
+    std::vector<RecordId> recordIds;
+    {
+        auto exec = InternalPlanner::indexScan(opCtx,
+                                               collection,
+                                               descriptor,
+                                               min,
+                                               max,
+                                               BoundInclusion::kIncludeStartKeyOnly,
+                                               PlanExecutor::YIELD_MANUAL,
+                                               InternalPlanner::FORWARD,
+                                               InternalPlanner::IXSCAN_FETCH);
+
+        while (recordIds.size() < static_cast<size_t>(maxToDelete)) {
+            RecordId rloc;
+            BSONObj obj;
+            PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+            if (state == PlanExecutor::IS_EOF) {
+                break;
+            }
+            if (state == PlanExecutor::FAILURE || state == PlanExecutor::DEAD) {
+                warning() << PlanExecutor::statestr(state)
+                          << " - cursor error while trying to delete " << redact(min) << " to "
+                          << redact(max) << " in " << nss << ": "
+                          << redact(WorkingSetCommon::toStatusString(obj))
+                          << ", stats: " << Explain::getWinningPlanStats(exec.get());
+                break;
+            }
+            invariant(PlanExecutor::ADVANCED == state);
 
-        writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
-            WriteUnitOfWork wuow(opCtx);
             if (saver) {
                 uassertStatusOK(saver->goingToDelete(obj));
             }
+
+            recordIds.push_back(std::move(rloc));
+        }
+    }
+
+    writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
+        WriteUnitOfWork wuow(opCtx);
+        for (const auto& rloc : recordIds) {
+            // The document may have been removed by a concurrent write since it was found
+            Snapshotted<BSONObj> unusedDoc;
+            if (!collection->findDoc(opCtx, rloc, &unusedDoc)) {
+                continue;
+            }
+
             collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
-            wuow.commit();
-        });
-    } while (++numDeleted < maxToDelete);
+        }
+        wuow.commit();
+    });
 
-    return numDeleted;
+    // Report the documents scanned rather than the ones actually deleted. If all of them were
+    // removed concurrently, more orphans may still follow in the range, and only a scan which
+    // finds nothing proves that it is empty.
+    return static_cast<int>(recordIds.size());
 }
 
 auto CollectionRangeDeleter::overlaps(ChunkRange const& range) const
@@ -32,6 +32,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/time_support.h"
@@ -42,6 +43,13 @@ class BSONObj;
 class Collection;
 class OperationContext;
 
+// Maximum number of documents to delete in a single batch (0 means use the value of
+// internalQueryExecYieldIterations)
+extern AtomicInt32 rangeDeleterBatchSize;
+
+// Minimum amount of time to wait between consecutive batches of the same range deletion
+extern AtomicInt32 rangeDeleterBatchDelayMS;
+
 class CollectionRangeDeleter {
     MONGO_DISALLOW_COPYING(CollectionRangeDeleter);
 
@@ -158,7 +166,10 @@ public:
      * it must be called without locks.
      *
      * If it should be scheduled to run again because there might be more documents to delete,
-     * returns the time to begin, or boost::none otherwise.
+     * returns the time to begin, or boost::none otherwise. After a batch of documents has been
+     * deleted, the next batch is paced by at least rangeDeleterBatchDelayMS, or by as long as it
+     * took for the previous batch to replicate to a majority of nodes if that took longer, so that
+     * lagging secondaries are not overwhelmed.
      *
      * Argument 'forTestOnly' is used in unit tests that exercise the CollectionRangeDeleter class,
      * so that they do not need to set up CollectionShardingState and MetadataManager objects.
@@ -174,8 +185,11 @@ private:
      * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
      * called under the collection lock.
      *
-     * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
-     * the range failed.
+     * The documents are found in shard key index order and are deleted together in a single
+     * storage transaction.
+     *
+     * Returns the number of documents found in the range, some of which may have been removed
+     * concurrently instead, 0 if done with the range, or bad status if deleting the range failed.
      */
     StatusWith<int> _doDeletion(OperationContext* opCtx,
                                 Collection* collection,
@@ -134,7 +134,10 @@ void scheduleCleanup(executor::TaskExecutor* executor,
             auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = uniqueOpCtx.get();
 
-            const int maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
+            const int maxToDelete = std::max(rangeDeleterBatchSize.load() > 0
+                                                 ? rangeDeleterBatchSize.load()
+                                                 : int(internalQueryExecYieldIterations.load()),
+                                             1);
 
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
 
@@ -84,6 +84,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/op_msg.h"
+#include "mongo/util/sampling_profiler.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -469,6 +470,9 @@ void execCommandDatabase(OperationContext* opCtx,
             CurOp::get(opCtx)->setCommand_inlock(command);
         }
 
+        // Narrows the operation the CPU samples are charged to down to this command.
+        SamplingProfiler::OperationScope profilerScope(command->getName(), request.getDatabase());
+
         // TODO: move this back to runCommands when mongos supports OperationContext
         // see SERVER-18515 for details.
         rpc::readRequestMetadata(opCtx, request.body);
@@ -1065,6 +1069,11 @@ DbResponse ServiceEntryPointCommon::handleRequest(OperationContext* opCtx,
         currentOp.setLogicalOp_inlock(networkOpToLogicalOp(op));
     }
 
+    // Charges the CPU samples taken while handling this request to it, and counts them in
+    // currentOp.
+    SamplingProfiler::OperationScope profilerScope(
+        networkOpToString(op), nsString.ns(), currentOp.cpuSamples());
+
     OpDebug& debug = currentOp.debug();
 
     long long logThresholdMs = serverGlobalParams.slowMS;
@@ -33,8 +33,11 @@
 
 #include "mongo/db/stats/counters.h"
 
+#include <algorithm>
+#include <string>
+
 #include "mongo/db/jsobj.h"
-#include "mongo/util/debug_util.h"
+#include "mongo/platform/bits.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -44,38 +47,31 @@ using std::endl;
 OpCounters::OpCounters() {}
 
 void OpCounters::gotInserts(int n) {
-    RARELY _checkWrap();
-    _insert.fetchAndAdd(n);
+    _counters.add(kInsert, n);
 }
 
 void OpCounters::gotInsert() {
-    RARELY _checkWrap();
-    _insert.fetchAndAdd(1);
+    _counters.add(kInsert, 1);
 }
 
 void OpCounters::gotQuery() {
-    RARELY _checkWrap();
-    _query.fetchAndAdd(1);
+    _counters.add(kQuery, 1);
 }
 
 void OpCounters::gotUpdate() {
-    RARELY _checkWrap();
-    _update.fetchAndAdd(1);
+    _counters.add(kUpdate, 1);
 }
 
 void OpCounters::gotDelete() {
-    RARELY _checkWrap();
-    _delete.fetchAndAdd(1);
+    _counters.add(kDelete, 1);
 }
 
 void OpCounters::gotGetMore() {
-    RARELY _checkWrap();
-    _getmore.fetchAndAdd(1);
+    _counters.add(kGetMore, 1);
 }
 
 void OpCounters::gotCommand() {
-    RARELY _checkWrap();
-    _command.fetchAndAdd(1);
+    _counters.add(kCommand, 1);
 }
 
 void OpCounters::gotOp(int op, bool isCommand) {
@@ -106,101 +102,82 @@ void OpCounters::gotOp(int op, bool isCommand) {
     }
 }
 
-void OpCounters::_checkWrap() {
-    const unsigned MAX = 1 << 30;
-
-    bool wrap = _insert.loadRelaxed() > MAX || _query.loadRelaxed() > MAX ||
-        _update.loadRelaxed() > MAX || _delete.loadRelaxed() > MAX ||
-        _getmore.loadRelaxed() > MAX || _command.loadRelaxed() > MAX;
-
-    if (wrap) {
-        _insert.store(0);
-        _query.store(0);
-        _update.store(0);
-        _delete.store(0);
-        _getmore.store(0);
-        _command.store(0);
-    }
-}
-
 BSONObj OpCounters::getObj() const {
+    // The counters are 64 bits wide now, but stay 32-bit integers in the output while they fit.
     BSONObjBuilder b;
-    b.append("insert", _insert.loadRelaxed());
-    b.append("query", _query.loadRelaxed());
-    b.append("update", _update.loadRelaxed());
-    b.append("delete", _delete.loadRelaxed());
-    b.append("getmore", _getmore.loadRelaxed());
-    b.append("command", _command.loadRelaxed());
+    b.appendNumber("insert", getInsert());
+    b.appendNumber("query", getQuery());
+    b.appendNumber("update", getUpdate());
+    b.appendNumber("delete", getDelete());
+    b.appendNumber("getmore", getGetMore());
+    b.appendNumber("command", getCommand());
     return b.obj();
 }
 
 void NetworkCounter::hitPhysicalIn(long long bytes) {
-    static const int64_t MAX = 1ULL << 60;
-
-    // don't care about the race as its just a counter
-    const bool overflow = _physicalBytesIn.loadRelaxed() > MAX;
-
-    if (overflow) {
-        _physicalBytesIn.store(bytes);
-    } else {
-        _physicalBytesIn.fetchAndAdd(bytes);
-    }
+    _counters.add(kPhysicalBytesIn, bytes);
 }
 
 void NetworkCounter::hitPhysicalOut(long long bytes) {
-    static const int64_t MAX = 1ULL << 60;
-
-    // don't care about the race as its just a counter
-    const bool overflow = _physicalBytesOut.loadRelaxed() > MAX;
-
-    if (overflow) {
-        _physicalBytesOut.store(bytes);
-    } else {
-        _physicalBytesOut.fetchAndAdd(bytes);
-    }
+    _counters.add(kPhysicalBytesOut, bytes);
 }
 
 void NetworkCounter::hitLogicalIn(long long bytes) {
-    static const int64_t MAX = 1ULL << 60;
-
-    // don't care about the race as its just a counter
-    const bool overflow = _together.logicalBytesIn.loadRelaxed() > MAX;
-
-    if (overflow) {
-        _together.logicalBytesIn.store(bytes);
-        // The requests field only gets incremented here (and not in hitPhysical) because the
-        // hitLogical and hitPhysical are each called for each operation. Incrementing it in both
-        // functions would double-count the number of operations.
-        _together.requests.store(1);
-    } else {
-        _together.logicalBytesIn.fetchAndAdd(bytes);
-        _together.requests.fetchAndAdd(1);
-    }
+    _counters.add(kLogicalBytesIn, bytes);
+    // The requests field only gets incremented here (and not in hitPhysical) because the
+    // hitLogical and hitPhysical are each called for each operation. Incrementing it in both
+    // functions would double-count the number of operations.
+    _counters.add(kRequests, 1);
 }
 
 void NetworkCounter::hitLogicalOut(long long bytes) {
-    static const int64_t MAX = 1ULL << 60;
-
-    // don't care about the race as its just a counter
-    const bool overflow = _logicalBytesOut.loadRelaxed() > MAX;
-
-    if (overflow) {
-        _logicalBytesOut.store(bytes);
-    } else {
-        _logicalBytesOut.fetchAndAdd(bytes);
-    }
+    _counters.add(kLogicalBytesOut, bytes);
 }
 
 void NetworkCounter::append(BSONObjBuilder& b) {
-    b.append("bytesIn", static_cast<long long>(_together.logicalBytesIn.loadRelaxed()));
-    b.append("bytesOut", static_cast<long long>(_logicalBytesOut.loadRelaxed()));
-    b.append("physicalBytesIn", static_cast<long long>(_physicalBytesIn.loadRelaxed()));
-    b.append("physicalBytesOut", static_cast<long long>(_physicalBytesOut.loadRelaxed()));
-    b.append("numRequests", static_cast<long long>(_together.requests.loadRelaxed()));
+    b.append("bytesIn", static_cast<long long>(_counters.get(kLogicalBytesIn)));
+    b.append("bytesOut", static_cast<long long>(_counters.get(kLogicalBytesOut)));
+    b.append("physicalBytesIn", static_cast<long long>(_counters.get(kPhysicalBytesIn)));
+    b.append("physicalBytesOut", static_cast<long long>(_counters.get(kPhysicalBytesOut)));
+    b.append("numRequests", static_cast<long long>(_counters.get(kRequests)));
+}
+
+void TransportStageCounter::record(Stage stage, Microseconds duration) {
+    const long long count = durationCount<Microseconds>(duration);
+    const unsigned long long micros = count > 0 ? count : 0;
+    const int bucket =
+        micros == 0 ? 0 : std::min(64 - countLeadingZeros64(micros), kNumBuckets - 1);
+
+    auto& data = _stages[static_cast<int>(stage)];
+    data.buckets[bucket].fetchAndAdd(1);
+    data.totalMicros.fetchAndAdd(micros);
+    data.count.fetchAndAdd(1);
+}
+
+void TransportStageCounter::append(BSONObjBuilder& b) {
+    static const char* const kStageNames[kNumStages] = {
+        "sourceWait", "executorQueue", "process", "sinkWait"};
+
+    // Every bucket is always appended so that the FTDC schema does not change as buckets fill.
+    for (int stage = 0; stage < kNumStages; ++stage) {
+        const auto& data = _stages[stage];
+        BSONObjBuilder stageBuilder(b.subobjStart(kStageNames[stage]));
+        stageBuilder.append("count", static_cast<long long>(data.count.loadRelaxed()));
+        stageBuilder.append("totalMicros", static_cast<long long>(data.totalMicros.loadRelaxed()));
+
+        BSONObjBuilder histogramBuilder(stageBuilder.subobjStart("histogram"));
+        for (int bucket = 0; bucket < kNumBuckets; ++bucket) {
+            const long long lowerBoundMicros = bucket == 0 ? 0 : 1LL << (bucket - 1);
+            histogramBuilder.append(std::to_string(lowerBoundMicros),
+                                    static_cast<long long>(data.buckets[bucket].loadRelaxed()));
+        }
+        histogramBuilder.doneFast();
+        stageBuilder.doneFast();
+    }
 }
 
-
 OpCounters globalOpCounters;
 OpCounters replOpCounters;
 NetworkCounter networkCounter;
+TransportStageCounter transportStageCounter;
 }
@@ -29,10 +29,14 @@
 
 #pragma once
 
+#include <array>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/basic.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/concurrency/striped_counter.h"
+#include "mongo/util/duration.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/with_alignment.h"
@@ -41,7 +45,8 @@ namespace mongo {
 
 /**
  * for storing operation counters
- * note: not thread safe.  ok with that for speed
+ * Every operation bumps one of these, so they are striped per CPU to keep cores from fighting
+ * over the cache lines. Reads add up the stripes.
  */
 class OpCounters {
 public:
@@ -59,34 +64,29 @@ public:
     BSONObj getObj() const;
 
     // thse are used by snmp, and other things, do not remove
-    const AtomicUInt32* getInsert() const {
-        return &_insert;
+    long long getInsert() const {
+        return _counters.get(kInsert);
     }
-    const AtomicUInt32* getQuery() const {
-        return &_query;
+    long long getQuery() const {
+        return _counters.get(kQuery);
     }
-    const AtomicUInt32* getUpdate() const {
-        return &_update;
+    long long getUpdate() const {
+        return _counters.get(kUpdate);
     }
-    const AtomicUInt32* getDelete() const {
-        return &_delete;
+    long long getDelete() const {
+        return _counters.get(kDelete);
     }
-    const AtomicUInt32* getGetMore() const {
-        return &_getmore;
+    long long getGetMore() const {
+        return _counters.get(kGetMore);
     }
-    const AtomicUInt32* getCommand() const {
-        return &_command;
+    long long getCommand() const {
+        return _counters.get(kCommand);
     }
 
 private:
-    void _checkWrap();
-
-    CacheAligned<AtomicUInt32> _insert;
-    CacheAligned<AtomicUInt32> _query;
-    CacheAligned<AtomicUInt32> _update;
-    CacheAligned<AtomicUInt32> _delete;
-    CacheAligned<AtomicUInt32> _getmore;
-    CacheAligned<AtomicUInt32> _command;
+    enum Counter { kInsert, kQuery, kUpdate, kDelete, kGetMore, kCommand, kNumCounters };
+
+    StripedCounters<kNumCounters> _counters;
 };
 
 extern OpCounters globalOpCounters;
@@ -106,21 +106,53 @@ public:
     void append(BSONObjBuilder& b);
 
 private:
-    CacheAligned<AtomicInt64> _physicalBytesIn{0};
-    CacheAligned<AtomicInt64> _physicalBytesOut{0};
-
-    // These two counters are always incremented at the same time, so
-    // we place them on the same cache line.
-    struct Together {
-        AtomicInt64 logicalBytesIn{0};
-        AtomicInt64 requests{0};
+    enum Counter {
+        kPhysicalBytesIn,
+        kPhysicalBytesOut,
+        kLogicalBytesIn,
+        kLogicalBytesOut,
+        kRequests,
+        kNumCounters
     };
-    CacheAligned<Together> _together{};
-    static_assert(sizeof(decltype(_together)) <= stdx::hardware_constructive_interference_size,
-                  "cache line spill");
 
-    CacheAligned<AtomicInt64> _logicalBytesOut{0};
+    // All counters of a CPU share its stripe, so each call touches a single local cache line.
+    StripedCounters<kNumCounters> _counters;
 };
 
 extern NetworkCounter networkCounter;
+
+/**
+ * Histograms of the time connections spend in each stage of the ServiceStateMachine. They tell
+ * waiting on the network, queuing in the ServiceExecutor, executing requests and sending
+ * responses apart. Only populated while the traceTransportStages server parameter is enabled.
+ */
+class TransportStageCounter {
+public:
+    enum class Stage {
+        kSourceWait,     // Waiting for a request to arrive and be read off the network.
+        kExecutorQueue,  // Waiting in the ServiceExecutor for a thread to process the request.
+        kProcess,        // Decompressing and executing the request.
+        kSinkWait,       // Writing the response to the network.
+    };
+    static constexpr int kNumStages = 4;
+
+    // Bucket 0 counts durations of 0 microseconds and bucket i > 0 counts durations in
+    // [2^(i-1), 2^i) microseconds. The last bucket also counts everything longer.
+    static constexpr int kNumBuckets = 28;
+
+    void record(Stage stage, Microseconds duration);
+
+    void append(BSONObjBuilder& b);
+
+private:
+    struct StageData {
+        std::array<AtomicUInt64, kNumBuckets> buckets;
+        AtomicUInt64 totalMicros;
+        AtomicUInt64 count;
+    };
+
+    std::array<CacheAligned<StageData>, kNumStages> _stages;
+};
+
+extern TransportStageCounter transportStageCounter;
 }
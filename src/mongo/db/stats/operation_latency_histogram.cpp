@@ -100,17 +100,18 @@ void OperationLatencyHistogram::_append(const HistogramData& data,
     if (includeHistograms) {
         BSONArrayBuilder arrayBuilder(histogramBuilder.subarrayStart("histogram"));
         for (int i = 0; i < kMaxBuckets; i++) {
-            if (data.buckets[i] == 0)
+            const uint64_t count = data.buckets[i].loadRelaxed();
+            if (count == 0)
                 continue;
             BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
             entryBuilder.append("micros", static_cast<long long>(kLowerBounds[i]));
-            entryBuilder.append("count", static_cast<long long>(data.buckets[i]));
+            entryBuilder.append("count", static_cast<long long>(count));
             entryBuilder.doneFast();
         }
         arrayBuilder.doneFast();
     }
-    histogramBuilder.append("latency", static_cast<long long>(data.sum));
-    histogramBuilder.append("ops", static_cast<long long>(data.entryCount));
+    histogramBuilder.append("latency", static_cast<long long>(data.sum.loadRelaxed()));
+    histogramBuilder.append("ops", static_cast<long long>(data.entryCount.loadRelaxed()));
     histogramBuilder.doneFast();
 }
 
@@ -120,6 +121,20 @@ void OperationLatencyHistogram::append(bool includeHistograms, BSONObjBuilder* b
     _append(_commands, "commands", includeHistograms, builder);
 }
 
+void OperationLatencyHistogram::_addData(const HistogramData& from, HistogramData* to) {
+    for (int i = 0; i < kMaxBuckets; i++) {
+        to->buckets[i].fetchAndAdd(from.buckets[i].loadRelaxed());
+    }
+    to->entryCount.fetchAndAdd(from.entryCount.loadRelaxed());
+    to->sum.fetchAndAdd(from.sum.loadRelaxed());
+}
+
+void OperationLatencyHistogram::add(const OperationLatencyHistogram& other) {
+    _addData(other._reads, &_reads);
+    _addData(other._writes, &_writes);
+    _addData(other._commands, &_commands);
+}
+
 // Computes the log base 2 of value, and checks for cases of split buckets.
 int OperationLatencyHistogram::_getBucket(uint64_t value) {
     // Zero is a special case since log(0) is undefined.
@@ -148,9 +163,9 @@ int OperationLatencyHistogram::_getBucket(uint64_t value) {
 }
 
 void OperationLatencyHistogram::_incrementData(uint64_t latency, int bucket, HistogramData* data) {
-    data->buckets[bucket]++;
-    data->entryCount++;
-    data->sum += latency;
+    data->buckets[bucket].fetchAndAdd(1);
+    data->entryCount.fetchAndAdd(1);
+    data->sum.fetchAndAdd(latency);
 }
 
 void OperationLatencyHistogram::increment(uint64_t latency, Command::ReadWriteType type) {
@@ -30,6 +30,7 @@
 #include <array>
 
 #include "mongo/db/commands.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -38,7 +39,8 @@ class BSONObjBuilder;
 /**
  * Stores statistics for latencies of read, write, and command operations.
  *
- * Note: This class is not thread-safe.
+ * Increments may run concurrently with each other and with reads. A concurrent read may see part
+ * of an increment, such as the operation counted in its bucket but not yet in the total.
  */
 class OperationLatencyHistogram {
 public:
@@ -57,13 +59,20 @@ public:
      */
     void append(bool includeHistograms, BSONObjBuilder* builder) const;
 
+    /**
+     * Adds the counts and latencies of 'other' to this histogram.
+     */
+    void add(const OperationLatencyHistogram& other);
+
 private:
     struct HistogramData {
-        std::array<uint64_t, kMaxBuckets> buckets{};
-        uint64_t entryCount = 0;
-        uint64_t sum = 0;
+        std::array<AtomicUInt64, kMaxBuckets> buckets;
+        AtomicUInt64 entryCount;
+        AtomicUInt64 sum;
     };
 
+    static void _addData(const HistogramData& from, HistogramData* to);
+
     static int _getBucket(uint64_t latency);
 
     static uint64_t _getBucketMicros(int bucket);
@@ -89,4 +89,33 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
         ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
     }
 }
+
+TEST(OperationLatencyHistogram, AddCombinesHistograms) {
+    OperationLatencyHistogram first;
+    first.increment(10, Command::ReadWriteType::kRead);
+    first.increment(5000, Command::ReadWriteType::kWrite);
+
+    OperationLatencyHistogram second;
+    second.increment(12, Command::ReadWriteType::kRead);
+    second.increment(7, Command::ReadWriteType::kCommand);
+
+    OperationLatencyHistogram combined;
+    combined.add(first);
+    combined.add(second);
+
+    BSONObjBuilder outBuilder;
+    combined.append(true, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["reads"]["ops"].Long(), 2);
+    ASSERT_EQUALS(out["reads"]["latency"].Long(), 22);
+    ASSERT_EQUALS(out["writes"]["ops"].Long(), 1);
+    ASSERT_EQUALS(out["writes"]["latency"].Long(), 5000);
+    ASSERT_EQUALS(out["commands"]["ops"].Long(), 1);
+
+    // 10 and 12 both fall into the bucket starting at 8
+    std::vector<BSONElement> readBuckets = out["reads"]["histogram"].Array();
+    ASSERT_EQUALS(readBuckets.size(), 1U);
+    ASSERT_EQUALS(readBuckets[0].Obj()["micros"].Long(), 8);
+    ASSERT_EQUALS(readBuckets[0].Obj()["count"].Long(), 2);
+}
 }  // namespace mongo
@@ -48,6 +48,8 @@ namespace {
 
 const auto getTop = ServiceContext::declareDecoration<Top>();
 
+const auto getOperationSlot = OperationContext::declareDecoration<std::shared_ptr<TopSlot>>();
+
 }  // namespace
 
 Top::UsageData::UsageData(const UsageData& older, const UsageData& newer) {
@@ -72,6 +74,22 @@ Top& Top::get(ServiceContext* service) {
     return getTop(service);
 }
 
+std::shared_ptr<TopSlot> Top::getOrCreateSlot(StringData ns) {
+    auto hashedNs = SlotMap::HashedKey(ns);
+    stdx::lock_guard<SimpleMutex> lk(_lock);
+
+    auto& slot = _usage[hashedNs];
+    if (!slot) {
+        slot = std::make_shared<TopSlot>(ns);
+    }
+    return slot;
+}
+
+// static
+void Top::setOperationSlot(OperationContext* opCtx, std::shared_ptr<TopSlot> slot) {
+    getOperationSlot(opCtx) = std::move(slot);
+}
+
 void Top::record(OperationContext* opCtx,
                  StringData ns,
                  LogicalOp logicalOp,
@@ -82,20 +100,34 @@ void Top::record(OperationContext* opCtx,
     if (ns[0] == '?')
         return;
 
-    auto hashedNs = UsageMap::HashedKey(ns);
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-
-    if ((command || logicalOp == LogicalOp::opQuery) && ns == _lastDropped) {
-        _lastDropped = "";
+    // Fast path for operations on a collection, which carry its slot
+    const auto& operationSlot = getOperationSlot(opCtx);
+    if (operationSlot && !operationSlot->dropped.load() && operationSlot->ns == ns) {
+        _record(opCtx, *operationSlot, logicalOp, lockType, micros, readWriteType);
         return;
     }
 
-    CollectionData& coll = _usage[hashedNs];
-    _record(opCtx, coll, logicalOp, lockType, micros, readWriteType);
+    std::shared_ptr<TopSlot> slot;
+    {
+        auto hashedNs = SlotMap::HashedKey(ns);
+        stdx::lock_guard<SimpleMutex> lk(_lock);
+
+        if ((command || logicalOp == LogicalOp::opQuery) && ns == _lastDropped) {
+            _lastDropped = "";
+            return;
+        }
+
+        auto& entry = _usage[hashedNs];
+        if (!entry) {
+            entry = std::make_shared<TopSlot>(ns);
+        }
+        slot = entry;
+    }
+    _record(opCtx, *slot, logicalOp, lockType, micros, readWriteType);
 }
 
 void Top::_record(OperationContext* opCtx,
-                  CollectionData& c,
+                  TopSlot& c,
                   LogicalOp logicalOp,
                   LockType lockType,
                   long long micros,
@@ -141,7 +173,12 @@ void Top::_record(OperationContext* opCtx,
 
 void Top::collectionDropped(StringData ns, bool databaseDropped) {
     stdx::lock_guard<SimpleMutex> lk(_lock);
-    _usage.erase(ns);
+    auto it = _usage.find(ns);
+    if (it != _usage.end()) {
+        // Collections and operations may still hold on to the slot
+        it->second->dropped.store(true);
+        _usage.erase(it);
+    }
     if (!databaseDropped) {
         // If a collection drop occurred, there will be a subsequent call to record for this
         // collection namespace which must be ignored. This does not apply to a database drop.
@@ -149,14 +186,45 @@ void Top::collectionDropped(StringData ns, bool databaseDropped) {
     }
 }
 
+void Top::_snapshot(const TopSlot& slot, CollectionData* out) {
+    auto load = [](const TopSlot::Usage& usage, UsageData* data) {
+        data->time = usage.time.loadRelaxed();
+        data->count = usage.count.loadRelaxed();
+    };
+
+    load(slot.total, &out->total);
+    load(slot.readLock, &out->readLock);
+    load(slot.writeLock, &out->writeLock);
+    load(slot.queries, &out->queries);
+    load(slot.getmore, &out->getmore);
+    load(slot.insert, &out->insert);
+    load(slot.update, &out->update);
+    load(slot.remove, &out->remove);
+    load(slot.commands, &out->commands);
+}
+
 void Top::cloneMap(Top::UsageMap& out) const {
     stdx::lock_guard<SimpleMutex> lk(_lock);
-    out = _usage;
+    out.clear();
+    for (const auto& entry : _usage) {
+        _snapshot(*entry.second, &out[entry.first]);
+    }
 }
 
 void Top::append(BSONObjBuilder& b) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _appendToUsageMap(b, _usage);
+    UsageMap usage;
+    cloneMap(usage);
+
+    // Collections get their slot when they are instantiated, so skip the ones never used
+    for (auto it = usage.begin(); it != usage.end();) {
+        if (it->second.total.count == 0) {
+            usage.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+
+    _appendToUsageMap(b, usage);
 }
 
 void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
@@ -198,10 +266,21 @@ void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const Usag
 }
 
 void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder) {
-    auto hashedNs = UsageMap::HashedKey(ns);
-    stdx::lock_guard<SimpleMutex> lk(_lock);
+    std::shared_ptr<TopSlot> slot;
+    {
+        stdx::lock_guard<SimpleMutex> lk(_lock);
+        auto it = _usage.find(ns);
+        if (it != _usage.end()) {
+            slot = it->second;
+        }
+    }
+
     BSONObjBuilder latencyStatsBuilder;
-    _usage[hashedNs].opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    if (slot) {
+        slot->opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    } else {
+        OperationLatencyHistogram().append(includeHistograms, &latencyStatsBuilder);
+    }
     builder->append("ns", ns);
     builder->append("latencyStats", latencyStatsBuilder.obj());
 }
@@ -209,13 +288,16 @@ void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuild
 void Top::incrementGlobalLatencyStats(OperationContext* opCtx,
                                       uint64_t latency,
                                       Command::ReadWriteType readWriteType) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
-    _incrementHistogram(opCtx, latency, &_globalHistogramStats, readWriteType);
+    _incrementHistogram(
+        opCtx, latency, &_globalHistogramStats[getCounterStripe()], readWriteType);
 }
 
 void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder) {
-    stdx::lock_guard<SimpleMutex> guard(_lock);
-    _globalHistogramStats.append(includeHistograms, builder);
+    OperationLatencyHistogram histogram;
+    for (const auto& stripe : _globalHistogramStats) {
+        histogram.add(stripe);
+    }
+    histogram.append(includeHistograms, builder);
 }
 
 void Top::_incrementHistogram(OperationContext* opCtx,
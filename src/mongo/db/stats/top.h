@@ -29,12 +29,16 @@
 
 #pragma once
 
+#include <array>
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <memory>
 
 #include "mongo/db/commands.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/stats/operation_latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/striped_counter.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/string_map.h"
 
@@ -42,6 +46,44 @@ namespace mongo {
 
 class ServiceContext;
 
+/**
+ * The usage statistics Top keeps for one namespace. A Collection holds on to the slot of its
+ * namespace, so that operations which resolved the collection can record their statistics
+ * without looking up the namespace or taking a lock. Updated with atomics, so a concurrent reader
+ * may see part of an operation's update.
+ */
+struct TopSlot {
+    explicit TopSlot(StringData ns) : ns(ns.toString()) {}
+
+    struct Usage {
+        void inc(long long micros) {
+            count.fetchAndAdd(1);
+            time.fetchAndAdd(micros);
+        }
+
+        AtomicInt64 time;
+        AtomicInt64 count;
+    };
+
+    const std::string ns;
+
+    // Set once the namespace has been dropped and the slot no longer receives statistics
+    AtomicWord<bool> dropped{false};
+
+    Usage total;
+
+    Usage readLock;
+    Usage writeLock;
+
+    Usage queries;
+    Usage getmore;
+    Usage insert;
+    Usage update;
+    Usage remove;
+    Usage commands;
+    OperationLatencyHistogram opLatencyHistogram;
+};
+
 /**
  * tracks usage by collection
  */
@@ -81,7 +123,6 @@ public:
         UsageData update;
         UsageData remove;
         UsageData commands;
-        OperationLatencyHistogram opLatencyHistogram;
     };
 
     enum class LockType {
@@ -93,6 +134,18 @@ public:
     typedef StringMap<CollectionData> UsageMap;
 
 public:
+    /**
+     * Returns the slot for the statistics of 'ns', creating it if needed. Collections cache it
+     * when they are instantiated.
+     */
+    std::shared_ptr<TopSlot> getOrCreateSlot(StringData ns);
+
+    /**
+     * Remembers the slot of the collection the operation works on, so that record() can use it
+     * instead of looking up the namespace. The slot may be null.
+     */
+    static void setOperationSlot(OperationContext* opCtx, std::shared_ptr<TopSlot> slot);
+
     void record(OperationContext* opCtx,
                 StringData ns,
                 LogicalOp logicalOp,
@@ -129,8 +182,12 @@ private:
 
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
 
+    typedef StringMap<std::shared_ptr<TopSlot>> SlotMap;
+
+    static void _snapshot(const TopSlot& slot, CollectionData* out);
+
     void _record(OperationContext* opCtx,
-                 CollectionData& c,
+                 TopSlot& c,
                  LogicalOp logicalOp,
                  LockType lockType,
                  long long micros,
@@ -141,10 +198,14 @@ private:
                              OperationLatencyHistogram* histogram,
                              Command::ReadWriteType readWriteType);
 
+    // Protects the map of slots and _lastDropped, but not the statistics in the slots.
     mutable SimpleMutex _lock;
-    OperationLatencyHistogram _globalHistogramStats;
-    UsageMap _usage;
+    SlotMap _usage;
     std::string _lastDropped;
+
+    // Every operation updates the global histogram, so it is striped per CPU and added up when
+    // appended.
+    std::array<OperationLatencyHistogram, kNumCounterStripes> _globalHistogramStats;
 };
 
 }  // namespace mongo
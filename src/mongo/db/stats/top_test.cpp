@@ -39,4 +39,44 @@ TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST(TopTest, GetOrCreateSlotReturnsSameSlot) {
+    Top top;
+    auto slot = top.getOrCreateSlot("db.coll");
+    ASSERT(slot);
+    ASSERT_EQUALS("db.coll", slot->ns);
+    ASSERT(slot == top.getOrCreateSlot("db.coll"));
+    ASSERT(slot != top.getOrCreateSlot("db.other"));
+}
+
+TEST(TopTest, CollectionDroppedDetachesSlot) {
+    Top top;
+    auto slot = top.getOrCreateSlot("db.coll");
+    ASSERT_FALSE(slot->dropped.load());
+
+    top.collectionDropped("db.coll");
+    ASSERT(slot->dropped.load());
+
+    auto newSlot = top.getOrCreateSlot("db.coll");
+    ASSERT(newSlot != slot);
+    ASSERT_FALSE(newSlot->dropped.load());
+}
+
+TEST(TopTest, AppendSkipsUnusedSlots) {
+    Top top;
+    top.getOrCreateSlot("db.unused");
+    auto slot = top.getOrCreateSlot("db.used");
+    slot->total.inc(5);
+    slot->insert.inc(5);
+
+    BSONObjBuilder builder;
+    top.append(builder);
+    BSONObj out = builder.obj();
+
+    ASSERT_FALSE(out.hasField("db.unused"));
+    ASSERT_EQUALS(1, out["db.used"]["total"]["count"].numberLong());
+    ASSERT_EQUALS(5, out["db.used"]["total"]["time"].numberLong());
+    ASSERT_EQUALS(1, out["db.used"]["insert"]["count"].numberLong());
+    ASSERT_EQUALS(0, out["db.used"]["update"]["count"].numberLong());
+}
+
 }  // namespace
@@ -74,6 +74,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/exit.h"
@@ -276,11 +277,17 @@ class TicketServerParameter : public ServerParameter {
     MONGO_DISALLOW_COPYING(TicketServerParameter);
 
 public:
-    TicketServerParameter(TicketHolder* holder, const std::string& name)
-        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true), _holder(holder) {}
+    /**
+     * Sets the total number of tickets of 'holder', or the number reserved for high priority
+     * operations if 'reserved' is true.
+     */
+    TicketServerParameter(TicketHolder* holder, const std::string& name, bool reserved = false)
+        : ServerParameter(ServerParameterSet::getGlobal(), name, true, true),
+          _holder(holder),
+          _reserved(reserved) {}
 
     virtual void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) {
-        b.append(name, _holder->outof());
+        b.append(name, _reserved ? _holder->reserved() : _holder->outof());
     }
 
     virtual Status set(const BSONElement& newValueElement) {
@@ -298,6 +305,10 @@ public:
     }
 
     Status _set(int newNum) {
+        if (_reserved) {
+            return _holder->setReserved(newNum);
+        }
+
         if (newNum <= 0) {
             return Status(ErrorCodes::BadValue, str::stream() << name() << " has to be > 0");
         }
@@ -307,21 +318,200 @@ public:
 
 private:
     TicketHolder* _holder;
+    const bool _reserved;
 };
 
 TicketHolder openWriteTransaction(128);
 TicketServerParameter openWriteTransactionParam(&openWriteTransaction,
                                                 "wiredTigerConcurrentWriteTransactions");
+TicketServerParameter openWriteTransactionReservedParam(
+    &openWriteTransaction, "wiredTigerConcurrentWriteTransactionsReserved", true);
 
 TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
+TicketServerParameter openReadTransactionReservedParam(
+    &openReadTransaction, "wiredTigerConcurrentReadTransactionsReserved", true);
+
+// Whether the number of read and write tickets is adjusted automatically, and how often.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketControl, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketControlIntervalMillis, int, 1000);
 
 stdx::function<bool(StringData)> initRsOplogBackgroundThreadCallback = [](StringData) -> bool {
     fassertFailed(40358);
 };
 }  // namespace
 
+/**
+ * Adjusts the number of read and write tickets with an AdaptiveTicketController each, when
+ * wiredTigerAdaptiveTicketControl is enabled. Throughput is measured by the cursor operations
+ * reported by WiredTiger. Both kinds of tickets back off while application threads are stalled
+ * doing eviction, and write tickets also while the cache holds too much dirty data.
+ */
+class WiredTigerKVEngine::WiredTigerTicketControlThread : public BackgroundJob {
+public:
+    explicit WiredTigerTicketControlThread(WiredTigerSessionCache* sessionCache)
+        : BackgroundJob(false /* deleteSelf */), _sessionCache(sessionCache) {}
+
+    virtual string name() const {
+        return "WTTicketControl";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+
+        LOG(1) << "starting " << name() << " thread";
+
+        boost::optional<Measurement> previous;
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(lock,
+                                  stdx::chrono::milliseconds(std::max(
+                                      10, wiredTigerAdaptiveTicketControlIntervalMillis.load())));
+            }
+
+            if (_shuttingDown.load()) {
+                break;
+            }
+
+            if (!wiredTigerAdaptiveTicketControl.load()) {
+                // Start over from the configured number of tickets when re-enabled.
+                _readController = boost::none;
+                _writeController = boost::none;
+                previous = boost::none;
+                continue;
+            }
+
+            try {
+                Measurement current = _measure();
+                if (previous) {
+                    _adjust(*previous, current);
+                }
+                previous = current;
+            } catch (const DBException& e) {
+                LOG(1) << "unable to adjust the number of tickets: " << e.toStatus();
+                previous = boost::none;
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        _shuttingDown.store(true);
+        {
+            stdx::lock_guard<stdx::mutex> lock(_mutex);
+            _condvar.notify_one();
+        }
+        wait();
+    }
+
+private:
+    // Application threads which spend more than this fraction of the interval evicting, summed
+    // over all of them, mean that the cache is too full for the current concurrency.
+    static constexpr double kEvictionStallFraction = 0.1;
+
+    // The fraction of the cache which may be dirty before writes back off. This is below the
+    // eviction_dirty_trigger, at which application threads start to be throttled.
+    static constexpr double kMaxDirtyFraction = 0.15;
+
+    static constexpr int kMaxTickets = 1024;
+
+    struct Measurement {
+        unsigned long long micros = 0;
+        int64_t reads = 0;
+        int64_t writes = 0;
+        int64_t dirtyBytes = 0;
+        int64_t maxBytes = 0;
+        int64_t evictionMicros = 0;
+        long long readWaits = 0;
+        long long writeWaits = 0;
+    };
+
+    Measurement _measure() {
+        UniqueWiredTigerSession session = _sessionCache->getSession();
+        WT_SESSION* s = session->getSession();
+        auto getStatistic = [&](int key) {
+            return uassertStatusOK(WiredTigerUtil::getStatisticsValueAs<int64_t>(
+                s, "statistics:", "statistics=(fast)", key));
+        };
+
+        Measurement measurement;
+        measurement.micros = curTimeMicros64();
+        measurement.reads = getStatistic(WT_STAT_CONN_CURSOR_SEARCH) +
+            getStatistic(WT_STAT_CONN_CURSOR_NEXT) + getStatistic(WT_STAT_CONN_CURSOR_PREV);
+        measurement.writes = getStatistic(WT_STAT_CONN_CURSOR_INSERT) +
+            getStatistic(WT_STAT_CONN_CURSOR_UPDATE) + getStatistic(WT_STAT_CONN_CURSOR_REMOVE);
+        measurement.dirtyBytes = getStatistic(WT_STAT_CONN_CACHE_BYTES_DIRTY);
+        measurement.maxBytes = getStatistic(WT_STAT_CONN_CACHE_BYTES_MAX);
+        measurement.evictionMicros = getStatistic(WT_STAT_CONN_APPLICATION_EVICT_TIME);
+        measurement.readWaits = openReadTransaction.numWaits();
+        measurement.writeWaits = openWriteTransaction.numWaits();
+        return measurement;
+    }
+
+    void _adjust(const Measurement& previous, const Measurement& current) {
+        if (current.micros <= previous.micros) {
+            return;
+        }
+        const double seconds = (current.micros - previous.micros) / 1000000.0;
+
+        const bool evictionStalled = current.evictionMicros - previous.evictionMicros >
+            kEvictionStallFraction * seconds * 1000000;
+        const bool cacheDirty =
+            current.dirtyBytes > kMaxDirtyFraction * static_cast<double>(current.maxBytes);
+
+        AdaptiveTicketController::Sample readSample;
+        readSample.throughput = (current.reads - previous.reads) / seconds;
+        readSample.saturated = current.readWaits > previous.readWaits;
+        readSample.congested = evictionStalled;
+        _adjust(&openReadTransaction, &_readController, readSample);
+
+        AdaptiveTicketController::Sample writeSample;
+        writeSample.throughput = (current.writes - previous.writes) / seconds;
+        writeSample.saturated = current.writeWaits > previous.writeWaits;
+        writeSample.congested = evictionStalled || cacheDirty;
+        _adjust(&openWriteTransaction, &_writeController, writeSample);
+    }
+
+    void _adjust(TicketHolder* holder,
+                 boost::optional<AdaptiveTicketController>* controller,
+                 const AdaptiveTicketController::Sample& sample) {
+        if (!*controller) {
+            AdaptiveTicketController::Options options;
+            options.minTickets = std::max(options.minTickets, holder->reserved() + 1);
+            options.maxTickets = std::max(kMaxTickets, holder->outof());
+            controller->emplace(holder->outof(), options);
+        }
+
+        const int tickets = (*controller)->update(sample);
+        if (tickets != holder->outof()) {
+            LOG(2) << "resizing tickets from " << holder->outof() << " to " << tickets;
+            // Shrinking waits for tickets in use to be released, which a long running operation
+            // may not do for a while. Give up after one interval and continue on the next one.
+            const Date_t deadline = Date_t::now() +
+                Milliseconds(std::max(10, wiredTigerAdaptiveTicketControlIntervalMillis.load()));
+            Status status = holder->resize(tickets, deadline);
+            if (!status.isOK()) {
+                LOG(1) << "unable to resize tickets: " << status;
+            }
+        }
+    }
+
+    WiredTigerSessionCache* _sessionCache;
+    boost::optional<AdaptiveTicketController> _readController;
+    boost::optional<AdaptiveTicketController> _writeController;
+
+    stdx::mutex _mutex;  // protects _condvar
+    stdx::condition_variable _condvar;
+    AtomicBool _shuttingDown{false};
+};
+
+constexpr double WiredTigerKVEngine::WiredTigerTicketControlThread::kEvictionStallFraction;
+constexpr double WiredTigerKVEngine::WiredTigerTicketControlThread::kMaxDirtyFraction;
+constexpr int WiredTigerKVEngine::WiredTigerTicketControlThread::kMaxTickets;
+
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
                                        const std::string& path,
                                        ClockSource* cs,
@@ -434,6 +624,12 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         _checkpointThread->go();
     }
 
+    if (!_readOnly) {
+        _ticketControlThread =
+            stdx::make_unique<WiredTigerTicketControlThread>(_sessionCache.get());
+        _ticketControlThread->go();
+    }
+
     _sizeStorerUri = "table:sizeStorer";
     WiredTigerSession session(_conn);
     if (!_readOnly && repair && _hasUri(session.getSession(), _sizeStorerUri)) {
@@ -462,16 +658,12 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
     BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
     {
         BSONObjBuilder bbb(bb.subobjStart("write"));
-        bbb.append("out", openWriteTransaction.used());
-        bbb.append("available", openWriteTransaction.available());
-        bbb.append("totalTickets", openWriteTransaction.outof());
+        openWriteTransaction.appendStats(&bbb);
         bbb.done();
     }
     {
         BSONObjBuilder bbb(bb.subobjStart("read"));
-        bbb.append("out", openReadTransaction.used());
-        bbb.append("available", openReadTransaction.available());
-        bbb.append("totalTickets", openReadTransaction.outof());
+        openReadTransaction.appendStats(&bbb);
         bbb.done();
     }
     bb.done();
@@ -487,6 +679,8 @@ void WiredTigerKVEngine::cleanShutdown() {
             _journalFlusher->shutdown();
         if (_checkpointThread)
             _checkpointThread->shutdown();
+        if (_ticketControlThread)
+            _ticketControlThread->shutdown();
         _sizeStorer.reset();
         _sessionCache->shuttingDown();
 
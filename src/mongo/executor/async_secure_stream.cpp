@@ -88,6 +88,8 @@ void AsyncSecureStream::read(asio::mutable_buffer buffer, StreamHandler&& stream
 }
 
 void AsyncSecureStream::_handleConnect(asio::ip::tcp::resolver::iterator iter) {
+    getSSLManager()->prepareOutgoingSession(_stream.native_handle(),
+                                            iter->host_name() + ':' + iter->service_name());
     _stream.async_handshake(decltype(_stream)::client,
                             _strand->wrap([this, iter](std::error_code ec) {
                                 if (ec) {
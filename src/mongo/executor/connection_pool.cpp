@@ -43,7 +43,7 @@
 #include "mongo/util/scopeguard.h"
 
 // One interesting implementation note herein concerns how setup() and
-// refresh() are invoked outside of the global lock, but setTimeout is not.
+// refresh() are invoked outside of the specific pool's lock, but setTimeout is not.
 // This implementation detail simplifies mocks, allowing them to return
 // synchronously sometimes, whereas having timeouts fire instantly adds little
 // value. In practice, dumping the locks is always safe (because we restrict
@@ -68,7 +68,7 @@ public:
      *
      * The complexity comes from the need to hold a lock when writing to the
      * _activeClients param on the specific pool.  Because the code beneath the client needs to lock
-     * and unlock the parent mutex (and can leave unlocked), we want to start the client with the
+     * and unlock the pool's mutex (and can leave unlocked), we want to start the client with the
      * lock acquired, move it into the client, then re-acquire to decrement the counter on the way
      * out.
      *
@@ -78,8 +78,7 @@ public:
      */
     template <typename Callback>
     void runWithActiveClient(Callback&& cb) {
-        runWithActiveClient(stdx::unique_lock<stdx::mutex>(_parent->_mutex),
-                            std::forward<Callback>(cb));
+        runWithActiveClient(stdx::unique_lock<stdx::mutex>(_mutex), std::forward<Callback>(cb));
     }
 
     template <typename Callback>
@@ -90,7 +89,7 @@ public:
 
         const auto guard = MakeGuard([&] {
             invariant(!lk.owns_lock());
-            stdx::lock_guard<stdx::mutex> lk(_parent->_mutex);
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
             _activeClients--;
         });
 
@@ -104,8 +103,23 @@ public:
     ~SpecificPool();
 
     /**
-     * Gets a connection from the specific pool. Sinks a unique_lock from the
-     * parent to preserve the lock on _mutex
+     * Acquires the lock which guards the state of this specific pool.
+     */
+    stdx::unique_lock<stdx::mutex> lock() {
+        return stdx::unique_lock<stdx::mutex>(_mutex);
+    }
+
+    /**
+     * Returns true if the pool has shut down and was removed from its parent. A removed pool must
+     * not be used, callers which still hold a reference to it should look the pool up again.
+     */
+    bool isRemoved(const stdx::unique_lock<stdx::mutex>& lk) const {
+        return _removed;
+    }
+
+    /**
+     * Gets a connection from the specific pool. Sinks a unique_lock on this
+     * pool's _mutex
      */
     void getConnection(const HostAndPort& hostAndPort,
                        Milliseconds timeout,
@@ -120,11 +134,20 @@ public:
     void processFailure(const Status& status, stdx::unique_lock<stdx::mutex> lk);
 
     /**
-     * Returns a connection to a specific pool. Sinks a unique_lock from the
-     * parent to preserve the lock on _mutex
+     * Returns a connection to a specific pool. Sinks a unique_lock on this
+     * pool's _mutex
      */
     void returnConnection(ConnectionInterface* connection, stdx::unique_lock<stdx::mutex> lk);
 
+    /**
+     * Returns a connection to a specific pool, acquiring the pool's lock.
+     */
+    void returnConnection(ConnectionInterface* connection) {
+        runWithActiveClient([&](stdx::unique_lock<stdx::mutex> lk) {
+            returnConnection(connection, std::move(lk));
+        });
+    }
+
     /**
      * Returns the number of connections currently checked out of the pool.
      */
@@ -169,18 +192,6 @@ public:
         _tags = mutateFunc(_tags);
     }
 
-    /**
-     * See runWithActiveClient for what this controls, and be very very careful to manage the
-     * refcount correctly.
-     */
-    void incActiveClients(const stdx::unique_lock<stdx::mutex>& lk) {
-        _activeClients++;
-    }
-
-    void decActiveClients(const stdx::unique_lock<stdx::mutex>& lk) {
-        _activeClients--;
-    }
-
 private:
     using OwnedConnection = std::unique_ptr<ConnectionInterface>;
     using OwnershipPool = stdx::unordered_map<ConnectionInterface*, OwnedConnection>;
@@ -213,6 +224,9 @@ private:
 
     const HostAndPort _hostAndPort;
 
+    // Guards all the state below
+    stdx::mutex _mutex;
+
     LRUOwnershipPool _readyPool;
     OwnershipPool _processingPool;
     OwnershipPool _droppedProcessingPool;
@@ -229,6 +243,9 @@ private:
 
     size_t _created;
 
+    // Set once the pool has been removed from _parent->_pools
+    bool _removed = false;
+
     transport::Session::TagMask _tags = transport::Session::kPending;
 
     /**
@@ -285,130 +302,155 @@ ConnectionPool::~ConnectionPool() {
     }
 }
 
-void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+std::shared_ptr<ConnectionPool::SpecificPool> ConnectionPool::_findPool(
+    const HostAndPort& hostAndPort) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     auto iter = _pools.find(hostAndPort);
 
     if (iter == _pools.end())
+        return nullptr;
+
+    return iter->second;
+}
+
+void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
+    auto pool = _findPool(hostAndPort);
+
+    if (!pool)
+        return;
+
+    auto lk = pool->lock();
+
+    if (pool->isRemoved(lk))
         return;
 
-    iter->second->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
-        iter->second->processFailure(
+    pool->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
+        pool->processFailure(
             Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
             std::move(lk));
     });
 }
 
 void ConnectionPool::dropConnections(transport::Session::TagMask tags) {
-    std::vector<SpecificPool*> pools;
-
-    // Ensure we decrement active clients for all pools that we inc on (because we intend to process
-    // failures)
-    const auto guard = MakeGuard([&] {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-        for (const auto& pool : pools) {
-            pool->decActiveClients(lk);
-        }
-    });
-
-    // Grab all current pools that don't match tags (under the lock)
+    // Grab all current pools, so that _mutex is not held while each pool is processed
+    std::vector<std::shared_ptr<SpecificPool>> pools;
     {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
 
         for (auto& pair : _pools) {
-            if (!pair.second->matchesTags(lk, tags)) {
-                pools.push_back(pair.second.get());
-                pair.second->incActiveClients(lk);
-            }
+            pools.push_back(pair.second);
         }
     }
 
-    // Reacquire the lock per pool and process failures.  We'll dec active clients when we're all
-    // through in the guard
+    // Acquire the lock per pool and process failures on the pools that don't match tags
     for (const auto& pool : pools) {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
-        pool->processFailure(
-            Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
-            std::move(lk));
+        auto lk = pool->lock();
+
+        if (pool->isRemoved(lk) || pool->matchesTags(lk, tags))
+            continue;
+
+        pool->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
+            pool->processFailure(
+                Status(ErrorCodes::PooledConnectionsDropped, "Pooled connections dropped"),
+                std::move(lk));
+        });
     }
 }
 
 void ConnectionPool::mutateTags(
     const HostAndPort& hostAndPort,
     const stdx::function<transport::Session::TagMask(transport::Session::TagMask)>& mutateFunc) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto pool = _findPool(hostAndPort);
 
-    auto iter = _pools.find(hostAndPort);
+    if (!pool)
+        return;
 
-    if (iter == _pools.end())
+    auto lk = pool->lock();
+
+    if (pool->isRemoved(lk))
         return;
 
-    iter->second->mutateTags(lk, mutateFunc);
+    pool->mutateTags(lk, mutateFunc);
 }
 
 void ConnectionPool::get(const HostAndPort& hostAndPort,
                          Milliseconds timeout,
                          GetConnectionCallback cb) {
-    SpecificPool* pool;
+    while (true) {
+        std::shared_ptr<SpecificPool> pool;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+            auto& slot = _pools[hostAndPort];
 
-    auto iter = _pools.find(hostAndPort);
+            if (!slot) {
+                slot = std::make_shared<SpecificPool>(this, hostAndPort);
+            }
 
-    if (iter == _pools.end()) {
-        auto handle = stdx::make_unique<SpecificPool>(this, hostAndPort);
-        pool = handle.get();
-        _pools[hostAndPort] = std::move(handle);
-    } else {
-        pool = iter->second.get();
-    }
+            pool = slot;
+        }
 
-    invariant(pool);
+        invariant(pool);
 
-    pool->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
-        pool->getConnection(hostAndPort, timeout, std::move(lk), std::move(cb));
-    });
+        auto lk = pool->lock();
+
+        // The pool shut down between the lookup and acquiring its lock, so a fresh pool is needed
+        if (pool->isRemoved(lk))
+            continue;
+
+        pool->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
+            pool->getConnection(hostAndPort, timeout, std::move(lk), std::move(cb));
+        });
+        return;
+    }
 }
 
 void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    // Only hold _mutex while copying the pool list, so that collecting stats only briefly
+    // contends with each individual host.
+    std::vector<std::pair<HostAndPort, std::shared_ptr<SpecificPool>>> pools;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        pools.assign(_pools.begin(), _pools.end());
+    }
+
+    for (const auto& kv : pools) {
+        const auto& host = kv.first;
+        const auto& pool = kv.second;
 
-    for (const auto& kv : _pools) {
-        HostAndPort host = kv.first;
+        auto lk = pool->lock();
+
+        if (pool->isRemoved(lk))
+            continue;
 
-        auto& pool = kv.second;
         ConnectionStatsPer hostStats{pool->inUseConnections(lk),
                                      pool->availableConnections(lk),
                                      pool->createdConnections(lk),
                                      pool->refreshingConnections(lk)};
+        lk.unlock();
+
         stats->updateStatsForHost(_name, host, hostStats);
     }
 }
 
 size_t ConnectionPool::getNumConnectionsPerHost(const HostAndPort& hostAndPort) const {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-    auto iter = _pools.find(hostAndPort);
-    if (iter != _pools.end()) {
-        return iter->second->openConnections(lk);
-    }
+    auto pool = _findPool(hostAndPort);
 
-    return 0;
-}
+    if (!pool)
+        return 0;
 
-void ConnectionPool::returnConnection(ConnectionInterface* conn) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    auto lk = pool->lock();
 
-    auto iter = _pools.find(conn->getHostAndPort());
+    if (pool->isRemoved(lk))
+        return 0;
 
-    invariant(iter != _pools.end(),
-              str::stream() << "Tried to return connection but no pool found for "
-                            << conn->getHostAndPort());
+    return pool->openConnections(lk);
+}
 
-    iter->second->runWithActiveClient(std::move(lk), [&](decltype(lk) lk) {
-        iter->second->returnConnection(conn, std::move(lk));
-    });
+void ConnectionPool::ConnectionHandleDeleter::operator()(ConnectionInterface* connection) {
+    if (_pool && connection)
+        _pool->returnConnection(connection);
 }
 
 ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort)
@@ -689,7 +731,7 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
         // pass it to the user
         connPtr->resetToUnknown();
         lk.unlock();
-        cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(_parent)));
+        cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(this)));
         lk.lock();
     }
 }
@@ -765,7 +807,17 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
 
 // Called every second after hostTimeout until all processing connections reap
 void ConnectionPool::SpecificPool::shutdown() {
-    stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+    // The pool may remove itself from the parent, which requires the parent's lock to be
+    // acquired before our own.
+    stdx::lock_guard<stdx::mutex> parentLk(_parent->_mutex);
+
+    auto iter = _parent->_pools.find(_hostAndPort);
+    invariant(iter != _parent->_pools.end() && iter->second.get() == this);
+
+    // Keeps the pool alive until its lock has been released below
+    const auto self = iter->second;
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
 
     // We're racing:
     //
@@ -799,7 +851,8 @@ void ConnectionPool::SpecificPool::shutdown() {
     invariant(_requests.empty());
     invariant(_checkedOutPool.empty());
 
-    _parent->_pools.erase(_hostAndPort);
+    _removed = true;
+    _parent->_pools.erase(iter);
 }
 
 template <typename OwnershipPoolType>
@@ -151,7 +151,10 @@ public:
     size_t getNumConnectionsPerHost(const HostAndPort& hostAndPort) const;
 
 private:
-    void returnConnection(ConnectionInterface* connection);
+    /**
+     * Returns the pool for the given host, or nullptr if there is none.
+     */
+    std::shared_ptr<SpecificPool> _findPool(const HostAndPort& hostAndPort) const;
 
     std::string _name;
 
@@ -161,9 +164,11 @@ private:
 
     const std::unique_ptr<DependentTypeFactoryInterface> _factory;
 
-    // The global mutex for specific pool access and the generation counter
+    // Only guards the membership of _pools. Each SpecificPool has its own mutex for its
+    // connections and requests, so that traffic to different hosts does not contend. If both are
+    // needed, _mutex must be acquired first.
     mutable stdx::mutex _mutex;
-    stdx::unordered_map<HostAndPort, std::unique_ptr<SpecificPool>> _pools;
+    stdx::unordered_map<HostAndPort, std::shared_ptr<SpecificPool>> _pools;
 
     EgressTagCloserManager* _manager;
 };
@@ -171,15 +176,14 @@ private:
 class ConnectionPool::ConnectionHandleDeleter {
 public:
     ConnectionHandleDeleter() = default;
-    ConnectionHandleDeleter(ConnectionPool* pool) : _pool(pool) {}
+    ConnectionHandleDeleter(SpecificPool* pool) : _pool(pool) {}
 
-    void operator()(ConnectionInterface* connection) {
-        if (_pool && connection)
-            _pool->returnConnection(connection);
-    }
+    // A specific pool outlives all the connections checked out from it, so the connection can be
+    // returned directly without looking the pool up.
+    void operator()(ConnectionInterface* connection);
 
 private:
-    ConnectionPool* _pool = nullptr;
+    SpecificPool* _pool = nullptr;
 };
 
 /**
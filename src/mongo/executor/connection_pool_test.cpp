@@ -34,6 +34,7 @@
 #include "mongo/executor/connection_pool_test_fixture.h"
 
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -333,6 +334,51 @@ TEST_F(ConnectionPoolTest, DifferentHostDifferentConn) {
     ASSERT_NE(conn1Id, conn2Id);
 }
 
+/**
+ * Verify that a host's pool can be used from within a callback for another
+ * host, and that stats are reported separately for each host.
+ */
+TEST_F(ConnectionPoolTest, DifferentHostsUsedFromCallback) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool");
+
+    const HostAndPort host1("localhost:30000");
+    const HostAndPort host2("localhost:30001");
+
+    bool reachedInner = false;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(host1, Milliseconds(5000), [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+        ASSERT(swConn.isOK());
+
+        ConnectionImpl::pushSetup(Status::OK());
+        pool.get(host2,
+                 Milliseconds(5000),
+                 [&](StatusWith<ConnectionPool::ConnectionHandle> swInnerConn) {
+                     ASSERT(swInnerConn.isOK());
+
+                     ConnectionPoolStats stats;
+                     pool.appendConnectionStats(&stats);
+                     ASSERT_EQ(2u, stats.totalInUse);
+                     ASSERT_EQ(0u, stats.totalAvailable);
+
+                     reachedInner = true;
+                     doneWith(swInnerConn.getValue());
+                 });
+
+        doneWith(swConn.getValue());
+    });
+
+    ASSERT(reachedInner);
+
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+    ASSERT_EQ(0u, stats.totalInUse);
+    ASSERT_EQ(2u, stats.totalAvailable);
+    ASSERT_EQ(1u, stats.statsByHost[host1].available);
+    ASSERT_EQ(1u, stats.statsByHost[host2].available);
+    ASSERT_EQ(1u, pool.getNumConnectionsPerHost(host1));
+    ASSERT_EQ(1u, pool.getNumConnectionsPerHost(host2));
+}
+
 /**
  * Verify that not returning handle's to the pool spins up new connections.
  */
@@ -276,6 +276,62 @@ void CatalogCache::invalidateShardedCollection(const NamespaceString& nss) {
     it->second->collections[nss.ns()].needsRefresh = true;
 }
 
+void CatalogCache::scheduleBackgroundRefresh(const NamespaceString& nss,
+                                             const ChunkVersion& newVersion) {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    auto it = _databases.find(nss.db());
+    if (it == _databases.end()) {
+        return;
+    }
+
+    auto& dbEntry = it->second;
+
+    auto itColl = dbEntry->collections.find(nss.ns());
+    if (itColl == dbEntry->collections.end()) {
+        return;
+    }
+
+    auto& collEntry = itColl->second;
+    if (collEntry.needsRefresh || collEntry.refreshCompletionNotification) {
+        // Either a refresh is already in progress or the next caller will schedule one
+        return;
+    }
+
+    invariant(collEntry.routingInfo);
+
+    const auto cachedVersion = collEntry.routingInfo->getVersion();
+    if (cachedVersion.epoch() == newVersion.epoch() && !cachedVersion.isOlderThan(newVersion)) {
+        return;
+    }
+
+    _stats.countBackgroundRefreshesStarted.addAndFetch(1);
+
+    // The routing info is deliberately not moved out of the entry and needsRefresh stays false, so
+    // that it continues to be served while the refresh is in progress
+    collEntry.refreshCompletionNotification = std::make_shared<Notification<Status>>();
+    _scheduleCollectionRefresh(lg, dbEntry, collEntry.routingInfo, nss, 1);
+}
+
+std::vector<std::pair<NamespaceString, ChunkVersion>> CatalogCache::getCachedCollectionVersions()
+    const {
+    std::vector<std::pair<NamespaceString, ChunkVersion>> collectionVersions;
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    for (const auto& dbEntry : _databases) {
+        for (const auto& collEntry : dbEntry.second->collections) {
+            if (collEntry.second.needsRefresh || !collEntry.second.routingInfo) {
+                continue;
+            }
+
+            collectionVersions.emplace_back(NamespaceString(collEntry.first),
+                                            collEntry.second.routingInfo->getVersion());
+        }
+    }
+
+    return collectionVersions;
+}
+
 void CatalogCache::purgeDatabase(StringData dbName) {
     stdx::lock_guard<stdx::mutex> lg(_mutex);
     _databases.erase(dbName);
@@ -473,6 +529,8 @@ void CatalogCache::Stats::report(BSONObjBuilder* builder) const {
     builder->append("numActiveFullRefreshes", numActiveFullRefreshes.load());
     builder->append("countFullRefreshesStarted", countFullRefreshesStarted.load());
 
+    builder->append("countBackgroundRefreshesStarted", countBackgroundRefreshesStarted.load());
+
     builder->append("countFailedRefreshes", countFailedRefreshes.load());
 }
 
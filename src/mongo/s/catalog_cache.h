@@ -125,6 +125,24 @@ public:
      */
     void invalidateShardedCollection(const NamespaceString& nss);
 
+    /**
+     * Non-blocking method to be called when the routing table for the specified collection is known
+     * to have advanced to 'newVersion' (for example, because newer chunks for it have been found on
+     * the config server). If the cached routing table is older, schedules an incremental refresh in
+     * the background. Unlike invalidateShardedCollection, callers of getCollectionRoutingInfo
+     * continue to be served the existing routing table until the refresh completes.
+     *
+     * Does nothing if the collection has no cached routing table, if a refresh is already in
+     * progress for it or if the cached routing table is already at or past 'newVersion'.
+     */
+    void scheduleBackgroundRefresh(const NamespaceString& nss, const ChunkVersion& newVersion);
+
+    /**
+     * Returns the namespaces and current versions of all the sharded collections for which the
+     * cache holds a routing table, which does not need a refresh.
+     */
+    std::vector<std::pair<NamespaceString, ChunkVersion>> getCachedCollectionVersions() const;
+
     /**
      * Non-blocking method, which removes the entire specified database (including its collections)
      * from the cache.
@@ -155,11 +173,12 @@ private:
         // be relied on) or it doesn't, in which case there should be a non-null routingInfo.
         bool needsRefresh{true};
 
-        // Contains a notification to be waited on for the refresh to complete (only available if
-        // needsRefresh is true)
+        // Contains a notification to be waited on for the refresh to complete (available if
+        // needsRefresh is true or if a background refresh is in progress)
         std::shared_ptr<Notification<Status>> refreshCompletionNotification;
 
-        // Contains the cached routing information (only available if needsRefresh is false)
+        // Contains the cached routing information (only available if needsRefresh is false or if a
+        // background refresh is in progress)
         std::shared_ptr<ChunkManager> routingInfo;
     };
 
@@ -221,6 +240,10 @@ private:
         // Cumulative, always-increasing counter of how many full refreshes have been kicked off
         AtomicInt64 countFullRefreshesStarted{0};
 
+        // Cumulative, always-increasing counter of how many of the incremental refreshes were
+        // started in the background, without blocking the callers of getCollectionRoutingInfo
+        AtomicInt64 countBackgroundRefreshesStarted{0};
+
         // Cumulative, always-increasing counter of how many full or incremental refreshes failed
         // for whatever reason
         AtomicInt64 countFailedRefreshes{0};
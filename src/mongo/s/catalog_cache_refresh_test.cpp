@@ -36,6 +36,7 @@
 #include "mongo/s/catalog/type_database.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/grid.h"
 
 namespace mongo {
 namespace {
@@ -610,5 +611,62 @@ TEST_F(CatalogCacheRefreshTest, IncrementalLoadAfterMoveLastChunk) {
     ASSERT_EQ(version, cm->getVersion({"1"}));
 }
 
+TEST_F(CatalogCacheRefreshTest, BackgroundRefreshServesExistingRoutingTableUntilComplete) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    ASSERT_EQ(2, initialRoutingInfo->numChunks());
+
+    const ChunkVersion initialVersion = initialRoutingInfo->getVersion();
+    ChunkVersion version = initialVersion;
+
+    auto const catalogCache = Grid::get(serviceContext())->catalogCache();
+    catalogCache->scheduleBackgroundRefresh(
+        kNss, ChunkVersion(version.majorVersion() + 1, 1, version.epoch()));
+
+    // The existing routing table must continue to be served without blocking on the refresh
+    auto existingRoutingInfo =
+        assertGet(catalogCache->getCollectionRoutingInfo(operationContext(), kNss));
+    ASSERT_EQ(initialVersion, existingRoutingInfo.cm()->getVersion());
+
+    // A stale config error on the existing routing table must join the in-progress refresh instead
+    // of scheduling a new one
+    auto future = launchAsync([&] {
+        auto client = serviceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        catalogCache->onStaleConfigError(std::move(existingRoutingInfo));
+
+        return boost::make_optional(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+    });
+
+    expectGetCollection(version.epoch(), shardKeyPattern);
+
+    // Return set of chunks, which represent a move
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        version.incMajor();
+        ChunkType chunk1(
+            kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"1"});
+
+        version.incMinor();
+        ChunkType chunk2(
+            kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+        return std::vector<BSONObj>{chunk1.toConfigBSON(), chunk2.toConfigBSON()};
+    }());
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(routingInfo->cm());
+    ASSERT_EQ(version, routingInfo->cm()->getVersion());
+
+    // Versions, which are not newer than the cached one must not cause a refresh
+    catalogCache->scheduleBackgroundRefresh(kNss, version);
+    ASSERT_EQ(version,
+              assertGet(catalogCache->getCollectionRoutingInfo(operationContext(), kNss))
+                  .cm()
+                  ->getVersion());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -30,6 +30,7 @@
 
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/s/chunk_writes_tracker.h"
 #include "mongo/s/shard_id.h"
 
 namespace mongo {
@@ -86,6 +87,14 @@ public:
 
     bool shouldSplit(uint64_t desiredChunkSize, bool minIsInf, bool maxIsInf) const;
 
+    /**
+     * Returns the sampled write load on this chunk, which is used to choose load-balancing split
+     * points.
+     */
+    ChunkWritesTracker& getWritesTracker() const {
+        return _writesTracker;
+    }
+
     /**
      * Marks this chunk as jumbo. Only moves from false to true once and is used by the balancer.
      */
@@ -104,6 +113,9 @@ private:
 
     // Statistics for the approximate data written to this chunk
     mutable uint64_t _dataWritten;
+
+    // Sample of the shard keys written to this chunk
+    mutable ChunkWritesTracker _writesTracker;
 };
 
 }  // namespace mongo
@@ -189,6 +189,114 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     }
 }
 
+std::map<ShardId, BSONObj> ChunkManager::getShardFiltersForInQuery(
+    const BSONObj& query, const BSONObj& collation) const {
+    // Individual $in values can only be mapped to a chunk if they constitute the entire shard key.
+    // Dotted shard key fields are excluded, because the query field name would need to be turned
+    // into a nested document in order to extract the shard key from it.
+    const auto& keyPatternFields = _shardKeyPattern.getKeyPatternFields();
+    if (keyPatternFields.size() != 1 || keyPatternFields[0]->numParts() != 1)
+        return {};
+
+    const StringData shardKeyField = keyPatternFields[0]->dottedField();
+
+    BSONElement inElement;
+    for (const auto& elem : query) {
+        if (elem.fieldNameStringData() != shardKeyField)
+            continue;
+
+        // The shard key must only be referenced once at the top level through an operator object
+        if (!inElement.eoo() || elem.type() != Object)
+            return {};
+
+        for (const auto& predicate : elem.Obj()) {
+            if (predicate.fieldNameStringData() != "$in")
+                continue;
+
+            if (!inElement.eoo() || predicate.type() != Array)
+                return {};
+
+            inElement = predicate;
+        }
+
+        if (inElement.eoo())
+            return {};
+    }
+
+    if (inElement.eoo())
+        return {};
+
+    const bool hasSimpleCollation = (collation.isEmpty() && !_defaultCollator) ||
+        SimpleBSONObjComparator::kInstance.evaluate(collation == CollationSpec::kSimpleSpec);
+
+    std::map<ShardId, std::vector<BSONElement>> valuesByShard;
+
+    for (const auto& value : inElement.Obj()) {
+        // Values which compare differently under the query's collation may match documents, which
+        // live on other shards than the value itself
+        if (!hasSimpleCollation && CollationIndexKey::isCollatableType(value.type()))
+            return {};
+
+        // A regular expression in $in matches documents by pattern, so they may live on any shard
+        if (value.type() == RegEx)
+            return {};
+
+        BSONObjBuilder valueDoc;
+        valueDoc.appendAs(value, shardKeyField);
+
+        const auto shardKey = _shardKeyPattern.extractShardKeyFromDoc(valueDoc.obj());
+        if (shardKey.isEmpty())
+            return {};
+
+        // Apart from hashing, the value must be the shard key exactly, otherwise it is not an
+        // equality match on the shard key
+        if (!_shardKeyPattern.isHashedPattern() &&
+            !shardKey.firstElement().binaryEqualValues(value))
+            return {};
+
+        const auto it = _chunkMap.upper_bound(_extractKeyString(shardKey));
+        if (it == _chunkMap.end() || !it->second->containsKey(shardKey))
+            return {};
+
+        valuesByShard[it->second->getShardId()].push_back(value);
+    }
+
+    if (valuesByShard.size() < 2)
+        return {};
+
+    std::map<ShardId, BSONObj> shardFilters;
+
+    for (const auto& shardAndValues : valuesByShard) {
+        BSONObjBuilder filterBuilder;
+
+        for (const auto& elem : query) {
+            if (elem.fieldNameStringData() != shardKeyField) {
+                filterBuilder.append(elem);
+                continue;
+            }
+
+            BSONObjBuilder predicatesBuilder(filterBuilder.subobjStart(shardKeyField));
+            for (const auto& predicate : elem.Obj()) {
+                if (predicate.fieldNameStringData() != "$in") {
+                    predicatesBuilder.append(predicate);
+                    continue;
+                }
+
+                BSONArrayBuilder inBuilder(predicatesBuilder.subarrayStart("$in"));
+                for (const auto& value : shardAndValues.second) {
+                    inBuilder.append(value);
+                }
+                inBuilder.doneFast();
+            }
+            predicatesBuilder.doneFast();
+        }
+
+        shardFilters.emplace(shardAndValues.first, filterBuilder.obj());
+    }
+
+    return shardFilters;
+}
+
 void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        const BSONObj& max,
                                        std::set<ShardId>* shardIds) const {
@@ -217,6 +217,24 @@ public:
                              const BSONObj& collation,
                              std::set<ShardId>* shardIds) const;
 
+    /**
+     * If the filter has a top-level $in predicate on a single-field shard key, returns for each
+     * shard, which owns some of the $in values, a rewritten filter in which the $in list only
+     * contains the values owned by that shard. All other predicates are preserved as they are.
+     *
+     * Returns an empty map if the filter cannot be split this way (for example because the shard
+     * key is compound, some $in value is not a valid shard key value, or the collation prevents
+     * the values from being targeted) or if all values are owned by a single shard. In that case
+     * the original filter must be sent to all shards returned by getShardIdsForQuery.
+     *
+     * Example: with shard key { a : 1 } and chunks [MinKey, 10) on shard0 and [10, MaxKey) on
+     *          shard1, the filter { a : { $in : [1, 20, 2] }, b : 5 } is split into
+     *          shard0 => { a : { $in : [1, 2] }, b : 5 }
+     *          shard1 => { a : { $in : [20] }, b : 5 }
+     */
+    std::map<ShardId, BSONObj> getShardFiltersForInQuery(const BSONObj& query,
+                                                         const BSONObj& collation) const;
+
     /**
      * Returns all shard ids which contain chunks overlapping the range [min, max]. Please note the
      * inclusive bounds on both sides (SERVER-20768).
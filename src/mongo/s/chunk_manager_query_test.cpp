@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <map>
 #include <set>
 
 #include "mongo/db/query/collation/collator_interface_mock.h"
@@ -76,6 +77,26 @@ protected:
         _assertShardIdsMatch(expectedShardIds, shardIds);
     }
 
+    void runInQuerySplitTest(const BSONObj& shardKey,
+                             std::unique_ptr<CollatorInterface> defaultCollator,
+                             const std::vector<BSONObj>& splitPoints,
+                             const BSONObj& query,
+                             const BSONObj& queryCollation,
+                             const std::map<ShardId, BSONObj>& expectedShardFilters) {
+        const ShardKeyPattern shardKeyPattern(shardKey);
+        auto chunkManager =
+            makeChunkManager(kNss, shardKeyPattern, std::move(defaultCollator), false, splitPoints);
+
+        const auto shardFilters = chunkManager->getShardFiltersForInQuery(query, queryCollation);
+
+        ASSERT_EQ(expectedShardFilters.size(), shardFilters.size());
+        for (const auto& expected : expectedShardFilters) {
+            const auto it = shardFilters.find(expected.first);
+            ASSERT(it != shardFilters.end());
+            ASSERT_BSONOBJ_EQ(expected.second, it->second);
+        }
+    }
+
 private:
     static void _assertShardIdsMatch(const std::set<ShardId>& expectedShardIds,
                                      const std::set<ShardId>& actualShardIds) {
@@ -487,5 +508,100 @@ TEST_F(ChunkManagerQueryTest, SimpleCollationNumbersMultiShard) {
         {ShardId("0")});
 }
 
+TEST_F(ChunkManagerQueryTest, InQuerySplitByShard) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a" << -100), BSON("a" << 0), BSON("a" << 100)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(-150 << 5 << -120 << 150 << 50))
+                                 << "b"
+                                 << 5),
+                        BSONObj(),
+                        {{ShardId("0"),
+                          BSON("a" << BSON("$in" << BSON_ARRAY(-150 << -120)) << "b" << 5)},
+                         {ShardId("2"),
+                          BSON("a" << BSON("$in" << BSON_ARRAY(5 << 50)) << "b" << 5)},
+                         {ShardId("3"), BSON("a" << BSON("$in" << BSON_ARRAY(150)) << "b" << 5)}});
+}
+
+TEST_F(ChunkManagerQueryTest, InQuerySplitPreservesOtherShardKeyPredicates) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a" << 0)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(-1 << 1 << 2) << "$ne" << 2)),
+                        BSONObj(),
+                        {{ShardId("0"), BSON("a" << BSON("$in" << BSON_ARRAY(-1) << "$ne" << 2))},
+                         {ShardId("1"),
+                          BSON("a" << BSON("$in" << BSON_ARRAY(1 << 2) << "$ne" << 2))}});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitIfAllValuesOnSingleShard) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a" << 0)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(1 << 2 << 3))),
+                        BSONObj(),
+                        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitForCompoundShardKey) {
+    runInQuerySplitTest(BSON("a" << 1 << "b" << 1),
+                        nullptr,
+                        {BSON("a" << 0 << "b" << 0)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(-1 << 1)) << "b" << 1),
+                        BSONObj(),
+                        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitIfValueIsNotValidShardKey) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a" << 0)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(-1 << 1 << BSON_ARRAY(2 << 3)))),
+                        BSONObj(),
+                        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitIfValueIsRegEx) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a" << 0)},
+                        BSON("a" << BSON("$in" << BSON_ARRAY(-1 << 1 << BSONRegEx("^abc")))),
+                        BSONObj(),
+                        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitIfRegExIsTheOnlyValueOnAShard) {
+    runInQuerySplitTest(BSON("a" << 1),
+                        nullptr,
+                        {BSON("a"
+                              << "m")},
+                        BSON("a" << BSON("$in" << BSON_ARRAY("a" << BSONRegEx("^z")))),
+                        BSONObj(),
+                        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQueryNotSplitOnStringsWithNonSimpleCollation) {
+    runInQuerySplitTest(
+        BSON("a" << 1),
+        stdx::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kReverseString),
+        {BSON("a"
+              << "y")},
+        BSON("a" << BSON("$in" << BSON_ARRAY("x"
+                                             << "z"))),
+        BSONObj(),
+        {});
+}
+
+TEST_F(ChunkManagerQueryTest, InQuerySplitOnNumbersWithNonSimpleCollation) {
+    runInQuerySplitTest(
+        BSON("a" << 1),
+        stdx::make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kReverseString),
+        {BSON("a" << 0)},
+        BSON("a" << BSON("$in" << BSON_ARRAY(-1 << 1))),
+        BSONObj(),
+        {{ShardId("0"), BSON("a" << BSON("$in" << BSON_ARRAY(-1)))},
+         {ShardId("1"), BSON("a" << BSON("$in" << BSON_ARRAY(1)))}});
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_writes_tracker.h"
+
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+ChunkWritesTracker::ChunkWritesTracker()
+    : _random(static_cast<int64_t>(curTimeMicros64()) ^ reinterpret_cast<intptr_t>(this)) {}
+
+void ChunkWritesTracker::onWrite(const BSONObj& shardKey) {
+    if (_writesCount.fetchAndAdd(1) % kSampleInterval != 0) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+
+    // Reservoir sampling: the n-th offered key replaces a random existing sample with probability
+    // kMaxSamples / n, which keeps the retained keys a uniform sample of all the offered ones
+    const uint64_t n = ++_numOffered;
+    if (_samples.size() < kMaxSamples) {
+        _samples.push_back(shardKey.getOwned());
+        return;
+    }
+
+    const uint64_t slot = static_cast<uint64_t>(_random.nextInt64(static_cast<int64_t>(n)));
+    if (slot < kMaxSamples) {
+        _samples[slot] = shardKey.getOwned();
+    }
+}
+
+uint64_t ChunkWritesTracker::getWritesCount() const {
+    return _writesCount.load();
+}
+
+size_t ChunkWritesTracker::getSamplesCount() const {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    return _samples.size();
+}
+
+std::vector<BSONObj> ChunkWritesTracker::getLoadBalancedSplitPoints(const BSONObj& chunkMin,
+                                                                    size_t numParts) const {
+    std::vector<BSONObj> sortedSamples;
+    {
+        stdx::lock_guard<stdx::mutex> lg(_mutex);
+        sortedSamples = _samples;
+    }
+
+    std::vector<BSONObj> splitPoints;
+    if (sortedSamples.empty() || numParts < 2) {
+        return splitPoints;
+    }
+
+    std::sort(sortedSamples.begin(),
+              sortedSamples.end(),
+              SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    // Each sample stands for the same number of writes, so the quantiles of the sorted sample
+    // divide the write load into equal parts
+    for (size_t i = 1; i < numParts; i++) {
+        const auto& candidate = sortedSamples[i * sortedSamples.size() / numParts];
+        if (SimpleBSONObjComparator::kInstance.evaluate(candidate == chunkMin)) {
+            continue;
+        }
+
+        if (!splitPoints.empty() &&
+            SimpleBSONObjComparator::kInstance.evaluate(candidate == splitPoints.back())) {
+            continue;
+        }
+
+        splitPoints.push_back(candidate);
+    }
+
+    return splitPoints;
+}
+
+void ChunkWritesTracker::clear() {
+    stdx::lock_guard<stdx::mutex> lg(_mutex);
+    _writesCount.store(0);
+    _numOffered = 0;
+    _samples.clear();
+}
+
+std::vector<BSONObj> ChunkWritesTracker::balanceSplitPoints(
+    const std::vector<BSONObj>& sizeSplitPoints, const std::vector<BSONObj>& loadSplitPoints) {
+    if (loadSplitPoints.empty()) {
+        return sizeSplitPoints;
+    }
+
+    const auto lessThan = SimpleBSONObjComparator::kInstance.makeLessThan();
+
+    std::vector<BSONObj> splitPoints;
+
+    auto sizeIt = sizeSplitPoints.begin();
+    for (size_t i = 0; i <= loadSplitPoints.size(); i++) {
+        // Find the size-based split points, which fall in the current load-based segment
+        const auto segmentBegin = sizeIt;
+        while (sizeIt != sizeSplitPoints.end() &&
+               (i == loadSplitPoints.size() || lessThan(*sizeIt, loadSplitPoints[i]))) {
+            ++sizeIt;
+        }
+
+        if (std::distance(segmentBegin, sizeIt) > 1) {
+            splitPoints.insert(splitPoints.end(), segmentBegin, sizeIt);
+        }
+
+        if (i < loadSplitPoints.size()) {
+            if (splitPoints.empty() || lessThan(splitPoints.back(), loadSplitPoints[i])) {
+                splitPoints.push_back(loadSplitPoints[i]);
+            }
+
+            // Skip a size-based split point, which coincides with the load-based one
+            if (sizeIt != sizeSplitPoints.end() && !lessThan(loadSplitPoints[i], *sizeIt)) {
+                ++sizeIt;
+            }
+        }
+    }
+
+    return splitPoints;
+}
+
+}  // namespace mongo
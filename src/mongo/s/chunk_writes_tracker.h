@@ -0,0 +1,123 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/random.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Keeps a small, uniformly sampled set of the shard keys written to a single chunk, so that split
+ * points can be chosen to divide the write load on the chunk evenly instead of dividing its data
+ * size evenly. With skewed or monotonically increasing shard keys the two can be very different.
+ *
+ * Only every kSampleInterval'th write is offered to the sample, so the cost for the rest of the
+ * writes is a single atomic increment. The sample itself is a reservoir of at most kMaxSamples
+ * keys, which makes it uniform over all the sampled writes since the last call to clear().
+ *
+ * This class is thread-safe.
+ */
+class ChunkWritesTracker {
+    MONGO_DISALLOW_COPYING(ChunkWritesTracker);
+
+public:
+    // Only one out of this many writes is offered to the sample
+    static const uint64_t kSampleInterval = 8;
+
+    // Upper bound on the number of shard keys retained per chunk
+    static const size_t kMaxSamples = 128;
+
+    ChunkWritesTracker();
+
+    /**
+     * Records a write to the specified (already extracted) shard key.
+     */
+    void onWrite(const BSONObj& shardKey);
+
+    /**
+     * Returns the number of writes recorded since the tracker was created or last cleared.
+     */
+    uint64_t getWritesCount() const;
+
+    /**
+     * Returns the number of shard keys currently retained in the sample.
+     */
+    size_t getSamplesCount() const;
+
+    /**
+     * Returns up to 'numParts' - 1 distinct, ascending split points, which divide the sampled
+     * writes into 'numParts' parts of approximately equal write load. Keys equal to 'chunkMin'
+     * are never returned, since they are not valid split points. Returns an empty vector if there
+     * are no samples.
+     */
+    std::vector<BSONObj> getLoadBalancedSplitPoints(const BSONObj& chunkMin,
+                                                    size_t numParts) const;
+
+    /**
+     * Discards all the recorded writes and samples.
+     */
+    void clear();
+
+    /**
+     * Combines the split points chosen by data size ('sizeSplitPoints', as returned by splitVector)
+     * with the ones chosen by sampled write load ('loadSplitPoints'). All the load-based split
+     * points are used, so that the writes are spread evenly across the resulting chunks. The
+     * size-based split points are kept only where more than one of them falls between two
+     * consecutive load-based ones, since only then would the chunk between them exceed the maximum
+     * chunk size.
+     *
+     * Both inputs must be sorted in ascending order and the result is strictly ascending as well.
+     */
+    static std::vector<BSONObj> balanceSplitPoints(const std::vector<BSONObj>& sizeSplitPoints,
+                                                   const std::vector<BSONObj>& loadSplitPoints);
+
+private:
+    // Count of all the writes to the chunk, incremented outside of the mutex
+    AtomicUInt64 _writesCount{0};
+
+    // Protects the state below
+    mutable stdx::mutex _mutex;
+
+    // Used to choose which sample to replace once the reservoir is full
+    PseudoRandom _random;
+
+    // How many writes have been offered to the reservoir
+    uint64_t _numOffered{0};
+
+    // The reservoir of owned shard keys
+    std::vector<BSONObj> _samples;
+};
+
+}  // namespace mongo
@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_writes_tracker.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(ChunkWritesTracker, SamplesOnlyEveryIntervalWrite) {
+    ChunkWritesTracker tracker;
+    for (uint64_t i = 0; i < ChunkWritesTracker::kSampleInterval * 10; i++) {
+        tracker.onWrite(BSON("x" << static_cast<long long>(i)));
+    }
+
+    ASSERT_EQ(ChunkWritesTracker::kSampleInterval * 10, tracker.getWritesCount());
+    ASSERT_EQ(10U, tracker.getSamplesCount());
+}
+
+TEST(ChunkWritesTracker, SampleSizeIsBounded) {
+    ChunkWritesTracker tracker;
+    const uint64_t numWrites =
+        ChunkWritesTracker::kSampleInterval * ChunkWritesTracker::kMaxSamples * 4;
+    for (uint64_t i = 0; i < numWrites; i++) {
+        tracker.onWrite(BSON("x" << static_cast<long long>(i)));
+    }
+
+    ASSERT_EQ(ChunkWritesTracker::kMaxSamples, tracker.getSamplesCount());
+}
+
+TEST(ChunkWritesTracker, NoSplitPointsWithoutSamples) {
+    ChunkWritesTracker tracker;
+    ASSERT(tracker.getLoadBalancedSplitPoints(BSON("x" << MINKEY), 4).empty());
+}
+
+TEST(ChunkWritesTracker, UniformLoadSplitsEvenly) {
+    ChunkWritesTracker tracker;
+    for (int i = 0; i < 100; i++) {
+        for (uint64_t j = 0; j < ChunkWritesTracker::kSampleInterval; j++) {
+            tracker.onWrite(BSON("x" << i));
+        }
+    }
+
+    const auto splitPoints = tracker.getLoadBalancedSplitPoints(BSON("x" << MINKEY), 4);
+    ASSERT_EQ(3U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 25), splitPoints[0]);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 50), splitPoints[1]);
+    ASSERT_BSONOBJ_EQ(BSON("x" << 75), splitPoints[2]);
+}
+
+TEST(ChunkWritesTracker, SkewedLoadIsolatesHotKey) {
+    ChunkWritesTracker tracker;
+
+    // Three quarters of the writes go to x: 10 and the rest are spread over [0, 20)
+    for (int i = 0; i < 20; i++) {
+        for (uint64_t j = 0; j < ChunkWritesTracker::kSampleInterval; j++) {
+            tracker.onWrite(BSON("x" << i));
+        }
+    }
+    for (int i = 0; i < 60; i++) {
+        for (uint64_t j = 0; j < ChunkWritesTracker::kSampleInterval; j++) {
+            tracker.onWrite(BSON("x" << 10));
+        }
+    }
+
+    // Equal split points collapse into one, so the hot key starts a chunk of its own
+    const auto splitPoints = tracker.getLoadBalancedSplitPoints(BSON("x" << 0), 4);
+    ASSERT_EQ(1U, splitPoints.size());
+    ASSERT_BSONOBJ_EQ(BSON("x" << 10), splitPoints[0]);
+}
+
+TEST(ChunkWritesTracker, NeverReturnsChunkMin) {
+    ChunkWritesTracker tracker;
+    for (uint64_t j = 0; j < ChunkWritesTracker::kSampleInterval * 10; j++) {
+        tracker.onWrite(BSON("x" << 0));
+    }
+
+    ASSERT(tracker.getLoadBalancedSplitPoints(BSON("x" << 0), 2).empty());
+}
+
+TEST(ChunkWritesTracker, ClearDiscardsSamples) {
+    ChunkWritesTracker tracker;
+    for (uint64_t j = 0; j < ChunkWritesTracker::kSampleInterval * 10; j++) {
+        tracker.onWrite(BSON("x" << 0));
+    }
+
+    tracker.clear();
+    ASSERT_EQ(0U, tracker.getWritesCount());
+    ASSERT_EQ(0U, tracker.getSamplesCount());
+}
+
+std::vector<BSONObj> makeKeys(std::initializer_list<int> values) {
+    std::vector<BSONObj> keys;
+    for (int value : values) {
+        keys.push_back(BSON("x" << value));
+    }
+    return keys;
+}
+
+void assertKeysEqual(const std::vector<BSONObj>& expected, const std::vector<BSONObj>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_BSONOBJ_EQ(expected[i], actual[i]);
+    }
+}
+
+TEST(ChunkWritesTracker, BalanceWithoutLoadSplitPointsKeepsSizeSplitPoints) {
+    assertKeysEqual(makeKeys({10, 20, 30}),
+                    ChunkWritesTracker::balanceSplitPoints(makeKeys({10, 20, 30}), {}));
+}
+
+TEST(ChunkWritesTracker, BalanceDropsSingleSizeSplitPointBetweenLoadSplitPoints) {
+    assertKeysEqual(makeKeys({20}),
+                    ChunkWritesTracker::balanceSplitPoints(makeKeys({10, 30}), makeKeys({20})));
+}
+
+TEST(ChunkWritesTracker, BalanceKeepsSizeSplitPointsWhereSegmentIsTooLarge) {
+    assertKeysEqual(
+        makeKeys({10, 20, 25, 30, 40}),
+        ChunkWritesTracker::balanceSplitPoints(makeKeys({10, 20, 30, 40}), makeKeys({25})));
+}
+
+TEST(ChunkWritesTracker, BalanceDoesNotDuplicateCoincidingSplitPoints) {
+    assertKeysEqual(
+        makeKeys({5, 10, 20}),
+        ChunkWritesTracker::balanceSplitPoints(makeKeys({5, 10, 20, 30}), makeKeys({20})));
+}
+
+TEST(ChunkWritesTracker, BalanceSplitPointsAreStrictlyAscending) {
+    const auto splitPoints = ChunkWritesTracker::balanceSplitPoints(
+        makeKeys({1, 2, 3, 12, 13, 14, 22, 23}), makeKeys({10, 11, 20}));
+
+    assertKeysEqual(makeKeys({1, 2, 3, 10, 11, 12, 13, 14, 20, 22, 23}), splitPoints);
+}
+
+}  // namespace
+}  // namespace mongo
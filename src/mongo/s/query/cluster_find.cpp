@@ -32,6 +32,7 @@
 
 #include "mongo/s/query/cluster_find.h"
 
+#include <map>
 #include <set>
 #include <vector>
 
@@ -174,6 +175,11 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
     // Get the set of shards on which we will run the query.
 
     std::vector<std::shared_ptr<Shard>> shards;
+
+    // If the filter contains an $in on the shard key, each shard only needs to receive the $in
+    // values which it owns
+    std::map<ShardId, BSONObj> shardFilters;
+
     if (primary) {
         shards.emplace_back(std::move(primary));
     } else {
@@ -185,6 +191,11 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
                                           query.getQueryRequest().getCollation(),
                                           &shardIds);
 
+        if (shardIds.size() > 1) {
+            shardFilters = chunkManager->getShardFiltersForInQuery(
+                query.getQueryRequest().getFilter(), query.getQueryRequest().getCollation());
+        }
+
         for (auto id : shardIds) {
             shards.emplace_back(uassertStatusOK(shardRegistry->getShard(opCtx, id)));
         }
@@ -237,7 +248,15 @@ CursorId runQueryWithoutRetrying(OperationContext* opCtx,
         invariant(!shard->isConfig() || shard->getConnString().type() != ConnectionString::INVALID);
 
         BSONObjBuilder cmdBuilder;
-        qrToForward->asFindCommand(&cmdBuilder);
+
+        const auto shardFilterIt = shardFilters.find(shard->getId());
+        if (shardFilterIt != shardFilters.end()) {
+            QueryRequest shardQR(*qrToForward);
+            shardQR.setFilter(shardFilterIt->second);
+            shardQR.asFindCommand(&cmdBuilder);
+        } else {
+            qrToForward->asFindCommand(&cmdBuilder);
+        }
 
         if (chunkManager) {
             ChunkVersion version(chunkManager->getVersion(shard->getId()));
@@ -0,0 +1,186 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_change_listener.h"
+
+#include <map>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/sharding_catalog_client.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+// How often to check the config server for chunk changes to the cached collections. A value of zero
+// or less disables the check, in which case routing tables are refreshed only after stale config
+// errors. Each check is a majority read against config.chunks from every mongos, so it is off by
+// default.
+MONGO_EXPORT_SERVER_PARAMETER(routingTableChangePollIntervalMS, int, 0);
+
+// How long to wait before checking again whether polling has been re-enabled
+const Seconds kDisabledPollInterval(1);
+
+// Bounds the size of the $or query sent to the config server
+const size_t kMaxCollectionsPerQuery = 500;
+
+/**
+ * Returns the query which finds all chunks of the specified collections, which have a version
+ * newer than the one cached for them. Each of the clauses is satisfied by the {ns: 1, lastmod: 1}
+ * index on config.chunks.
+ */
+template <typename It>
+BSONObj createChangedChunksQuery(It begin, It end) {
+    BSONArrayBuilder orBuilder;
+    for (auto it = begin; it != end; ++it) {
+        orBuilder.append(BSON(ChunkType::ns() << it->first.ns() << ChunkType::lastmod() << GT
+                                              << Timestamp(it->second.toLong())));
+    }
+
+    return BSON("$or" << orBuilder.arr());
+}
+
+}  // namespace
+
+RoutingTableChangeListener::RoutingTableChangeListener() = default;
+
+RoutingTableChangeListener::~RoutingTableChangeListener() {
+    // The thread must not be running when this object is destroyed
+    invariant(!_thread.joinable());
+}
+
+void RoutingTableChangeListener::checkForRoutingTableChanges(OperationContext* opCtx) {
+    auto const catalogCache = Grid::get(opCtx)->catalogCache();
+    auto const catalogClient = Grid::get(opCtx)->catalogClient();
+
+    const auto cachedVersions = catalogCache->getCachedCollectionVersions();
+    if (cachedVersions.empty()) {
+        return;
+    }
+
+    // A collection which was dropped and recreated has a new epoch, and the versions of its chunks
+    // start again below the cached version, so the query below would not find them. Compare the
+    // epochs with those in config.collections, which has one small entry per sharded collection.
+    const auto collections = uassertStatusOK(catalogClient->getCollections(
+        opCtx, nullptr, nullptr, repl::ReadConcernLevel::kMajorityReadConcern));
+
+    std::map<std::string, OID> epochs;
+    for (const auto& coll : collections) {
+        if (!coll.getDropped()) {
+            epochs.emplace(coll.getNs().ns(), coll.getEpoch());
+        }
+    }
+
+    for (const auto& cachedVersion : cachedVersions) {
+        auto it = epochs.find(cachedVersion.first.ns());
+        const OID epoch = it == epochs.end() ? OID() : it->second;
+        if (epoch != cachedVersion.second.epoch()) {
+            LOG(1) << "Found new epoch " << epoch << " for collection " << cachedVersion.first;
+            // An unset epoch, as when the collection is no longer sharded, makes this UNSHARDED
+            catalogCache->scheduleBackgroundRefresh(cachedVersion.first, ChunkVersion(0, 0, epoch));
+        }
+    }
+
+    for (auto batchBegin = cachedVersions.begin(); batchBegin != cachedVersions.end();) {
+        const auto batchEnd = batchBegin +
+            std::min<size_t>(kMaxCollectionsPerQuery,
+                             std::distance(batchBegin, cachedVersions.end()));
+
+        const auto changedChunks = uassertStatusOK(
+            catalogClient->getChunks(opCtx,
+                                     createChangedChunksQuery(batchBegin, batchEnd),
+                                     BSONObj(),
+                                     boost::none,
+                                     nullptr,
+                                     repl::ReadConcernLevel::kMajorityReadConcern));
+
+        // Only the newest version of each collection is needed in order to decide whether to
+        // refresh it
+        std::map<std::string, ChunkVersion> newestVersions;
+        for (const auto& chunk : changedChunks) {
+            auto it = newestVersions.find(chunk.getNS().ns());
+            if (it == newestVersions.end()) {
+                newestVersions.emplace(chunk.getNS().ns(), chunk.getVersion());
+            } else if (it->second.isOlderThan(chunk.getVersion())) {
+                it->second = chunk.getVersion();
+            }
+        }
+
+        for (const auto& newestVersion : newestVersions) {
+            LOG(1) << "Found newer routing table version " << newestVersion.second
+                   << " for collection " << newestVersion.first;
+            catalogCache->scheduleBackgroundRefresh(NamespaceString(newestVersion.first),
+                                                    newestVersion.second);
+        }
+
+        batchBegin = batchEnd;
+    }
+}
+
+void RoutingTableChangeListener::startPeriodicThread() {
+    invariant(!_thread.joinable());
+
+    _thread = stdx::thread([] {
+        Client::initThread("RoutingTableChangeListener");
+
+        while (!globalInShutdownDeprecated()) {
+            const int pollIntervalMS = routingTableChangePollIntervalMS.load();
+            if (pollIntervalMS > 0) {
+                auto opCtx = cc().makeOperationContext();
+
+                try {
+                    checkForRoutingTableChanges(opCtx.get());
+                } catch (const DBException& ex) {
+                    warning() << "Failed to check for routing table changes"
+                              << causedBy(redact(ex.toStatus()));
+                }
+            }
+
+            MONGO_IDLE_THREAD_BLOCK;
+            if (pollIntervalMS > 0) {
+                sleepFor(Milliseconds(pollIntervalMS));
+            } else {
+                sleepFor(kDisabledPollInterval);
+            }
+        }
+    });
+}
+
+}  // namespace mongo
@@ -0,0 +1,76 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Utility class, which is used on mongos to periodically check the config server for chunks, which
+ * were committed at versions newer than the ones in the routing table cache, and to refresh the
+ * affected collections in the background. This way, the routing tables are brought up to date
+ * proactively after migrations, splits and merges instead of only after the first request to hit a
+ * stale config error.
+ *
+ * The check reads config.collections to find collections whose epoch changed, and does a single
+ * indexed query against config.chunks per batch of cached collections to find newer chunks. Its
+ * frequency is controlled by the 'routingTableChangePollIntervalMS' server parameter, which is
+ * zero (disabled) by default.
+ *
+ * NOTE: Not thread-safe, so it should not be used from more than one thread at a time.
+ */
+class RoutingTableChangeListener {
+    MONGO_DISALLOW_COPYING(RoutingTableChangeListener);
+
+public:
+    RoutingTableChangeListener();
+    ~RoutingTableChangeListener();
+
+    /**
+     * Performs a single round of checking for routing table changes and schedules background
+     * refreshes for the collections, which have changed. Throws on error.
+     */
+    static void checkForRoutingTableChanges(OperationContext* opCtx);
+
+    /**
+     * Optional call, which would start a thread to periodically invoke
+     * checkForRoutingTableChanges.
+     */
+    void startPeriodicThread();
+
+private:
+    // The background polling thread (if started)
+    stdx::thread _thread;
+};
+
+}  // namespace mongo
@@ -0,0 +1,252 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_change_listener.h"
+
+#include "mongo/db/query/query_request.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/catalog_cache.h"
+#include "mongo/s/catalog_cache_test_fixture.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/grid.h"
+
+namespace mongo {
+namespace {
+
+using executor::RemoteCommandRequest;
+using unittest::assertGet;
+
+const NamespaceString kNss("TestDB", "TestColl");
+
+/**
+ * Returns the config.collections entry of 'kNss', sharded on _id with the epoch 'epoch'.
+ */
+BSONObj makeCollection(const OID& epoch) {
+    CollectionType collType;
+    collType.setNs(kNss);
+    collType.setEpoch(epoch);
+    collType.setKeyPattern(BSON("_id" << 1));
+    collType.setUnique(false);
+    collType.setUpdatedAt(Date_t::fromMillisSinceEpoch(1));
+    return collType.toBSON();
+}
+
+class RoutingTableChangeListenerTest : public CatalogCacheTestFixture {
+protected:
+    void setUp() override {
+        CatalogCacheTestFixture::setUp();
+
+        setupNShards(2);
+    }
+
+    long long countBackgroundRefreshesStarted() {
+        BSONObjBuilder builder;
+        Grid::get(serviceContext())->catalogCache()->report(&builder);
+        return builder.obj()["countBackgroundRefreshesStarted"].numberLong();
+    }
+
+    /**
+     * Runs a single round of checking for routing table changes, during which the config server
+     * returns 'collections' from config.collections and 'changedChunks' for the query built from
+     * 'cachedVersion'.
+     */
+    void checkForChanges(const ChunkVersion& cachedVersion,
+                         const std::vector<BSONObj>& collections,
+                         const std::vector<BSONObj>& changedChunks) {
+        auto future = launchAsync([&] {
+            auto client = serviceContext()->makeClient("Test");
+            auto opCtx = client->makeOperationContext();
+            RoutingTableChangeListener::checkForRoutingTableChanges(opCtx.get());
+        });
+
+        onFindCommand([&](const RemoteCommandRequest& request) {
+            const auto query = assertGet(
+                QueryRequest::makeFromFindCommand(CollectionType::ConfigNS, request.cmdObj, false));
+            ASSERT_EQ(CollectionType::ConfigNS, query->nss());
+            return collections;
+        });
+
+        onFindCommand([&](const RemoteCommandRequest& request) {
+            // Only the chunks newer than the cached version are asked for
+            const auto query = assertGet(
+                QueryRequest::makeFromFindCommand(ChunkType::ConfigNS, request.cmdObj, false));
+            ASSERT_BSONOBJ_EQ(
+                BSON("$or" << BSON_ARRAY(BSON("ns" << kNss.ns() << "lastmod"
+                                                   << BSON("$gt" << Timestamp(
+                                                               cachedVersion.toLong()))))),
+                query->getFilter());
+
+            return changedChunks;
+        });
+
+        future.timed_get(kFutureTimeout);
+    }
+};
+
+TEST_F(RoutingTableChangeListenerTest, NoChangesDoNotRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    const auto version = initialRoutingInfo->getVersion();
+
+    checkForChanges(version, {makeCollection(version.epoch())}, {});
+
+    ASSERT_EQ(0, countBackgroundRefreshesStarted());
+    ASSERT_EQ(version,
+              assertGet(Grid::get(serviceContext())
+                            ->catalogCache()
+                            ->getCollectionRoutingInfo(operationContext(), kNss))
+                  .cm()
+                  ->getVersion());
+}
+
+TEST_F(RoutingTableChangeListenerTest, NewerChunkSchedulesBackgroundRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    const auto initialVersion = initialRoutingInfo->getVersion();
+    ChunkVersion version = initialVersion;
+
+    version.incMajor();
+    ChunkType movedChunk(
+        kNss, {shardKeyPattern.getKeyPattern().globalMin(), BSON("_id" << 0)}, version, {"1"});
+    version.incMinor();
+    ChunkType otherChunk(
+        kNss, {BSON("_id" << 0), shardKeyPattern.getKeyPattern().globalMax()}, version, {"0"});
+
+    checkForChanges(initialVersion,
+                    {makeCollection(version.epoch())},
+                    {movedChunk.toConfigBSON(), otherChunk.toConfigBSON()});
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+
+    // The existing routing table keeps being served while the refresh is in progress, and a stale
+    // config error joins the refresh instead of starting another one
+    auto const catalogCache = Grid::get(serviceContext())->catalogCache();
+    auto existingRoutingInfo =
+        assertGet(catalogCache->getCollectionRoutingInfo(operationContext(), kNss));
+    ASSERT_EQ(initialVersion, existingRoutingInfo.cm()->getVersion());
+
+    auto future = launchAsync([&] {
+        auto client = serviceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        catalogCache->onStaleConfigError(std::move(existingRoutingInfo));
+
+        return boost::make_optional(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+    });
+
+    expectFindSendBSONObjVector(kConfigHostAndPort, [&]() {
+        CollectionType collType;
+        collType.setNs(kNss);
+        collType.setEpoch(version.epoch());
+        collType.setKeyPattern(shardKeyPattern.toBSON());
+        collType.setUnique(false);
+
+        return std::vector<BSONObj>{collType.toBSON()};
+    }());
+    expectFindSendBSONObjVector(kConfigHostAndPort,
+                                {movedChunk.toConfigBSON(), otherChunk.toConfigBSON()});
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT_EQ(version, routingInfo->cm()->getVersion());
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+
+    // Once the cache has caught up, the same chunks no longer cause a refresh
+    checkForChanges(version, {makeCollection(version.epoch())}, {});
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+}
+
+TEST_F(RoutingTableChangeListenerTest, NewEpochSchedulesBackgroundRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+    const auto initialVersion = initialRoutingInfo->getVersion();
+
+    // The collection was dropped and recreated, so the version of its only chunk is below the
+    // cached version and the chunks query does not find it
+    const ChunkVersion newVersion(1, 0, OID::gen());
+    ChunkType newChunk(kNss,
+                       {shardKeyPattern.getKeyPattern().globalMin(),
+                        shardKeyPattern.getKeyPattern().globalMax()},
+                       newVersion,
+                       {"0"});
+
+    checkForChanges(initialVersion, {makeCollection(newVersion.epoch())}, {});
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+
+    auto const catalogCache = Grid::get(serviceContext())->catalogCache();
+    auto future = launchAsync([&] {
+        auto client = serviceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        catalogCache->onStaleConfigError(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+
+        return boost::make_optional(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+    });
+
+    expectFindSendBSONObjVector(kConfigHostAndPort, {makeCollection(newVersion.epoch())});
+    expectFindSendBSONObjVector(kConfigHostAndPort, {newChunk.toConfigBSON()});
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT_EQ(newVersion, routingInfo->cm()->getVersion());
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+}
+
+TEST_F(RoutingTableChangeListenerTest, DroppedCollectionSchedulesBackgroundRefresh) {
+    const ShardKeyPattern shardKeyPattern(BSON("_id" << 1));
+    auto initialRoutingInfo(
+        makeChunkManager(kNss, shardKeyPattern, nullptr, true, {BSON("_id" << 0)}));
+
+    checkForChanges(initialRoutingInfo->getVersion(), {}, {});
+    ASSERT_EQ(1, countBackgroundRefreshesStarted());
+
+    auto const catalogCache = Grid::get(serviceContext())->catalogCache();
+    auto future = launchAsync([&] {
+        auto client = serviceContext()->makeClient("Test");
+        auto opCtx = client->makeOperationContext();
+        catalogCache->onStaleConfigError(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+
+        return boost::make_optional(
+            uassertStatusOK(catalogCache->getCollectionRoutingInfo(opCtx.get(), kNss)));
+    });
+
+    expectFindSendBSONObjVector(kConfigHostAndPort, {});
+
+    auto routingInfo = future.timed_get(kFutureTimeout);
+    ASSERT(!routingInfo->cm());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -81,6 +81,7 @@
 #include "mongo/s/mongos_options.h"
 #include "mongo/s/query/cluster_cursor_cleanup_job.h"
 #include "mongo/s/query/cluster_cursor_manager.h"
+#include "mongo/s/routing_table_change_listener.h"
 #include "mongo/s/service_entry_point_mongos.h"
 #include "mongo/s/sharding_egress_metadata_hook_for_mongos.h"
 #include "mongo/s/sharding_egress_metadata_hook_for_mongos.h"
@@ -134,6 +135,7 @@ const ntservice::NtServiceDefaultStrings defaultServiceStrings = {
 constexpr auto kSignKeysRetryInterval = Seconds{1};
 
 boost::optional<ShardingUptimeReporter> shardingUptimeReporter;
+boost::optional<RoutingTableChangeListener> routingTableChangeListener;
 
 Status waitForSigningKeys(OperationContext* opCtx) {
     auto const shardRegistry = Grid::get(opCtx)->shardRegistry();
@@ -413,6 +415,9 @@ ExitCode runMongosServer(ServiceContext* serviceContext) {
     shardingUptimeReporter.emplace();
     shardingUptimeReporter->startPeriodicThread();
 
+    routingTableChangeListener.emplace();
+    routingTableChangeListener->startPeriodicThread();
+
     clusterCursorCleanupJob.go();
 
     UserCacheInvalidator cacheInvalidatorThread(AuthorizationManager::get(serviceContext));
@@ -0,0 +1,527 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/io_uring_reactor.h"
+
+#include "mongo/config.h"
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+
+thread_local IOUringReactor* IOUringReactor::_localReactor = nullptr;
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+namespace {
+
+// The user_data of the eventfd read which wakes up the reactor, and of the cancellations issued
+// when it is destroyed. Operations use their address.
+constexpr uint64_t kWakeupUserData = 0;
+constexpr uint64_t kCancelUserData = 1;
+
+#ifdef IORING_CQE_F_MORE
+constexpr uint32_t kCqeFlagMore = IORING_CQE_F_MORE;
+#else
+constexpr uint32_t kCqeFlagMore = 0;
+#endif
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+IOUringReactor::IOUringReactor() = default;
+
+IOUringReactor::~IOUringReactor() {
+    // The kernel tears a closed ring down asynchronously, so operations still in it could write
+    // into buffers released along with their handlers. Wait for all of them to complete first.
+    if (_cqes) {
+        _cancelAndDrain();
+    }
+    if (_ringFd >= 0) {
+        ::close(_ringFd);
+    }
+    if (_sqes) {
+        ::munmap(_sqes, _sqesSize);
+    }
+    if (_cqRing && _cqRing != _sqRing) {
+        ::munmap(_cqRing, _cqRingSize);
+    }
+    if (_sqRing) {
+        ::munmap(_sqRing, _sqRingSize);
+    }
+    if (_wakeupFd >= 0) {
+        ::close(_wakeupFd);
+    }
+}
+
+Status IOUringReactor::init(unsigned entries) {
+    invariant(_ringFd < 0);
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    _ringFd = ioUringSetup(entries, &params);
+    if (_ringFd < 0) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "Failed to create io_uring instance: "
+                              << errnoWithDescription(errno)};
+    }
+
+    if (!(params.features & IORING_FEAT_FAST_POLL) || !(params.features & IORING_FEAT_NODROP)) {
+        return {ErrorCodes::InternalError,
+                "The io_uring implementation of this kernel is too old, Linux 5.7 or later is "
+                "required"};
+    }
+
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+    }
+
+    auto mapRing = [&](size_t size, off_t offset, void** out) -> Status {
+        auto ptr = ::mmap(
+            nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, offset);
+        if (ptr == MAP_FAILED) {
+            return {ErrorCodes::InternalError,
+                    str::stream() << "Failed to map io_uring: " << errnoWithDescription(errno)};
+        }
+        *out = ptr;
+        return Status::OK();
+    };
+
+    auto status = mapRing(_sqRingSize, IORING_OFF_SQ_RING, &_sqRing);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (singleMmap) {
+        _cqRing = _sqRing;
+    } else {
+        status = mapRing(_cqRingSize, IORING_OFF_CQ_RING, &_cqRing);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    void* sqes = nullptr;
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    status = mapRing(_sqesSize, IORING_OFF_SQES, &sqes);
+    if (!status.isOK()) {
+        return status;
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto sqRing = static_cast<char*>(_sqRing);
+    _sqHead = reinterpret_cast<unsigned*>(sqRing + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+    _sqMask = *reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+    _sqEntries = params.sq_entries;
+
+    // Submission queue entries are always used in ring order, so the indirection array can be set
+    // up once as the identity mapping.
+    auto sqArray = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+    for (unsigned i = 0; i < _sqEntries; ++i) {
+        sqArray[i] = i;
+    }
+    _sqeTail = _sqeSubmitted = *_sqTail;
+
+    auto cqRing = static_cast<char*>(_cqRing);
+    _cqHead = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+
+    _wakeupFd = ::eventfd(0, EFD_CLOEXEC);
+    if (_wakeupFd < 0) {
+        return {ErrorCodes::InternalError,
+                str::stream() << "Failed to create eventfd: " << errnoWithDescription(errno)};
+    }
+
+    return Status::OK();
+}
+
+void IOUringReactor::run() {
+    invariant(_ringFd >= 0);
+    invariant(!_localReactor);
+    _localReactor = this;
+    const auto guard = MakeGuard([] { _localReactor = nullptr; });
+
+    while (!_stopped.load()) {
+        const bool ranTasks = _runTasks();
+        if (_stopped.load()) {
+            break;
+        }
+
+        if (!_wakeupArmed) {
+            _armWakeup();
+        }
+
+        // The tasks which just ran may have posted more tasks, in which case only submit the new
+        // operations without waiting for them.
+        bool wait = true;
+        if (ranTasks) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            wait = _tasks.empty();
+        }
+
+        _submit(wait);
+        _reapCompletions();
+    }
+}
+
+void IOUringReactor::stop() {
+    _stopped.store(true);
+    if (_wakeupFd >= 0 && !isRunningInThisThread()) {
+        const uint64_t one = 1;
+        // The eventfd counter cannot overflow from these writes, so this only fails if the reactor
+        // has already been destroyed, which would be a bug in the caller.
+        invariant(::write(_wakeupFd, &one, sizeof(one)) == sizeof(one));
+    }
+}
+
+bool IOUringReactor::isRunningInThisThread() const {
+    return _localReactor == this;
+}
+
+void IOUringReactor::post(Task task) {
+    bool wasEmpty;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        wasEmpty = _tasks.empty();
+        _tasks.emplace_back(std::move(task));
+    }
+
+    // The reactor thread checks for tasks before it waits, so it only needs to be woken up by
+    // other threads, and only once for a batch of tasks.
+    if (wasEmpty && !isRunningInThisThread()) {
+        const uint64_t one = 1;
+        invariant(::write(_wakeupFd, &one, sizeof(one)) == sizeof(one));
+    }
+}
+
+void IOUringReactor::dispatch(Task task) {
+    if (isRunningInThisThread()) {
+        task();
+    } else {
+        post(std::move(task));
+    }
+}
+
+void IOUringReactor::accept(int fd, bool multishot, CompletionHandler handler) {
+    uint16_t ioprio = 0;
+#ifdef IORING_ACCEPT_MULTISHOT
+    if (multishot && _multishotAcceptSupported) {
+        ioprio = IORING_ACCEPT_MULTISHOT;
+        // Kernels without multishot accept reject the flag, in which case the accept is restarted
+        // without it and never requested again.
+        handler = [ this, fd, handler = std::move(handler), first = true ](int result,
+                                                                          bool more) mutable {
+            if (first && result == -EINVAL && _multishotAcceptSupported) {
+                _multishotAcceptSupported = false;
+                accept(fd, false, std::move(handler));
+                return;
+            }
+            first = false;
+            handler(result, more);
+        };
+    }
+#endif
+    _startOperation(IORING_OP_ACCEPT, fd, nullptr, 0, ioprio, SOCK_CLOEXEC, std::move(handler));
+}
+
+void IOUringReactor::recv(int fd, void* buf, size_t len, CompletionHandler handler) {
+    _startOperation(IORING_OP_RECV, fd, buf, len, 0, 0, std::move(handler));
+}
+
+void IOUringReactor::send(int fd, const void* buf, size_t len, CompletionHandler handler) {
+    _startOperation(IORING_OP_SEND, fd, buf, len, 0, MSG_NOSIGNAL, std::move(handler));
+}
+
+size_t IOUringReactor::numPendingOperations() const {
+    return _operations.size();
+}
+
+io_uring_sqe* IOUringReactor::_getSqe() {
+    while (true) {
+        const unsigned head = __atomic_load_n(_sqHead, __ATOMIC_ACQUIRE);
+        if (_sqeTail - head < _sqEntries) {
+            auto sqe = &_sqes[_sqeTail & _sqMask];
+            ++_sqeTail;
+            memset(sqe, 0, sizeof(*sqe));
+            return sqe;
+        }
+
+        // The submission queue is full, hand the queued entries to the kernel to make room.
+        const auto submitted = _sqeSubmitted;
+        _submit(false);
+        if (_sqeSubmitted == submitted) {
+            // The kernel only refuses submissions while its completion queue is full.
+            _reapCompletions();
+        }
+    }
+}
+
+void IOUringReactor::_startOperation(uint8_t opcode,
+                                     int fd,
+                                     const void* buf,
+                                     uint32_t len,
+                                     uint16_t ioprio,
+                                     uint32_t opFlags,
+                                     CompletionHandler handler) {
+    invariant(isRunningInThisThread());
+
+    _operations.emplace_front();
+    auto& op = _operations.front();
+    op.opcode = opcode;
+    op.handler = std::move(handler);
+    op.self = _operations.begin();
+
+    auto sqe = _getSqe();
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->ioprio = ioprio;
+    sqe->addr = reinterpret_cast<uint64_t>(buf);
+    sqe->len = len;
+    // All the operation specific flags (msg_flags, accept_flags) share the same storage.
+    sqe->msg_flags = opFlags;
+    sqe->user_data = reinterpret_cast<uint64_t>(&op);
+}
+
+void IOUringReactor::_armWakeup() {
+    auto sqe = _getSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = _wakeupFd;
+    sqe->addr = reinterpret_cast<uint64_t>(&_wakeupValue);
+    sqe->len = sizeof(_wakeupValue);
+    sqe->off = 0;
+    sqe->user_data = kWakeupUserData;
+    _wakeupArmed = true;
+}
+
+void IOUringReactor::_submit(bool wait) {
+    // Publish the new entries to the kernel.
+    __atomic_store_n(_sqTail, _sqeTail, __ATOMIC_RELEASE);
+
+    const unsigned toSubmit = _sqeTail - _sqeSubmitted;
+    if (toSubmit == 0 && !wait) {
+        return;
+    }
+
+    const unsigned minComplete = wait ? 1 : 0;
+    const unsigned flags = wait ? IORING_ENTER_GETEVENTS : 0;
+    while (true) {
+        const int ret = ioUringEnter(_ringFd, toSubmit, minComplete, flags);
+        if (ret >= 0) {
+            _sqeSubmitted += ret;
+            return;
+        }
+
+        const int err = errno;
+        if (err == EINTR) {
+            continue;
+        }
+        if (err == EAGAIN || err == EBUSY) {
+            // Out of memory for requests or the completion queue is full, which is resolved by
+            // reaping completions.
+            return;
+        }
+
+        severe() << "io_uring_enter failed: " << errnoWithDescription(err);
+        fassertFailed(50712);
+    }
+}
+
+void IOUringReactor::_reapCompletions() {
+    unsigned head = *_cqHead;
+    while (true) {
+        const unsigned tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            return;
+        }
+
+        const io_uring_cqe cqe = _cqes[head & _cqMask];
+        ++head;
+        // Hand the entry back to the kernel before running the handler, which may start new
+        // operations.
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+        _complete(cqe.user_data, cqe.res, cqe.flags);
+    }
+}
+
+void IOUringReactor::_complete(uint64_t userData, int result, uint32_t flags) {
+    if (userData == kWakeupUserData) {
+        _wakeupArmed = false;
+        return;
+    }
+    if (userData == kCancelUserData) {
+        return;
+    }
+
+    auto op = reinterpret_cast<Operation*>(userData);
+    if (_draining) {
+        // Nothing is left to own a connection accepted while the reactor is being destroyed
+        if (op->opcode == IORING_OP_ACCEPT && result >= 0) {
+            ::close(result);
+        }
+        if (!(flags & kCqeFlagMore)) {
+            _operations.erase(op->self);
+        }
+        return;
+    }
+
+    if (flags & kCqeFlagMore) {
+        op->handler(result, true);
+        return;
+    }
+
+    auto handler = std::move(op->handler);
+    _operations.erase(op->self);
+    handler(result, false);
+}
+
+void IOUringReactor::_cancelAndDrain() {
+    _draining = true;
+
+    auto cancel = [this](uint64_t userData) {
+        auto sqe = _getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = userData;
+        sqe->user_data = kCancelUserData;
+    };
+
+    for (const auto& op : _operations) {
+        cancel(reinterpret_cast<uint64_t>(&op));
+    }
+    if (_wakeupArmed) {
+        cancel(kWakeupUserData);
+    }
+
+    // The handlers of the cancelled operations are released without being run, once the kernel no
+    // longer refers to their buffers.
+    while (!_operations.empty() || _wakeupArmed) {
+        _submit(true);
+        _reapCompletions();
+    }
+}
+
+bool IOUringReactor::_runTasks() {
+    std::vector<Task> tasks;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_tasks.empty()) {
+            return false;
+        }
+        tasks.swap(_tasks);
+    }
+
+    for (auto& task : tasks) {
+        task();
+    }
+    return true;
+}
+
+#else
+
+IOUringReactor::IOUringReactor() = default;
+
+IOUringReactor::~IOUringReactor() = default;
+
+Status IOUringReactor::init(unsigned entries) {
+    return {ErrorCodes::IllegalOperation, "This server was built without io_uring support"};
+}
+
+void IOUringReactor::run() {
+    MONGO_UNREACHABLE;
+}
+
+void IOUringReactor::stop() {
+    _stopped.store(true);
+}
+
+bool IOUringReactor::isRunningInThisThread() const {
+    return _localReactor == this;
+}
+
+void IOUringReactor::post(Task task) {
+    MONGO_UNREACHABLE;
+}
+
+void IOUringReactor::dispatch(Task task) {
+    MONGO_UNREACHABLE;
+}
+
+void IOUringReactor::accept(int fd, bool multishot, CompletionHandler handler) {
+    MONGO_UNREACHABLE;
+}
+
+void IOUringReactor::recv(int fd, void* buf, size_t len, CompletionHandler handler) {
+    MONGO_UNREACHABLE;
+}
+
+void IOUringReactor::send(int fd, const void* buf, size_t len, CompletionHandler handler) {
+    MONGO_UNREACHABLE;
+}
+
+size_t IOUringReactor::numPendingOperations() const {
+    return _operations.size();
+}
+
+#endif  // MONGO_CONFIG_HAVE_IO_URING
+
+}  // namespace transport
+}  // namespace mongo
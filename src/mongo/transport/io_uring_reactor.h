@@ -0,0 +1,225 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace mongo {
+namespace transport {
+
+/**
+ * An event loop built directly on a Linux io_uring instance, without liburing.
+ *
+ * Operations are queued in the submission ring as they are started and are handed to the kernel
+ * in a single io_uring_enter() call per iteration of the loop, which is also the call that waits
+ * for completions. A reactor that runs the network operations of many sessions therefore makes
+ * one system call for all the sends and receives started while handling the previous batch of
+ * completions, instead of one or more per operation.
+ *
+ * The operations of a reactor and their completion handlers only ever run on the thread which
+ * runs the reactor. Other threads hand work to the reactor through post(), which wakes it up
+ * through an eventfd that is read by an operation kept in the ring.
+ *
+ * Only available if the server was built with MONGO_CONFIG_HAVE_IO_URING, and requires a kernel
+ * with IORING_FEAT_FAST_POLL (Linux 5.7), so that socket operations wait through the poll
+ * machinery of the ring instead of blocking kernel worker threads.
+ */
+class IOUringReactor {
+    MONGO_DISALLOW_COPYING(IOUringReactor);
+
+public:
+    using Task = stdx::function<void()>;
+
+    /**
+     * Called with the result of an operation, which is the number of bytes transferred or the
+     * accepted file descriptor on success, and a negated errno value on failure. 'more' is true if
+     * the operation is multishot and will complete again.
+     */
+    using CompletionHandler = stdx::function<void(int result, bool more)>;
+
+    IOUringReactor();
+
+    /**
+     * Cancels the operations in the ring and waits for the kernel to complete them, so that their
+     * buffers can be released. Must not be called while run() is executing.
+     */
+    ~IOUringReactor();
+
+    /**
+     * Creates the ring, with room for 'entries' submissions. Must be called once before any other
+     * method, and fails if io_uring is not available or not recent enough.
+     */
+    Status init(unsigned entries);
+
+    /**
+     * Runs tasks and completion handlers on the calling thread until stop() is called.
+     */
+    void run();
+
+    /**
+     * Makes run() return, and any subsequent call to it return immediately. Tasks which have not
+     * run yet are dropped when the reactor is destroyed, and operations which have not completed
+     * yet are cancelled, without running their handlers. Thread safe.
+     */
+    void stop();
+
+    /**
+     * Returns true if the calling thread is running this reactor.
+     */
+    bool isRunningInThisThread() const;
+
+    /**
+     * Queues a task to be run on the reactor thread. Thread safe, but only once init() succeeded.
+     */
+    void post(Task task);
+
+    /**
+     * Runs the task inline if called from the reactor thread, and posts it otherwise.
+     */
+    void dispatch(Task task);
+
+    /**
+     * Starts accepting a connection on the listening socket 'fd'. A multishot accept completes
+     * once for every accepted connection, falling back to single shot if the kernel does not
+     * support it.
+     *
+     * Like recv() and send() this must be called from the reactor thread.
+     */
+    void accept(int fd, bool multishot, CompletionHandler handler);
+
+    /**
+     * Starts receiving up to 'len' bytes into 'buf'. The buffer must stay valid until the handler
+     * runs.
+     */
+    void recv(int fd, void* buf, size_t len, CompletionHandler handler);
+
+    /**
+     * Starts sending up to 'len' bytes from 'buf'. The buffer must stay valid until the handler
+     * runs.
+     */
+    void send(int fd, const void* buf, size_t len, CompletionHandler handler);
+
+    /**
+     * Returns the number of operations which have been started but have not completed. Must be
+     * called from the reactor thread.
+     */
+    size_t numPendingOperations() const;
+
+private:
+    struct Operation {
+        uint8_t opcode;
+        CompletionHandler handler;
+        std::list<Operation>::iterator self;
+    };
+
+    io_uring_sqe* _getSqe();
+    void _startOperation(uint8_t opcode,
+                         int fd,
+                         const void* buf,
+                         uint32_t len,
+                         uint16_t ioprio,
+                         uint32_t opFlags,
+                         CompletionHandler handler);
+
+    /**
+     * Hands the queued submissions to the kernel and, if 'wait' is true, waits for at least one
+     * completion.
+     */
+    void _submit(bool wait);
+    void _reapCompletions();
+    void _complete(uint64_t userData, int result, uint32_t flags);
+    void _armWakeup();
+
+    /**
+     * Cancels all the operations in the ring, and reaps completions until none are left.
+     */
+    void _cancelAndDrain();
+    bool _runTasks();
+
+    static thread_local IOUringReactor* _localReactor;
+
+    int _ringFd = -1;
+    int _wakeupFd = -1;
+
+    // Mappings shared with the kernel
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    io_uring_sqe* _sqes = nullptr;
+    size_t _sqesSize = 0;
+
+    unsigned* _sqHead = nullptr;
+    unsigned* _sqTail = nullptr;
+    unsigned _sqMask = 0;
+    unsigned _sqEntries = 0;
+    unsigned* _cqHead = nullptr;
+    unsigned* _cqTail = nullptr;
+    unsigned _cqMask = 0;
+    io_uring_cqe* _cqes = nullptr;
+
+    // Submission queue entries handed out by _getSqe(), and the number of those consumed by the
+    // kernel. Both are only accessed by the reactor thread.
+    unsigned _sqeTail = 0;
+    unsigned _sqeSubmitted = 0;
+
+    // Whether the eventfd read used to wake up the reactor is in the ring
+    bool _wakeupArmed = false;
+    uint64_t _wakeupValue = 0;
+
+    // Set while the reactor is being destroyed, when completions no longer run their handlers
+    bool _draining = false;
+
+    // Cleared the first time the kernel rejects a multishot accept
+    bool _multishotAcceptSupported = true;
+
+    // Operations in the ring, owned here so that they are released if the reactor is destroyed
+    // before they complete. The address of an operation is its user_data.
+    std::list<Operation> _operations;
+
+    AtomicWord<bool> _stopped{false};
+
+    mutable stdx::mutex _mutex;
+    std::vector<Task> _tasks;
+};
+
+}  // namespace transport
+}  // namespace mongo
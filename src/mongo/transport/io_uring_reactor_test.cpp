@@ -0,0 +1,258 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/io_uring_reactor.h"
+
+#include <array>
+#include <boost/optional.hpp>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mongo/config.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using transport::IOUringReactor;
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+
+/**
+ * Runs a reactor on a separate thread. Tests are skipped if the kernel does not support io_uring.
+ */
+class IOUringReactorTest : public unittest::Test {
+public:
+    void setUp() override {
+        auto status = reactor.init(8);
+        if (!status.isOK()) {
+            log() << "Skipping test, io_uring is not available: " << status;
+            return;
+        }
+        available = true;
+        thread = stdx::thread([this] { reactor.run(); });
+    }
+
+    void tearDown() override {
+        if (available) {
+            reactor.stop();
+            thread.join();
+        }
+    }
+
+    template <typename Pred>
+    void waitFor(Pred pred) {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, pred);
+    }
+
+    void notify() {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        cv.notify_all();
+    }
+
+    IOUringReactor reactor;
+    bool available = false;
+    stdx::thread thread;
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+};
+
+TEST_F(IOUringReactorTest, PostedTasksRunOnReactorThread) {
+    if (!available)
+        return;
+
+    ASSERT_FALSE(reactor.isRunningInThisThread());
+
+    const int kNumTasks = 1000;
+    int numRun = 0;
+    int numRunOnReactorThread = 0;
+    for (int i = 0; i < kNumTasks; ++i) {
+        reactor.post([&] {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            if (reactor.isRunningInThisThread()) {
+                ++numRunOnReactorThread;
+            }
+            if (++numRun == kNumTasks) {
+                cv.notify_all();
+            }
+        });
+    }
+
+    waitFor([&] { return numRun == kNumTasks; });
+    ASSERT_EQ(kNumTasks, numRunOnReactorThread);
+}
+
+TEST_F(IOUringReactorTest, SendAndRecv) {
+    if (!available)
+        return;
+
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds));
+    const auto guard = MakeGuard([&] {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    });
+
+    // Start more operations than fit in the submission queue at once.
+    const int kNumSends = 20;
+    char recvBuf[kNumSends] = {};
+    int numSent = 0;
+    boost::optional<int> recvResult;
+
+    reactor.post([&] {
+        reactor.recv(fds[1], recvBuf, sizeof(recvBuf), [&](int result, bool) {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            recvResult = result;
+            cv.notify_all();
+        });
+
+        for (int i = 0; i < kNumSends; ++i) {
+            reactor.send(fds[0], "x", 1, [&](int result, bool) {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (result == 1) {
+                    ++numSent;
+                }
+                cv.notify_all();
+            });
+        }
+    });
+
+    waitFor([&] { return numSent == kNumSends && recvResult; });
+    ASSERT_GT(*recvResult, 0);
+    ASSERT_EQ('x', recvBuf[0]);
+}
+
+TEST_F(IOUringReactorTest, RecvCompletesWhenSocketIsShutDown) {
+    if (!available)
+        return;
+
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds));
+    const auto guard = MakeGuard([&] {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    });
+
+    char recvBuf[16];
+    bool started = false;
+    boost::optional<int> recvResult;
+
+    reactor.post([&] {
+        reactor.recv(fds[0], recvBuf, sizeof(recvBuf), [&](int result, bool) {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            recvResult = result;
+            cv.notify_all();
+        });
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        started = true;
+        cv.notify_all();
+    });
+
+    waitFor([&] { return started; });
+    ASSERT_EQ(0, ::shutdown(fds[0], SHUT_RDWR));
+    waitFor([&] { return static_cast<bool>(recvResult); });
+    ASSERT_EQ(0, *recvResult);
+}
+
+TEST(IOUringReactor, DestructionCancelsPendingOperations) {
+    int fds[2];
+    ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds));
+    const auto guard = MakeGuard([&] {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    });
+
+    auto buffer = std::make_shared<std::array<char, 16>>();
+    std::weak_ptr<std::array<char, 16>> weakBuffer = buffer;
+    bool handlerRan = false;
+
+    {
+        IOUringReactor reactor;
+        auto status = reactor.init(8);
+        if (!status.isOK()) {
+            log() << "Skipping test, io_uring is not available: " << status;
+            return;
+        }
+        stdx::thread thread([&] { reactor.run(); });
+
+        stdx::mutex mutex;
+        stdx::condition_variable cv;
+        bool started = false;
+
+        // Only the handler of the receive refers to its buffer
+        reactor.post([&, buffer = std::move(buffer) ] {
+            reactor.recv(fds[0], buffer->data(), buffer->size(), [&handlerRan, buffer](int, bool) {
+                handlerRan = true;
+            });
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            started = true;
+            cv.notify_all();
+        });
+
+        {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            cv.wait(lk, [&] { return started; });
+        }
+        reactor.stop();
+        thread.join();
+        ASSERT_FALSE(weakBuffer.expired());
+    }
+
+    // The buffer was only released once the kernel completed the cancelled receive
+    ASSERT_TRUE(weakBuffer.expired());
+    ASSERT_FALSE(handlerRan);
+}
+
+#endif  // MONGO_CONFIG_HAVE_IO_URING
+
+TEST(IOUringReactor, InitFailsOnlyWithoutKernelOrBuildSupport) {
+    IOUringReactor reactor;
+    auto status = reactor.init(8);
+#ifndef MONGO_CONFIG_HAVE_IO_URING
+    ASSERT_EQ(ErrorCodes::IllegalOperation, status);
+#else
+    if (!status.isOK()) {
+        ASSERT_EQ(ErrorCodes::InternalError, status);
+    }
+#endif
+}
+
+}  // namespace
+}  // namespace mongo
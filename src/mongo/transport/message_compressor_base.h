@@ -33,6 +33,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/platform/atomic_word.h"
 
+#include <string>
 #include <type_traits>
 
 namespace mongo {
@@ -40,6 +41,8 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    // Not part of the upstream wire protocol, so kept clear of the IDs assigned there
+    kZlibDictionary = 128,
     kExtended = 255,
 };
 
@@ -53,7 +56,7 @@ public:
     virtual ~MessageCompressorBase() = default;
 
     /*
-     * Returns the name for subclass compressors (e.g. "snappy", "zlib", or "noop")
+     * Returns the name for subclass compressors (e.g. "snappy", "zlib", "zlibdict", or "noop")
      */
     const std::string& getName() const {
         return _name;
@@ -123,6 +126,13 @@ protected:
         : _id{static_cast<MessageCompressorId>(id)},
           _name{getMessageCompressorName(id).toString()} {}
 
+    /*
+     * Used by sub-classes whose negotiated name differs from the default name of their ID, because
+     * it depends on their configuration.
+     */
+    MessageCompressorBase(MessageCompressor id, std::string name)
+        : _id{static_cast<MessageCompressorId>(id)}, _name{std::move(name)} {}
+
     /*
      * Called by sub-classes to bump their bytesIn/bytesOut counters for compression
      */
@@ -37,6 +37,7 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/transport/message_compressor_zlib_dictionary.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
@@ -233,6 +234,58 @@ TEST(ZlibMessageCompressor, Fidelity) {
     checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibMessageCompressor, FidelityWithCompressionLevel) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>(1));
+}
+
+const std::string kTestDictionary = "Hello, world!";
+
+TEST(ZlibDictionaryMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage,
+                  stdx::make_unique<ZlibDictionaryMessageCompressor>(
+                      kTestDictionary, ZlibMessageCompressor::kDefaultCompressionLevel));
+}
+
+TEST(ZlibDictionaryMessageCompressor, DictionaryImprovesCompression) {
+    const std::string data = "{ insert: \"TestColl\", $db: \"TestDB\" }";
+    ConstDataRange input(data.data(), data.size());
+
+    ZlibMessageCompressor plainCompressor;
+    std::vector<char> plainBuffer(plainCompressor.getMaxCompressedSize(data.size()));
+    auto swPlain =
+        plainCompressor.compressData(input, DataRange(plainBuffer.data(), plainBuffer.size()));
+    ASSERT_OK(swPlain);
+
+    ZlibDictionaryMessageCompressor dictionaryCompressor(
+        data, ZlibMessageCompressor::kDefaultCompressionLevel);
+    std::vector<char> dictionaryBuffer(dictionaryCompressor.getMaxCompressedSize(data.size()));
+    auto swDictionary = dictionaryCompressor.compressData(
+        input, DataRange(dictionaryBuffer.data(), dictionaryBuffer.size()));
+    ASSERT_OK(swDictionary);
+
+    ASSERT_LT(swDictionary.getValue(), swPlain.getValue());
+}
+
+TEST(ZlibDictionaryMessageCompressor, DifferentDictionaryFailsDecompression) {
+    const std::string data = "Hello, world! Hello, world!";
+    ConstDataRange input(data.data(), data.size());
+
+    ZlibDictionaryMessageCompressor compressor(kTestDictionary,
+                                               ZlibMessageCompressor::kDefaultCompressionLevel);
+    std::vector<char> compressed(compressor.getMaxCompressedSize(data.size()));
+    auto sws = compressor.compressData(input, DataRange(compressed.data(), compressed.size()));
+    ASSERT_OK(sws);
+
+    ZlibDictionaryMessageCompressor otherCompressor(
+        "Goodbye, world!", ZlibMessageCompressor::kDefaultCompressionLevel);
+    std::vector<char> decompressed(data.size());
+    ASSERT_NOT_OK(
+        otherCompressor.decompressData(ConstDataRange(compressed.data(), sws.getValue()),
+                                       DataRange(decompressed.data(), decompressed.size())));
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<SnappyMessageCompressor>());
 }
@@ -241,6 +294,44 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+TEST(ZlibDictionaryMessageCompressor, NameIdentifiesDictionary) {
+    ZlibDictionaryMessageCompressor compressor(kTestDictionary,
+                                               ZlibMessageCompressor::kDefaultCompressionLevel);
+    ASSERT_EQ(ZlibDictionaryMessageCompressor::getNameForDictionary(kTestDictionary),
+              compressor.getName());
+    ASSERT_NE(ZlibDictionaryMessageCompressor::getNameForDictionary("Goodbye, world!"),
+              compressor.getName());
+    ASSERT_NE(static_cast<MessageCompressorId>(3), compressor.getId());
+}
+
+TEST(ZlibDictionaryMessageCompressor, NotNegotiatedWithDifferentDictionary) {
+    MessageCompressorRegistry registry;
+    auto compressor = stdx::make_unique<ZlibDictionaryMessageCompressor>(
+        kTestDictionary, ZlibMessageCompressor::kDefaultCompressionLevel);
+    registry.setSupportedCompressors({compressor->getName()});
+    registry.registerImplementation(std::move(compressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager manager(&registry);
+    const auto otherName = ZlibDictionaryMessageCompressor::getNameForDictionary("Goodbye");
+
+    BSONObjBuilder mismatchedOutput;
+    manager.serverNegotiate(BSON("isMaster" << 1 << "compression" << BSON_ARRAY(otherName)),
+                            &mismatchedOutput);
+    checkNegotiationResult(mismatchedOutput.done(), {});
+
+    const auto name = ZlibDictionaryMessageCompressor::getNameForDictionary(kTestDictionary);
+    BSONObjBuilder matchingOutput;
+    manager.serverNegotiate(BSON("isMaster" << 1 << "compression" << BSON_ARRAY(name)),
+                            &matchingOutput);
+    checkNegotiationResult(matchingOutput.done(), {name});
+}
+
+TEST(ZlibDictionaryMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZlibDictionaryMessageCompressor>(
+        kTestDictionary, ZlibMessageCompressor::kDefaultCompressionLevel));
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -35,15 +35,47 @@
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#include "mongo/transport/message_compressor_zlib_dictionary.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/options_parser/option_section.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <fstream>
+#include <sstream>
 
 namespace mongo {
 namespace {
 const auto kDisabledConfigValue = "disabled"_sd;
 const auto kDefaultConfigValue = "snappy"_sd;
+
+/*
+ * Reads the entire contents of the compression dictionary file at the specified path.
+ */
+StatusWith<std::string> readCompressionDictionary(const std::string& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unable to open network message compression dictionary " << path};
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+    if (file.bad()) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Unable to read network message compression dictionary " << path};
+    }
+
+    auto dictionary = contents.str();
+    if (dictionary.empty()) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Network message compression dictionary " << path
+                              << " is empty"};
+    }
+
+    return {std::move(dictionary)};
+}
 }  // namespace
 
 StringData getMessageCompressorName(MessageCompressor id) {
@@ -54,6 +86,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "snappy"_sd;
         case MessageCompressor::kZlib:
             return "zlib"_sd;
+        case MessageCompressor::kZlibDictionary:
+            return "zlibdict"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -111,6 +145,22 @@ void MessageCompressorRegistry::setSupportedCompressors(std::vector<std::string>
     _compressorNames = std::move(names);
 }
 
+void MessageCompressorRegistry::setZlibCompressionLevel(int level) {
+    _zlibCompressionLevel = level;
+}
+
+int MessageCompressorRegistry::getZlibCompressionLevel() const {
+    return _zlibCompressionLevel;
+}
+
+void MessageCompressorRegistry::setCompressionDictionary(std::string dictionary) {
+    _compressionDictionary = std::move(dictionary);
+}
+
+const std::string& MessageCompressorRegistry::getCompressionDictionary() const {
+    return _compressionDictionary;
+}
+
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell) {
     auto& ret =
         options
@@ -124,6 +174,24 @@ Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell)
     } else {
         ret.setDefault(moe::Value(kDefaultConfigValue.toString()));
     }
+
+    auto& level = options
+                      ->addOptionChaining("net.compression.zlibCompressionLevel",
+                                          "zlibCompressionLevel",
+                                          moe::Int,
+                                          "Compression level (0-9) of the zlib network message "
+                                          "compressors, -1 uses zlib's default")
+                      .validRange(-1, 9);
+    auto& dictionary =
+        options->addOptionChaining("net.compression.dictionaryFile",
+                                   "networkMessageCompressorDictionaryFile",
+                                   moe::String,
+                                   "Preset dictionary shared by all members of the cluster, "
+                                   "which is required by the zlibdict network message compressor");
+    if (forShell) {
+        level.hidden();
+        dictionary.hidden();
+    }
     return Status::OK();
 }
 
@@ -137,6 +205,37 @@ Status storeMessageCompressionOptions(const moe::Environment& params) {
     }
 
     auto& compressorFactory = MessageCompressorRegistry::get();
+
+    if (params.count("net.compression.zlibCompressionLevel")) {
+        compressorFactory.setZlibCompressionLevel(
+            params["net.compression.zlibCompressionLevel"].as<int>());
+    }
+
+    if (params.count("net.compression.dictionaryFile")) {
+        auto swDictionary =
+            readCompressionDictionary(params["net.compression.dictionaryFile"].as<std::string>());
+        if (!swDictionary.isOK()) {
+            return swDictionary.getStatus();
+        }
+
+        // The dictionary compressor is negotiated under a name, which identifies its dictionary,
+        // so that peers with different dictionaries do not agree on it
+        const auto negotiatedName =
+            ZlibDictionaryMessageCompressor::getNameForDictionary(swDictionary.getValue());
+        std::replace(restrict.begin(),
+                     restrict.end(),
+                     getMessageCompressorName(MessageCompressor::kZlibDictionary).toString(),
+                     negotiatedName);
+
+        compressorFactory.setCompressionDictionary(std::move(swDictionary.getValue()));
+    } else if (std::find(restrict.begin(),
+                         restrict.end(),
+                         getMessageCompressorName(MessageCompressor::kZlibDictionary)) !=
+               restrict.end()) {
+        return {ErrorCodes::BadValue,
+                "The zlibdict network message compressor requires net.compression.dictionaryFile"};
+    }
+
     compressorFactory.setSupportedCompressors(std::move(restrict));
 
     return Status::OK();
@@ -109,12 +109,30 @@ public:
      */
     Status finalizeSupportedCompressors();
 
+    /*
+     * Sets the compression level (0 to 9, or -1 for zlib's default) used by the zlib based
+     * compressors. Should be called during option parsing, like setSupportedCompressors.
+     */
+    void setZlibCompressionLevel(int level);
+    int getZlibCompressionLevel() const;
+
+    /*
+     * Sets the preset dictionary used by the "zlibdict" compressor. Should be called during
+     * option parsing, like setSupportedCompressors, which must then list the compressor under the
+     * name returned by ZlibDictionaryMessageCompressor::getNameForDictionary.
+     */
+    void setCompressionDictionary(std::string dictionary);
+    const std::string& getCompressionDictionary() const;
+
 private:
     StringMap<MessageCompressorBase*> _compressorsByName;
     std::array<std::unique_ptr<MessageCompressorBase>,
                std::numeric_limits<MessageCompressorId>::max() + 1>
         _compressorsByIds;
     std::vector<std::string> _compressorNames;
+
+    int _zlibCompressionLevel = -1;
+    std::string _compressionDictionary;
 };
 
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell);
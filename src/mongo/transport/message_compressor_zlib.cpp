@@ -39,7 +39,10 @@
 
 namespace mongo {
 
-ZlibMessageCompressor::ZlibMessageCompressor() : MessageCompressorBase(MessageCompressor::kZlib) {}
+constexpr int ZlibMessageCompressor::kDefaultCompressionLevel;
+
+ZlibMessageCompressor::ZlibMessageCompressor(int compressionLevel)
+    : MessageCompressorBase(MessageCompressor::kZlib), _compressionLevel(compressionLevel) {}
 
 std::size_t ZlibMessageCompressor::getMaxCompressedSize(size_t inputSize) {
     return ::compressBound(inputSize);
@@ -52,7 +55,7 @@ StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input
                           reinterpret_cast<uLongf*>(&outLength),
                           reinterpret_cast<const Bytef*>(input.data()),
                           input.length(),
-                          Z_DEFAULT_COMPRESSION);
+                          _compressionLevel);
 
     if (ret != Z_OK) {
         return Status{ErrorCodes::BadValue, "Could not compress input"};
@@ -83,7 +86,8 @@ MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
                           ("AllCompressorsRegistered"))
 (InitializerContext* context) {
     auto& compressorRegistry = MessageCompressorRegistry::get();
-    compressorRegistry.registerImplementation(stdx::make_unique<ZlibMessageCompressor>());
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZlibMessageCompressor>(compressorRegistry.getZlibCompressionLevel()));
     return Status::OK();
 }
 }  // namespace mongo
@@ -31,13 +31,19 @@
 namespace mongo {
 class ZlibMessageCompressor final : public MessageCompressorBase {
 public:
-    ZlibMessageCompressor();
+    // Same as zlib's Z_DEFAULT_COMPRESSION, which currently corresponds to level 6
+    static constexpr int kDefaultCompressionLevel = -1;
+
+    explicit ZlibMessageCompressor(int compressionLevel = kDefaultCompressionLevel);
 
     std::size_t getMaxCompressedSize(size_t inputSize) override;
 
     StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
 
     StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+private:
+    const int _compressionLevel;
 };
 
 
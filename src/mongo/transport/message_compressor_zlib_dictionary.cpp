@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/init.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zlib_dictionary.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+#include <zlib.h>
+
+namespace mongo {
+namespace {
+
+/*
+ * Computes the Adler-32 checksum of the dictionary, the same way zlib does for the dictionary id.
+ */
+unsigned long dictionaryChecksum(StringData dictionary) {
+    return ::adler32(::adler32(0L, Z_NULL, 0),
+                     reinterpret_cast<const Bytef*>(dictionary.rawData()),
+                     dictionary.size());
+}
+
+}  // namespace
+
+ZlibDictionaryMessageCompressor::ZlibDictionaryMessageCompressor(std::string dictionary,
+                                                                 int compressionLevel)
+    : MessageCompressorBase(MessageCompressor::kZlibDictionary, getNameForDictionary(dictionary)),
+      _dictionary(std::move(dictionary)),
+      _dictionaryId(dictionaryChecksum(_dictionary)),
+      _compressionLevel(compressionLevel) {}
+
+std::string ZlibDictionaryMessageCompressor::getNameForDictionary(StringData dictionary) {
+    return str::stream() << getMessageCompressorName(MessageCompressor::kZlibDictionary) << "-"
+                         << integerToHex(static_cast<unsigned int>(dictionaryChecksum(dictionary)));
+}
+
+std::size_t ZlibDictionaryMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    // The stream header additionally contains the 4 bytes dictionary id
+    return ::compressBound(inputSize) + 4;
+}
+
+StatusWith<std::size_t> ZlibDictionaryMessageCompressor::compressData(ConstDataRange input,
+                                                                      DataRange output) {
+    z_stream stream{};
+    if (::deflateInit(&stream, _compressionLevel) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Could not initialize compression"};
+    }
+    ON_BLOCK_EXIT([&stream] { ::deflateEnd(&stream); });
+
+    if (::deflateSetDictionary(&stream,
+                               reinterpret_cast<const Bytef*>(_dictionary.data()),
+                               _dictionary.size()) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Could not set compression dictionary"};
+    }
+
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+
+    if (::deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Could not compress input"};
+    }
+
+    counterHitCompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
+
+StatusWith<std::size_t> ZlibDictionaryMessageCompressor::decompressData(ConstDataRange input,
+                                                                        DataRange output) {
+    z_stream stream{};
+    if (::inflateInit(&stream) != Z_OK) {
+        return Status{ErrorCodes::BadValue, "Could not initialize decompression"};
+    }
+    ON_BLOCK_EXIT([&stream] { ::inflateEnd(&stream); });
+
+    stream.next_in = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = const_cast<Bytef*>(reinterpret_cast<const Bytef*>(output.data()));
+    stream.avail_out = output.length();
+
+    int ret = ::inflate(&stream, Z_FINISH);
+    if (ret == Z_NEED_DICT) {
+        if (stream.adler != _dictionaryId) {
+            return Status{ErrorCodes::BadValue,
+                          "Compressed message was compressed with a different dictionary"};
+        }
+
+        if (::inflateSetDictionary(&stream,
+                                   reinterpret_cast<const Bytef*>(_dictionary.data()),
+                                   _dictionary.size()) != Z_OK) {
+            return Status{ErrorCodes::BadValue, "Could not set compression dictionary"};
+        }
+
+        ret = ::inflate(&stream, Z_FINISH);
+    }
+
+    if (ret != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
+
+
+// The dictionary compressor is only registered if a dictionary was configured, which
+// storeMessageCompressionOptions enforces if the compressor was requested
+MONGO_INITIALIZER_GENERAL(ZlibDictionaryMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    if (compressorRegistry.getCompressionDictionary().empty()) {
+        return Status::OK();
+    }
+
+    compressorRegistry.registerImplementation(stdx::make_unique<ZlibDictionaryMessageCompressor>(
+        compressorRegistry.getCompressionDictionary(),
+        compressorRegistry.getZlibCompressionLevel()));
+    return Status::OK();
+}
+}  // namespace mongo
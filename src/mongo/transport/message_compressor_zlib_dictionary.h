@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+/*
+ * Compresses messages with zlib, priming both the compressor and the decompressor with a preset
+ * dictionary of byte sequences which are common in the messages exchanged in the cluster (field
+ * names, command names, namespaces). This makes the compression of small, repetitive messages
+ * much more effective than with plain zlib, but requires all members of the cluster, which
+ * negotiate this compressor, to be configured with the same dictionary.
+ *
+ * The negotiated name of the compressor contains the checksum of its dictionary (for example
+ * "zlibdict-1a2b3c4d"), so peers configured with different dictionaries do not negotiate it and
+ * fall back to another compressor.
+ */
+class ZlibDictionaryMessageCompressor final : public MessageCompressorBase {
+public:
+    ZlibDictionaryMessageCompressor(std::string dictionary, int compressionLevel);
+
+    /*
+     * Returns the name under which the compressor is negotiated with the specified dictionary.
+     */
+    static std::string getNameForDictionary(StringData dictionary);
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+private:
+    const std::string _dictionary;
+
+    // Adler-32 checksum of the dictionary, which zlib embeds in the compressed stream so that the
+    // decompressor can detect that it was compressed using a different dictionary
+    const unsigned long _dictionaryId;
+
+    const int _compressionLevel;
+};
+
+
+}  // namespace mongo
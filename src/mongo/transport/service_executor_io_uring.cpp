@@ -0,0 +1,214 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_io_uring.h"
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// Number of reactors, and so of worker threads, to partition the connections across. Zero means
+// one per available core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ioUringNumReactors, int, 0);
+
+// Tasks may recurse further than this to avoid stack overflows
+MONGO_EXPORT_SERVER_PARAMETER(ioUringServiceExecutorRecursionLimit, int, 8);
+
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "io_uring"_sd;
+constexpr auto kTotalScheduled = "totalScheduled"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+
+}  // namespace
+
+thread_local IOUringReactor* ServiceExecutorIOUring::_localReactor = nullptr;
+thread_local int ServiceExecutorIOUring::_localRecursionDepth = 0;
+
+size_t ServiceExecutorIOUring::getNumReactors() {
+    auto configured = ioUringNumReactors;
+    if (configured > 0) {
+        return static_cast<size_t>(configured);
+    }
+
+    ProcessInfo p;
+    auto cores = p.getNumAvailableCores();
+    if (cores) {
+        return std::max<size_t>(*cores, 1);
+    }
+    return std::max<size_t>(p.getNumCores(), 1);
+}
+
+ServiceExecutorIOUring::ServiceExecutorIOUring(
+    ServiceContext* ctx, std::vector<std::shared_ptr<IOUringReactor>> reactors)
+    : _reactors(std::move(reactors)) {
+    invariant(!_reactors.empty());
+}
+
+ServiceExecutorIOUring::~ServiceExecutorIOUring() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorIOUring::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (size_t reactorIndex = 0; reactorIndex < _reactors.size(); ++reactorIndex) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+            _numRunningThreads++;
+        }
+
+        auto status = launchServiceWorkerThread(
+            [this, reactorIndex] { _workerThreadRoutine(reactorIndex); });
+
+        if (!status.isOK()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+                _numRunningThreads--;
+            }
+            // Stop the threads which have already been started.
+            shutdown(Seconds(10)).ignore();
+            return status;
+        }
+    }
+
+    log() << "Started " << _reactors.size() << " io_uring service executor worker threads";
+
+    return Status::OK();
+}
+
+Status ServiceExecutorIOUring::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    for (auto& reactor : _reactors) {
+        reactor->stop();
+    }
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _numRunningThreads == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "io_uring executor couldn't shutdown all worker threads within time limit.");
+}
+
+Status ServiceExecutorIOUring::schedule(Task task,
+                                        ScheduleFlags flags,
+                                        ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    _totalScheduled.addAndFetch(1);
+
+    // Tasks scheduled from a worker thread stay on its reactor. The transport layer starts new
+    // sessions from the thread of their reactor, so only the tasks scheduled from elsewhere are
+    // distributed round-robin.
+    auto reactor = _localReactor;
+    if (!reactor) {
+        reactor = _reactors[_nextReactor.fetchAndAdd(1) % _reactors.size()].get();
+    }
+
+    auto wrappedTask = [ this, task = std::move(task) ] {
+        _localRecursionDepth++;
+        const auto guard = MakeGuard([this] {
+            _localRecursionDepth--;
+            _totalExecuted.addAndFetch(1);
+        });
+        task();
+    };
+
+    if ((flags & kMayRecurse) && reactor == _localReactor &&
+        (_localRecursionDepth + 1 < ioUringServiceExecutorRecursionLimit.load())) {
+        wrappedTask();
+    } else {
+        reactor->post(std::move(wrappedTask));
+    }
+
+    return Status::OK();
+}
+
+void ServiceExecutorIOUring::_workerThreadRoutine(size_t reactorIndex) {
+    auto reactor = _reactors[reactorIndex].get();
+    _localReactor = reactor;
+    {
+        std::string threadName = str::stream() << "worker-" << reactorIndex;
+        setThreadName(threadName);
+    }
+
+    const auto guard = MakeGuard([this] {
+        _localReactor = nullptr;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+            _numRunningThreads--;
+        }
+        _deathCondition.notify_one();
+    });
+
+    while (_isRunning.load()) {
+        try {
+            // Only returns once the reactor has been stopped by shutdown().
+            reactor->run();
+        } catch (std::exception& e) {
+            severe() << "Exception escaped io_uring worker thread: " << e.what();
+        } catch (...) {
+            severe() << "Unknown exception escaped io_uring worker thread";
+        }
+    }
+}
+
+void ServiceExecutorIOUring::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        section << kThreadsRunning << static_cast<int64_t>(_numRunningThreads);
+    }
+    section << kTotalScheduled << _totalScheduled.load() << kTotalExecuted
+            << _totalExecuted.load();
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/io_uring_reactor.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * The ServiceExecutor of TransportLayerIOUring. Each of the transport layer's reactors is run by
+ * a worker thread of this executor, so all the network completions of a session, and the tasks
+ * they schedule, run on the thread of the reactor the session was assigned to when it was
+ * accepted. Like ServiceExecutorPinned, this does not start additional threads when its threads
+ * are blocked.
+ */
+class ServiceExecutorIOUring final : public ServiceExecutor {
+public:
+    /**
+     * Returns the number of reactors the transport layer should create, which is configured
+     * through the ioUringNumReactors server parameter.
+     */
+    static size_t getNumReactors();
+
+    ServiceExecutorIOUring(ServiceContext* ctx,
+                           std::vector<std::shared_ptr<IOUringReactor>> reactors);
+    ~ServiceExecutorIOUring();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    void _workerThreadRoutine(size_t reactorIndex);
+
+    static thread_local IOUringReactor* _localReactor;
+    static thread_local int _localRecursionDepth;
+
+    std::vector<std::shared_ptr<IOUringReactor>> _reactors;
+
+    // Used to distribute the tasks scheduled from outside the worker threads
+    AtomicWord<unsigned> _nextReactor{0};
+
+    AtomicWord<int64_t> _totalScheduled{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+
+    AtomicBool _isRunning{false};
+
+    mutable stdx::mutex _threadsMutex;
+    stdx::condition_variable _deathCondition;
+    size_t _numRunningThreads = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
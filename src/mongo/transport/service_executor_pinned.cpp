@@ -0,0 +1,332 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_pinned.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// Number of io_contexts to partition the connections across. Zero means one per available core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(pinnedServiceExecutorNumIOContexts, int, 0);
+
+// Number of worker threads which run each io_context
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(pinnedServiceExecutorThreadsPerIOContext, int, 1);
+
+// Whether the worker threads of an io_context should be bound to a single core
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(pinnedServiceExecutorBindThreads, bool, true);
+
+// Number of tasks waiting on an io_context above which newly scheduled tasks are handed to the
+// least loaded io_context instead
+MONGO_EXPORT_SERVER_PARAMETER(pinnedServiceExecutorMaxQueuedTasks, int, 16);
+
+// Tasks may recurse further than this to avoid stack overflows
+MONGO_EXPORT_SERVER_PARAMETER(pinnedServiceExecutorRecursionLimit, int, 8);
+
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "pinned"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTotalReceivedFromOverloaded = "totalReceivedFromOverloaded"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kContexts = "ioContexts"_sd;
+
+size_t numAvailableCores() {
+    ProcessInfo p;
+    auto cores = p.getNumAvailableCores();
+    if (cores) {
+        return std::max<size_t>(*cores, 1);
+    }
+    return std::max<size_t>(p.getNumCores(), 1);
+}
+
+/**
+ * Binds the calling thread to the core with the given index, wrapping around the available cores.
+ * This is best effort, failures are only logged.
+ */
+void bindCurrentThreadToCore(size_t coreIndex) {
+#if defined(__linux__)
+    cpu_set_t available;
+    CPU_ZERO(&available);
+    if (sched_getaffinity(0, sizeof(available), &available) != 0 || CPU_COUNT(&available) == 0) {
+        return;
+    }
+
+    // Only consider the cores this process is allowed to run on, so that restrictions imposed
+    // through taskset or cgroups are honored.
+    auto target = coreIndex % CPU_COUNT(&available);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &available) || target-- != 0)
+            continue;
+
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+        if (ret != 0) {
+            warning() << "Failed to bind worker thread to cpu " << cpu << ": "
+                      << errnoWithDescription(ret);
+        }
+        return;
+    }
+#endif
+}
+
+}  // namespace
+
+thread_local ServiceExecutorPinned::HomeContext* ServiceExecutorPinned::_localHomeContext =
+    nullptr;
+thread_local int ServiceExecutorPinned::_localRecursionDepth = 0;
+
+size_t ServiceExecutorPinned::getNumIOContexts() {
+    auto configured = pinnedServiceExecutorNumIOContexts;
+    if (configured > 0) {
+        return static_cast<size_t>(configured);
+    }
+    return numAvailableCores();
+}
+
+ServiceExecutorPinned::ServiceExecutorPinned(
+    ServiceContext* ctx, std::vector<std::shared_ptr<asio::io_context>> ioContexts) {
+    invariant(!ioContexts.empty());
+    for (auto& ioContext : ioContexts) {
+        _contexts.emplace_back(stdx::make_unique<HomeContext>(std::move(ioContext)));
+    }
+}
+
+ServiceExecutorPinned::~ServiceExecutorPinned() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorPinned::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    const size_t threadsPerContext =
+        static_cast<size_t>(std::max(pinnedServiceExecutorThreadsPerIOContext, 1));
+
+    for (size_t contextIndex = 0; contextIndex < _contexts.size(); ++contextIndex) {
+        for (size_t threadIndex = 0; threadIndex < threadsPerContext; ++threadIndex) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+                _numRunningThreads++;
+            }
+
+            auto status = launchServiceWorkerThread([this, contextIndex, threadIndex] {
+                _workerThreadRoutine(contextIndex, threadIndex);
+            });
+
+            if (!status.isOK()) {
+                {
+                    stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+                    _numRunningThreads--;
+                }
+                // Stop the threads which have already been started.
+                shutdown(Seconds(10)).ignore();
+                return status;
+            }
+        }
+    }
+
+    log() << "Started " << _contexts.size() << " pinned service executor io_contexts with "
+          << threadsPerContext << " worker thread(s) each";
+
+    return Status::OK();
+}
+
+Status ServiceExecutorPinned::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    for (auto& context : _contexts) {
+        context->ioContext->stop();
+    }
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _numRunningThreads == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "pinned executor couldn't shutdown all worker threads within time limit.");
+}
+
+ServiceExecutorPinned::HomeContext* ServiceExecutorPinned::_selectContext() {
+    // The transport layer starts new sessions from a thread of their socket's io_context, so this
+    // only distributes the tasks scheduled from elsewhere round-robin.
+    auto home = _localHomeContext;
+    if (!home) {
+        home = _contexts[_nextContext.fetchAndAdd(1) % _contexts.size()].get();
+    }
+
+    const int maxQueued = pinnedServiceExecutorMaxQueuedTasks.load();
+    if (_contexts.size() == 1 || maxQueued <= 0 || home->tasksQueued.load() <= maxQueued) {
+        return home;
+    }
+
+    // The home io_context is backed up, hand the task to whichever io_context has the shortest
+    // queue instead of waiting for the home threads to catch up.
+    auto leastLoaded = home;
+    auto leastQueued = home->tasksQueued.load();
+    for (auto& context : _contexts) {
+        auto queued = context->tasksQueued.load();
+        if (queued < leastQueued) {
+            leastLoaded = context.get();
+            leastQueued = queued;
+        }
+    }
+
+    if (leastLoaded != home) {
+        leastLoaded->totalReceivedFromOverloaded.addAndFetch(1);
+    }
+    return leastLoaded;
+}
+
+Status ServiceExecutorPinned::schedule(Task task,
+                                       ScheduleFlags flags,
+                                       ServiceExecutorTaskName taskName) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    auto context = _selectContext();
+    context->tasksQueued.addAndFetch(1);
+
+    auto wrappedTask = [ context, task = std::move(task) ] {
+        context->tasksQueued.subtractAndFetch(1);
+        _localRecursionDepth++;
+        const auto guard = MakeGuard([context] {
+            _localRecursionDepth--;
+            context->totalExecuted.addAndFetch(1);
+        });
+        task();
+    };
+
+    // Only dispatch, and so possibly run the task inline, if the current thread is running the
+    // chosen io_context. Otherwise the task would run outside of its home io_context.
+    if ((flags & kMayRecurse) && context == _localHomeContext &&
+        (_localRecursionDepth + 1 < pinnedServiceExecutorRecursionLimit.load())) {
+        context->ioContext->dispatch(std::move(wrappedTask));
+    } else {
+        context->ioContext->post(std::move(wrappedTask));
+    }
+
+    return Status::OK();
+}
+
+void ServiceExecutorPinned::_workerThreadRoutine(size_t contextIndex, size_t threadIndex) {
+    auto context = _contexts[contextIndex].get();
+    _localHomeContext = context;
+    {
+        std::string threadName = str::stream() << "worker-" << contextIndex << "-" << threadIndex;
+        setThreadName(threadName);
+    }
+
+    if (pinnedServiceExecutorBindThreads) {
+        bindCurrentThreadToCore(contextIndex);
+    }
+
+    const auto guard = MakeGuard([this] {
+        _localHomeContext = nullptr;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+            _numRunningThreads--;
+        }
+        _deathCondition.notify_one();
+    });
+
+    while (_isRunning.load()) {
+        try {
+            asio::io_context::work work(*context->ioContext);
+            context->ioContext->run_for(Seconds(1).toSystemDuration());
+
+            // run_for() returns immediately once the io_context has been stopped, so restart it
+            // unless we are shutting down.
+            if (context->ioContext->stopped() && _isRunning.load())
+                context->ioContext->restart();
+        } catch (std::exception& e) {
+            severe() << "Exception escaped pinned worker thread: " << e.what();
+        } catch (...) {
+            severe() << "Unknown exception escaped pinned worker thread";
+        }
+    }
+}
+
+void ServiceExecutorPinned::appendStats(BSONObjBuilder* bob) const {
+    int64_t totalQueued = 0;
+    int64_t totalExecuted = 0;
+    int64_t totalReceivedFromOverloaded = 0;
+
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << kExecutorLabel << kExecutorName;
+
+    BSONArrayBuilder contexts;
+    for (const auto& context : _contexts) {
+        auto queued = context->tasksQueued.load();
+        auto executed = context->totalExecuted.load();
+        auto received = context->totalReceivedFromOverloaded.load();
+        contexts.append(BSON(kTasksQueued << queued << kTotalExecuted << executed
+                                          << kTotalReceivedFromOverloaded
+                                          << received));
+        totalQueued += queued;
+        totalExecuted += executed;
+        totalReceivedFromOverloaded += received;
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        section << kThreadsRunning << static_cast<int64_t>(_numRunningThreads);
+    }
+    section << kTasksQueued << totalQueued << kTotalExecuted << totalExecuted
+            << kTotalReceivedFromOverloaded << totalReceivedFromOverloaded;
+    section.append(kContexts, contexts.arr());
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
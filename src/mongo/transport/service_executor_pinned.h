@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/transport/service_executor_task_names.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+
+/**
+ * This is an ASIO-based ServiceExecutor, which partitions the work of the process across several
+ * io_contexts, one per CPU core by default. Each io_context is run by its own small, fixed set of
+ * worker threads, which are bound to the corresponding core where the platform supports it.
+ *
+ * The transport layer distributes accepted sockets across the same io_contexts and starts each
+ * session from a thread of its socket's io_context, so the first task of a session and all the
+ * network completions for it run on its home io_context's threads. Tasks scheduled from a worker
+ * thread stay on that thread's io_context, which keeps a session on the same core for its entire
+ * lifetime. A task is only handed to another io_context if the home io_context has more than
+ * maxQueuedTasks() tasks waiting, in which case it goes to the least loaded one.
+ *
+ * Unlike ServiceExecutorAdaptive, this executor does not start additional threads when its
+ * threads are blocked, so it is intended for workloads of short, mostly non-blocking operations.
+ */
+class ServiceExecutorPinned final : public ServiceExecutor {
+public:
+    /**
+     * Returns the number of io_contexts the executor expects the transport layer to create, which
+     * is configured through the pinnedServiceExecutorNumIOContexts server parameter.
+     */
+    static size_t getNumIOContexts();
+
+    ServiceExecutorPinned(ServiceContext* ctx,
+                          std::vector<std::shared_ptr<asio::io_context>> ioContexts);
+    ~ServiceExecutorPinned();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags, ServiceExecutorTaskName taskName) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+private:
+    /**
+     * An io_context together with the statistics of the tasks scheduled on it.
+     */
+    struct HomeContext {
+        explicit HomeContext(std::shared_ptr<asio::io_context> ioCtx)
+            : ioContext(std::move(ioCtx)) {}
+
+        std::shared_ptr<asio::io_context> ioContext;
+
+        // Number of tasks which were posted to the io_context, but have not started yet
+        AtomicWord<int> tasksQueued{0};
+
+        AtomicWord<int64_t> totalExecuted{0};
+
+        // Number of tasks, which were scheduled on this io_context because their home io_context
+        // was overloaded
+        AtomicWord<int64_t> totalReceivedFromOverloaded{0};
+    };
+
+    /**
+     * Returns the io_context on which a task, scheduled from the current thread, should run.
+     */
+    HomeContext* _selectContext();
+
+    void _workerThreadRoutine(size_t contextIndex, size_t threadIndex);
+
+    static thread_local HomeContext* _localHomeContext;
+    static thread_local int _localRecursionDepth;
+
+    std::vector<std::unique_ptr<HomeContext>> _contexts;
+
+    // Used to distribute the tasks scheduled from outside the worker threads
+    AtomicWord<unsigned> _nextContext{0};
+
+    AtomicBool _isRunning{false};
+
+    mutable stdx::mutex _threadsMutex;
+    stdx::condition_variable _deathCondition;
+    size_t _numRunningThreads = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
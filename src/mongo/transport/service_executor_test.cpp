@@ -34,6 +34,7 @@
 
 #include "mongo/db/service_context_noop.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_pinned.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/unittest/unittest.h"
@@ -106,6 +107,23 @@ protected:
     std::unique_ptr<ServiceExecutorSynchronous> executor;
 };
 
+class ServiceExecutorPinnedFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+
+        std::vector<std::shared_ptr<asio::io_context>> ioContexts;
+        for (int i = 0; i < 2; ++i) {
+            ioContexts.emplace_back(std::make_shared<asio::io_context>());
+        }
+        executor = stdx::make_unique<ServiceExecutorPinned>(getGlobalServiceContext(),
+                                                            std::move(ioContexts));
+    }
+
+    std::unique_ptr<ServiceExecutorPinned> executor;
+};
+
 void scheduleBasicTask(ServiceExecutor* exec, bool expectSuccess) {
     stdx::condition_variable cond;
     stdx::mutex mutex;
@@ -147,6 +165,52 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+TEST_F(ServiceExecutorPinnedFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorPinnedFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorPinnedFixture, TasksScheduledFromWorkerStayOnItsThread) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    stdx::condition_variable cond;
+    stdx::mutex mutex;
+    boost::optional<stdx::thread::id> outerThread;
+    boost::optional<stdx::thread::id> innerThread;
+
+    auto innerTask = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        innerThread = stdx::this_thread::get_id();
+        cond.notify_all();
+    };
+    auto outerTask = [&] {
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            outerThread = stdx::this_thread::get_id();
+        }
+        ASSERT_OK(executor->schedule(std::move(innerTask),
+                                     ServiceExecutor::kEmptyFlags,
+                                     ServiceExecutorTaskName::kSSMProcessMessage));
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(executor->schedule(std::move(outerTask),
+                                 ServiceExecutor::kEmptyFlags,
+                                 ServiceExecutorTaskName::kSSMStartSession));
+    cond.wait(lk, [&] { return static_cast<bool>(innerThread); });
+
+    // Each io_context is run by a single thread by default, so a task scheduled from a worker
+    // must run on that same worker.
+    ASSERT(outerThread);
+    ASSERT(*outerThread == *innerThread);
+}
 
 }  // namespace
 }  // namespace mongo
@@ -34,7 +34,9 @@
 
 #include "mongo/config.h"
 #include "mongo/db/client.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
@@ -55,6 +57,11 @@
 
 namespace mongo {
 namespace {
+// When enabled, the time each connection spends in each state is recorded in the
+// network.transportStages section of serverStatus, and the time each request spent queued in the
+// ServiceExecutor is reported in slow operation logs, the profiler and currentOp.
+MONGO_EXPORT_SERVER_PARAMETER(traceTransportStages, bool, false);
+
 // Set up proper headers for formatting an exhaust request, if we need to
 bool setExhaustMessage(Message* m, const DbResponse& dbresponse) {
     MsgData::View header = dbresponse.response.header();
@@ -240,6 +247,7 @@ void ServiceStateMachine::_sourceMessage(ThreadGuard guard) {
     invariant(_inMessage.empty());
     invariant(_state.load() == State::Source);
     _state.store(State::SourceWait);
+    _beginStage();
     guard.release();
 
     if (_transportMode == transport::Mode::kSynchronous) {
@@ -268,6 +276,7 @@ void ServiceStateMachine::_sinkMessage(ThreadGuard guard, Message toSink) {
     // Sink our response to the client
     invariant(_state.load() == State::Process);
     _state.store(State::SinkWait);
+    _beginStage();
     guard.release();
 
     if (_transportMode == transport::Mode::kSynchronous) {
@@ -289,6 +298,8 @@ void ServiceStateMachine::_sourceCallback(Status status) {
 
     if (status.isOK()) {
         _state.store(State::Process);
+        _endStage(TransportStageCounter::Stage::kSourceWait);
+        _beginStage();
 
         // Since we know that we're going to process a message, call scheduleNext() immediately
         // to schedule the call to processMessage() on the serviceExecutor (or just unwind the
@@ -325,6 +336,7 @@ void ServiceStateMachine::_sinkCallback(Status status) {
     ThreadGuard guard(this);
 
     dassert(state() == State::SinkWait);
+    _endStage(TransportStageCounter::Stage::kSinkWait);
 
     // If there was an error sinking the message to the client, then we should print an error and
     // end the session. No need to unwind the stack, so this will runNextInGuard() and return.
@@ -354,6 +366,9 @@ void ServiceStateMachine::_sinkCallback(Status status) {
 void ServiceStateMachine::_processMessage(ThreadGuard guard) {
     invariant(!_inMessage.empty());
 
+    const auto queueTime = _endStage(TransportStageCounter::Stage::kExecutorQueue);
+    _beginStage();
+
     auto& compressorMgr = MessageCompressorManager::forSession(_session());
 
     _compressorId = boost::none;
@@ -369,6 +384,11 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
 
     // Pass sourced Message to handler to generate response.
     auto opCtx = Client::getCurrent()->makeOperationContext();
+    if (queueTime) {
+        stdx::lock_guard<Client> lk(*opCtx->getClient());
+        CurOp::get(opCtx.get())->debug().executorQueueMicros =
+            durationCount<Microseconds>(*queueTime);
+    }
 
     // The handleRequest is implemented in a subclass for mongod/mongos and actually all the
     // database work for this request.
@@ -377,6 +397,7 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
     // opCtx must be destroyed here so that the operation cannot show
     // up in currentOp results after the response reaches the client
     opCtx.reset();
+    _endStage(TransportStageCounter::Stage::kProcess);
 
     // Format our response, if we have one
     Message& toSink = dbresponse.response;
@@ -530,6 +551,31 @@ void ServiceStateMachine::_terminateAndLogIfError(Status status) {
     }
 }
 
+void ServiceStateMachine::_beginStage() {
+    if (traceTransportStages.load()) {
+        _stageStart = _serviceContext->getTickSource()->getTicks();
+    } else {
+        _stageStart = boost::none;
+    }
+}
+
+boost::optional<Microseconds> ServiceStateMachine::_endStage(TransportStageCounter::Stage stage) {
+    if (!_stageStart) {
+        return boost::none;
+    }
+
+    auto tickSource = _serviceContext->getTickSource();
+    const auto ticks = tickSource->getTicks() - *_stageStart;
+    const auto ticksPerSecond = tickSource->getTicksPerSecond();
+    _stageStart = boost::none;
+
+    // Split the conversion so that long waits for idle clients cannot overflow.
+    const Microseconds duration = Seconds(ticks / ticksPerSecond) +
+        Microseconds((ticks % ticksPerSecond) * 1000 * 1000 / ticksPerSecond);
+    transportStageCounter.record(stage, duration);
+    return duration;
+}
+
 void ServiceStateMachine::_cleanupSession(ThreadGuard guard) {
     _state.store(State::Ended);
 
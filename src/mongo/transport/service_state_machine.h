@@ -33,6 +33,7 @@
 #include "mongo/base/status.h"
 #include "mongo/config.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/counters.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/memory.h"
@@ -44,6 +45,7 @@
 #include "mongo/transport/service_executor_task_names.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_mode.h"
+#include "mongo/util/tick_source.h"
 
 namespace mongo {
 
@@ -213,6 +215,18 @@ private:
      */
     void _cleanupSession(ThreadGuard guard);
 
+    /*
+     * Marks the start of a stage of the state machine if the traceTransportStages server
+     * parameter is enabled.
+     */
+    void _beginStage();
+
+    /*
+     * Records the time spent since the last call to _beginStage() under "stage" and returns it.
+     * Returns boost::none if stage timing was disabled when the stage began.
+     */
+    boost::optional<Microseconds> _endStage(TransportStageCounter::Stage stage);
+
     AtomicWord<State> _state{State::Created};
 
     ServiceEntryPoint* _sep;
@@ -230,6 +244,8 @@ private:
     boost::optional<MessageCompressorId> _compressorId;
     Message _inMessage;
 
+    boost::optional<TickSource::Tick> _stageStart;
+
     AtomicWord<Ownership> _owned{Ownership::kUnowned};
 #if MONGO_CONFIG_DEBUG_BUILD
     AtomicWord<stdx::thread::id> _owningThread;
@@ -34,8 +34,11 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/client.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context_noop.h"
+#include "mongo/db/stats/counters.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/mock_session.h"
 #include "mongo/transport/service_entry_point.h"
@@ -48,6 +51,7 @@
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/op_msg.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/tick_source_mock.h"
 
 namespace mongo {
@@ -68,6 +72,7 @@ public:
         log() << "In handleRequest";
         _ranHandler = true;
         ASSERT_TRUE(haveClient());
+        _lastExecutorQueueMicros = CurOp::get(opCtx)->debug().executorQueueMicros;
 
         auto req = OpMsgRequest::parse(request);
         ASSERT_BSONOBJ_EQ(BSON("ping" << 1), req.body);
@@ -106,9 +111,14 @@ public:
         return ret;
     }
 
+    long long lastExecutorQueueMicros() const {
+        return _lastExecutorQueueMicros;
+    }
+
 private:
     bool _uassertInHandler = false;
     bool _ranHandler = false;
+    long long _lastExecutorQueueMicros = -1;
 };
 
 using namespace transport;
@@ -339,6 +349,49 @@ TEST_F(ServiceStateMachineFixture, TestOkaySimpleCommand) {
     checkPingOk();
 }
 
+long long transportStageCount(StringData stage) {
+    BSONObjBuilder builder;
+    transportStageCounter.append(builder);
+    return builder.obj()[stage]["count"].numberLong();
+}
+
+TEST_F(ServiceStateMachineFixture, TestStageTimingDisabledByDefault) {
+    const auto queueCount = transportStageCount("executorQueue");
+
+    runPingTest(State::Process, State::Source);
+    checkPingOk();
+    ASSERT_EQ(_sep->lastExecutorQueueMicros(), -1);
+    ASSERT_EQ(transportStageCount("executorQueue"), queueCount);
+}
+
+TEST_F(ServiceStateMachineFixture, TestStageTimingRecordsExecutorQueueTime) {
+    auto param = ServerParameterSet::getGlobal()->getMap().find("traceTransportStages")->second;
+    ASSERT_OK(param->setFromString("true"));
+    ON_BLOCK_EXIT([param] { param->setFromString("false").transitional_ignore(); });
+
+    const auto sourceWaitCount = transportStageCount("sourceWait");
+    const auto queueCount = transportStageCount("executorQueue");
+    const auto processCount = transportStageCount("process");
+    const auto sinkWaitCount = transportStageCount("sinkWait");
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Process);
+
+    // Simulate the request waiting in the ServiceExecutor before it gets to run.
+    auto tickSource = checked_cast<TickSourceMock*>(getGlobalServiceContext()->getTickSource());
+    tickSource->advance(Milliseconds(5));
+
+    _ssm->runNext();
+    ASSERT_EQ(_ssm->state(), State::Source);
+    checkPingOk();
+
+    ASSERT_EQ(_sep->lastExecutorQueueMicros(), 5000);
+    ASSERT_EQ(transportStageCount("sourceWait"), sourceWaitCount + 1);
+    ASSERT_EQ(transportStageCount("executorQueue"), queueCount + 1);
+    ASSERT_EQ(transportStageCount("process"), processCount + 1);
+    ASSERT_EQ(transportStageCount("sinkWait"), sinkWaitCount + 1);
+}
+
 TEST_F(ServiceStateMachineFixture, TestThrowHandling) {
     _sep->setUassertInHandler();
 
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <array>
 #include <utility>
 
 #include "mongo/base/system_error.h"
@@ -182,49 +183,74 @@ private:
     void sourceMessageImpl(bool sync, Callback&& cb) {
         static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
 
-        auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
-        auto ptr = headerBuffer.get();
-        read(
-            sync,
-            asio::buffer(ptr, kHeaderSize),
-            [ sync, cb = std::forward<Callback>(cb), headerBuffer = std::move(headerBuffer), this ](
-                const std::error_code& ec, size_t size) mutable {
-
-                if (ec)
-                    return cb(errorCodeToStatus(ec));
-                invariant(size == kHeaderSize);
-
-                const auto msgLen = size_t(MSGHEADER::View(headerBuffer.get()).getMessageLength());
-                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
-                    StringBuilder sb;
-                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
-                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
-                    const auto str = sb.str();
-                    LOG(0) << str;
+        // Only one message is ever being received on a session at a time, so the header can be
+        // read into storage owned by the session, rather than into a separate heap allocation.
+        read(sync,
+             asio::buffer(_recvHeader.data(), kHeaderSize),
+             [ sync, cb = std::forward<Callback>(cb), this ](const std::error_code& ec,
+                                                              size_t size) mutable {
+
+                 if (ec)
+                     return cb(errorCodeToStatus(ec));
+                 invariant(size == kHeaderSize);
+
+                 const auto msgLen =
+                     size_t(MSGHEADER::ConstView(_recvHeader.data()).getMessageLength());
+                 if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+                     StringBuilder sb;
+                     sb << "recv(): message msgLen " << msgLen << " is invalid. "
+                        << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+                     const auto str = sb.str();
+                     LOG(0) << str;
+
+                     return cb(Status(ErrorCodes::ProtocolError, str));
+                 }
+
+                 auto buffer = getReceiveBuffer(msgLen);
+                 memcpy(buffer.get(), _recvHeader.data(), kHeaderSize);
+
+                 if (msgLen == size) {
+                     // This probably isn't a real case since all (current) messages have bodies.
+                     networkCounter.hitPhysicalIn(msgLen);
+                     return cb(Message(std::move(buffer)));
+                 }
+
+                 MsgData::View msgView(buffer.get());
+                 read(sync,
+                      asio::buffer(msgView.data(), msgView.dataLen()),
+                      [ cb = std::move(cb), buffer = std::move(buffer), msgLen, this ](
+                          const std::error_code& ec, size_t size) mutable {
+                          if (ec)
+                              return cb(errorCodeToStatus(ec));
+                          networkCounter.hitPhysicalIn(msgLen);
+                          return cb(Message(std::move(buffer)));
+                      });
+             });
+    }
 
-                    return cb(Status(ErrorCodes::ProtocolError, str));
-                }
+    /**
+     * Returns a buffer of at least 'size' bytes to receive a message into. The buffer of the
+     * previously received message is reused if it is large enough and all the references to it
+     * have been released by the time the next message arrives, which is the common case for
+     * request/response traffic. This saves a heap allocation and free per message on connections
+     * with small messages.
+     */
+    SharedBuffer getReceiveBuffer(size_t size) {
+        // Limits how much memory an idle connection may keep pinned
+        static constexpr size_t kMaxRetainedReceiveBufferSize = 16 * 1024;
+
+        if (_recvBuffer && !_recvBuffer.isShared() && _recvBuffer.capacity() >= size) {
+            return _recvBuffer;
+        }
 
-                if (msgLen == size) {
-                    // This probably isn't a real case since all (current) messages have bodies.
-                    networkCounter.hitPhysicalIn(msgLen);
-                    return cb(Message(std::move(headerBuffer)));
-                }
+        auto buffer = SharedBuffer::allocate(size);
+        if (size <= kMaxRetainedReceiveBufferSize) {
+            _recvBuffer = buffer;
+        } else {
+            _recvBuffer = SharedBuffer();
+        }
 
-                auto buffer = SharedBuffer::allocate(msgLen);
-                memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
-
-                MsgData::View msgView(buffer.get());
-                read(sync,
-                     asio::buffer(msgView.data(), msgView.dataLen()),
-                     [ cb = std::move(cb), buffer = std::move(buffer), msgLen, this ](
-                         const std::error_code& ec, size_t size) mutable {
-                         if (ec)
-                             return cb(errorCodeToStatus(ec));
-                         networkCounter.hitPhysicalIn(msgLen);
-                         return cb(Message(std::move(buffer)));
-                     });
-            });
+        return buffer;
     }
 
 
@@ -448,6 +474,12 @@ private:
 #endif
 
     TransportLayerASIO* const _tl;
+
+    // Storage for the header of the message being received
+    std::array<char, sizeof(MSGHEADER::Value)> _recvHeader;
+
+    // Buffer of the most recently received message, which may be reused for the next one
+    SharedBuffer _recvBuffer;
 };
 
 }  // namespace transport
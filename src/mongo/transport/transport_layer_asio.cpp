@@ -72,13 +72,16 @@ TransportLayerASIO::Options::Options(const ServerGlobalParams* params)
 
 TransportLayerASIO::TransportLayerASIO(const TransportLayerASIO::Options& opts,
                                        ServiceEntryPoint* sep)
-    : _workerIOContext(std::make_shared<asio::io_context>()),
-      _acceptorIOContext(stdx::make_unique<asio::io_context>()),
+    : _acceptorIOContext(stdx::make_unique<asio::io_context>()),
 #ifdef MONGO_CONFIG_SSL
       _sslContext(nullptr),
 #endif
       _sep(sep),
       _listenerOptions(opts) {
+    const auto numWorkerIOContexts = std::max<size_t>(_listenerOptions.numWorkerIOContexts, 1);
+    for (size_t i = 0; i < numWorkerIOContexts; ++i) {
+        _workerIOContexts.emplace_back(std::make_shared<asio::io_context>());
+    }
 }
 
 TransportLayerASIO::~TransportLayerASIO() = default;
@@ -266,11 +269,19 @@ void TransportLayerASIO::shutdown() {
 }
 
 const std::shared_ptr<asio::io_context>& TransportLayerASIO::getIOContext() {
-    return _workerIOContext;
+    return _workerIOContexts.front();
+}
+
+const std::vector<std::shared_ptr<asio::io_context>>& TransportLayerASIO::getIOContexts() {
+    return _workerIOContexts;
 }
 
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
-    auto acceptCb = [this, &acceptor](const std::error_code& ec, GenericSocket peerSocket) mutable {
+    // Accept callbacks are only ever run by the listener, so this needs no synchronization.
+    auto workerIOContext = _workerIOContexts[_nextWorkerIOContext++ % _workerIOContexts.size()];
+
+    auto acceptCb = [this, &acceptor, workerIOContext](const std::error_code& ec,
+                                                       GenericSocket peerSocket) mutable {
         if (!_running.load())
             return;
 
@@ -283,11 +294,20 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
 
         std::shared_ptr<ASIOSession> session(new ASIOSession(this, std::move(peerSocket)));
 
-        _sep->startSession(std::move(session));
+        // With several worker io_contexts, the session is started from a thread of the io_context
+        // its socket belongs to, so that the ServiceExecutor keeps its tasks on that io_context
+        // rather than on whichever one it would pick for a task from the listener thread.
+        if (_workerIOContexts.size() > 1) {
+            workerIOContext->post([ this, session = std::move(session) ]() mutable {
+                _sep->startSession(std::move(session));
+            });
+        } else {
+            _sep->startSession(std::move(session));
+        }
         _acceptConnection(acceptor);
     };
 
-    acceptor.async_accept(*_workerIOContext, std::move(acceptCb));
+    acceptor.async_accept(*workerIOContext, std::move(acceptCb));
 }
 
 #ifdef MONGO_CONFIG_SSL
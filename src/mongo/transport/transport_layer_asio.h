@@ -86,6 +86,8 @@ public:
         Mode transportMode = Mode::kSynchronous;  // whether accepted sockets should be put into
                                                   // non-blocking mode after they're accepted
         size_t maxConns = DEFAULT_MAX_CONN;       // maximum number of active connections
+        size_t numWorkerIOContexts = 1;           // number of io_contexts to distribute accepted
+                                                  // sockets across
     };
 
     TransportLayerASIO(const Options& opts, ServiceEntryPoint* sep);
@@ -99,6 +101,12 @@ public:
 
     const std::shared_ptr<asio::io_context>& getIOContext();
 
+    /**
+     * Returns all the io_contexts accepted sockets are distributed across. The first one is the
+     * same as the one returned by getIOContext().
+     */
+    const std::vector<std::shared_ptr<asio::io_context>>& getIOContexts();
+
     int listenerPort() const {
         return _listenerPort;
     }
@@ -117,11 +125,13 @@ private:
 
     stdx::mutex _mutex;
 
-    // There are two IO contexts that are used by TransportLayerASIO. The _workerIOContext
-    // contains all the accepted sockets and all normal networking activity. The
+    // There are two kinds of IO contexts that are used by TransportLayerASIO. The
+    // _workerIOContexts contain all the accepted sockets and all normal networking activity. There
+    // is usually a single worker IO context, unless the service executor partitions connections
+    // across several of them, in which case accepted sockets are assigned round-robin. The
     // _acceptorIOContext contains all the sockets in _acceptors.
     //
-    // TransportLayerASIO should never call run() on the _workerIOContext.
+    // TransportLayerASIO should never call run() on the _workerIOContexts.
     // In synchronous mode, this will cause a massive performance degradation due to
     // unnecessary wakeups on the asio thread for sockets we don't intend to interact
     // with asynchronously. The additional IO context avoids registering those sockets
@@ -140,7 +150,8 @@ private:
     // the io_context), so that we destroy any existing acceptors or
     // other io_service associated state before we drop the refcount
     // on the io_context, which may destroy it.
-    std::shared_ptr<asio::io_context> _workerIOContext;
+    std::vector<std::shared_ptr<asio::io_context>> _workerIOContexts;
+    size_t _nextWorkerIOContext = 0;
     std::unique_ptr<asio::io_context> _acceptorIOContext;
 
 #ifdef MONGO_CONFIG_SSL
@@ -36,7 +36,11 @@
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message.h"
 #include "mongo/util/net/sock.h"
+#include "mongo/util/time_support.h"
+
+#include <asio.hpp>
 
 namespace mongo {
 namespace {
@@ -86,6 +90,12 @@ public:
         _cv.wait(lock, [&] { return !_sessions.empty(); });
     }
 
+    transport::SessionHandle waitForSession() {
+        stdx::unique_lock<stdx::mutex> lock(_mutex);
+        _cv.wait(lock, [&] { return !_sessions.empty(); });
+        return _sessions.front();
+    }
+
 private:
     mutable stdx::mutex _mutex;
     stdx::condition_variable _cv;
@@ -153,5 +163,171 @@ TEST(TransportLayerASIO, PortZeroConnect) {
     tla.shutdown();
 }
 
+/**
+ * Records which of the transport layer's worker io_contexts, if any, was running on the thread,
+ * which started each session.
+ */
+class ServiceEntryPointIOContextRecorder : public ServiceEntryPointUtil {
+public:
+    void startSession(transport::SessionHandle session) override {
+        int runningIndex = -1;
+        for (size_t i = 0; i < _ioContexts.size(); ++i) {
+            if (_ioContexts[i]->get_executor().running_in_this_thread()) {
+                runningIndex = static_cast<int>(i);
+            }
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _startedOn.push_back(runningIndex);
+        }
+        ServiceEntryPointUtil::startSession(std::move(session));
+    }
+
+    void setIOContexts(std::vector<std::shared_ptr<asio::io_context>> ioContexts) {
+        _ioContexts = std::move(ioContexts);
+    }
+
+    std::vector<int> startedOn() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _startedOn;
+    }
+
+private:
+    std::vector<std::shared_ptr<asio::io_context>> _ioContexts;
+
+    stdx::mutex _mutex;
+    std::vector<int> _startedOn;
+};
+
+TEST(TransportLayerASIO, SessionsStartOnTheirSocketsIOContext) {
+    ServiceEntryPointIOContextRecorder sepu;
+
+    auto options = [] {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerASIO::Options opts(&params);
+        opts.port = 0;
+        opts.transportMode = transport::Mode::kAsynchronous;
+        opts.numWorkerIOContexts = 2;
+        return opts;
+    }();
+
+    transport::TransportLayerASIO tla(options, &sepu);
+    sepu.setTransportLayer(&tla);
+    sepu.setIOContexts(tla.getIOContexts());
+
+    ASSERT_OK(tla.setup());
+    ASSERT_OK(tla.start());
+
+    // Stand in for the ServiceExecutor, which runs the worker io_contexts
+    std::vector<stdx::thread> workers;
+    for (const auto& ioContext : tla.getIOContexts()) {
+        workers.emplace_back([ioContext] {
+            asio::io_context::work work(*ioContext);
+            ioContext->run();
+        });
+    }
+
+    // The sockets are distributed round-robin, so each session belongs to a different io_context
+    Socket first;
+    SockAddr sa{"localhost", tla.listenerPort(), AF_INET};
+    ASSERT(first.connect(sa));
+    Socket second;
+    ASSERT(second.connect(sa));
+
+    while (sepu.numOpenSessions() < 2) {
+        sleepmillis(10);
+    }
+
+    const auto startedOn = sepu.startedOn();
+    ASSERT_EQ(2U, startedOn.size());
+    ASSERT_GTE(startedOn[0], 0);
+    ASSERT_GTE(startedOn[1], 0);
+    ASSERT_NE(startedOn[0], startedOn[1]);
+
+    first.close();
+    second.close();
+    sepu.endAllSessions({});
+    tla.shutdown();
+
+    for (const auto& ioContext : tla.getIOContexts()) {
+        ioContext->stop();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Sends a message with a body of 'bodySize' bytes over the specified socket.
+ */
+void sendMessage(Socket* socket, size_t bodySize) {
+    const std::string body(bodySize, 'x');
+    Message message;
+    message.setData(dbQuery, body.data(), body.size());
+    socket->send(message.buf(), message.size(), "sendMessage");
+}
+
+TEST(TransportLayerASIO, SessionReusesReceiveBuffer) {
+    ServiceEntryPointUtil sepu;
+
+    auto options = [] {
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        transport::TransportLayerASIO::Options opts(&params);
+        opts.port = 0;
+        return opts;
+    }();
+
+    transport::TransportLayerASIO tla(options, &sepu);
+    sepu.setTransportLayer(&tla);
+
+    ASSERT_OK(tla.setup());
+    ASSERT_OK(tla.start());
+
+    Socket socket;
+    SockAddr sa{"localhost", tla.listenerPort(), AF_INET};
+    ASSERT(socket.connect(sa));
+    auto session = sepu.waitForSession();
+
+    // The session keeps the buffer of a small message for the next one
+    sendMessage(&socket, 200);
+    auto swFirst = session->sourceMessage();
+    ASSERT_OK(swFirst.getStatus());
+    const char* const firstBuffer = swFirst.getValue().buf();
+    SharedBuffer firstShared = swFirst.getValue().sharedBuffer();
+    swFirst.getValue().reset();
+    ASSERT(firstShared.isShared());
+    firstShared = SharedBuffer();
+
+    // Once all the references to it are released, it is reused for a message, which fits into it
+    sendMessage(&socket, 100);
+    auto swSecond = session->sourceMessage();
+    ASSERT_OK(swSecond.getStatus());
+    ASSERT_EQ(static_cast<const void*>(firstBuffer),
+              static_cast<const void*>(swSecond.getValue().buf()));
+
+    // A buffer, which is still referenced, is never reused
+    sendMessage(&socket, 100);
+    auto swThird = session->sourceMessage();
+    ASSERT_OK(swThird.getStatus());
+    ASSERT_NE(static_cast<const void*>(swSecond.getValue().buf()),
+              static_cast<const void*>(swThird.getValue().buf()));
+
+    // The buffer of a large message is not kept pinned by the session
+    sendMessage(&socket, 32 * 1024);
+    auto swLarge = session->sourceMessage();
+    ASSERT_OK(swLarge.getStatus());
+    SharedBuffer largeShared = swLarge.getValue().sharedBuffer();
+    swLarge.getValue().reset();
+    ASSERT_FALSE(largeShared.isShared());
+
+    socket.close();
+    session.reset();
+    sepu.endAllSessions({});
+    tla.shutdown();
+}
+
 }  // namespace
 }  // namespace mongo
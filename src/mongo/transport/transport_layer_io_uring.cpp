@@ -0,0 +1,571 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include "mongo/config.h"
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <boost/algorithm/string.hpp>
+
+#include "mongo/db/stats/counters.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/session.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/sock.h"
+#include "mongo/util/net/ssl_options.h"
+
+namespace mongo {
+namespace transport {
+
+TransportLayerIOUring::Options::Options(const ServerGlobalParams* params)
+    : port(params->port),
+      ipList(params->bind_ip),
+      useUnixSockets(!params->noUnixSocket),
+      enableIPv6(params->enableIPv6) {}
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+namespace {
+
+constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+Status errnoToStatus(int err) {
+    return {ErrorCodes::SocketException, errnoWithDescription(err)};
+}
+
+Status endOfFileStatus() {
+    return {ErrorCodes::SocketException, "End of file"};
+}
+
+}  // namespace
+
+class TransportLayerIOUring::IOUringSession final : public Session {
+    MONGO_DISALLOW_COPYING(IOUringSession);
+
+public:
+    IOUringSession(TransportLayerIOUring* tl, IOUringReactor* reactor, int fd)
+        : _tl(tl), _reactor(reactor), _fd(fd) {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        if (::getsockname(_fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0) {
+            SockAddr local(addr, addrLen);
+            if (local.getType() == AF_INET || local.getType() == AF_INET6) {
+                const int on = 1;
+                ::setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                ::setsockopt(_fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+                setSocketKeepAliveParams(_fd);
+            }
+            _local = HostAndPort(local);
+        }
+
+        addrLen = sizeof(addr);
+        if (::getpeername(_fd, reinterpret_cast<sockaddr*>(&addr), &addrLen) == 0) {
+            _remote = HostAndPort(SockAddr(addr, addrLen));
+        } else {
+            LOG(3) << "Unable to get remote endpoint address: " << errnoWithDescription();
+        }
+    }
+
+    ~IOUringSession() {
+        end();
+        ::close(_fd);
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    void end() override {
+        // Shutting the socket down completes any receive in the ring, the descriptor itself is
+        // only closed once no operation refers to it anymore.
+        if (!_ended.swap(true)) {
+            if (::shutdown(_fd, SHUT_RDWR) != 0 && errno != ENOTCONN) {
+                error() << "Error shutting down socket: " << errnoWithDescription();
+            }
+        }
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        auto status = _recvAll(_recvHeader.data(), kHeaderSize);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        auto swBuffer = _makeReceiveBuffer();
+        if (!swBuffer.isOK()) {
+            return swBuffer.getStatus();
+        }
+
+        auto buffer = std::move(swBuffer.getValue());
+        MsgData::View msgView(buffer.get());
+        status = _recvAll(msgView.data(), msgView.dataLen());
+        if (!status.isOK()) {
+            return status;
+        }
+
+        networkCounter.hitPhysicalIn(msgView.getLen());
+        return Message(std::move(buffer));
+    }
+
+    void asyncSourceMessage(std::function<void(StatusWith<Message>)> cb) override {
+        _reactor->dispatch([ self = _self(), cb = std::move(cb) ] {
+            self->_asyncRecv(
+                self->_recvHeader.data(), kHeaderSize, [self, cb](Status status) {
+                    if (!status.isOK()) {
+                        return cb(status);
+                    }
+
+                    auto swBuffer = self->_makeReceiveBuffer();
+                    if (!swBuffer.isOK()) {
+                        return cb(swBuffer.getStatus());
+                    }
+
+                    auto buffer = std::move(swBuffer.getValue());
+                    MsgData::View msgView(buffer.get());
+                    self->_asyncRecv(msgView.data(),
+                                     msgView.dataLen(),
+                                     [buffer, cb](Status status) {
+                                         if (!status.isOK()) {
+                                             return cb(status);
+                                         }
+                                         Message msg(buffer);
+                                         networkCounter.hitPhysicalIn(msg.size());
+                                         cb(std::move(msg));
+                                     });
+                });
+        });
+    }
+
+    Status sinkMessage(Message message) override {
+        auto status = _sendAll(message.buf(), message.size());
+        if (status.isOK()) {
+            networkCounter.hitPhysicalOut(message.size());
+        }
+        return status;
+    }
+
+    void asyncSinkMessage(Message message, std::function<void(Status)> cb) override {
+        _reactor->dispatch([ self = _self(), message, cb = std::move(cb) ] {
+            // The message is kept alive by the completion handler.
+            self->_asyncSend(message.buf(), message.size(), [message, cb](Status status) {
+                if (status.isOK()) {
+                    networkCounter.hitPhysicalOut(message.size());
+                }
+                cb(status);
+            });
+        });
+    }
+
+private:
+    std::shared_ptr<IOUringSession> _self() {
+        return std::static_pointer_cast<IOUringSession>(shared_from_this());
+    }
+
+    /**
+     * Validates the header in _recvHeader and returns a buffer for the whole message, which starts
+     * with a copy of the header. The buffer of the previous message is reused when nothing refers
+     * to it anymore, like in ASIOSession.
+     */
+    StatusWith<SharedBuffer> _makeReceiveBuffer() {
+        // Limits how much memory an idle connection may keep pinned
+        static constexpr size_t kMaxRetainedReceiveBufferSize = 16 * 1024;
+
+        const auto msgLen = size_t(MSGHEADER::ConstView(_recvHeader.data()).getMessageLength());
+        if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+            StringBuilder sb;
+            sb << "recv(): message msgLen " << msgLen << " is invalid. "
+               << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+            const auto str = sb.str();
+            LOG(0) << str;
+
+            return Status(ErrorCodes::ProtocolError, str);
+        }
+
+        SharedBuffer buffer;
+        if (_recvBuffer && !_recvBuffer.isShared() && _recvBuffer.capacity() >= msgLen) {
+            buffer = _recvBuffer;
+        } else {
+            buffer = SharedBuffer::allocate(msgLen);
+            _recvBuffer = msgLen <= kMaxRetainedReceiveBufferSize ? buffer : SharedBuffer();
+        }
+
+        memcpy(buffer.get(), _recvHeader.data(), kHeaderSize);
+        return std::move(buffer);
+    }
+
+    /**
+     * Receives exactly 'len' bytes into 'buf' on the reactor, and calls 'cb' on the reactor
+     * thread once done.
+     */
+    void _asyncRecv(char* buf, size_t len, stdx::function<void(Status)> cb) {
+        if (len == 0) {
+            return cb(Status::OK());
+        }
+
+        _reactor->recv(_fd, buf, len, [ self = _self(), buf, len, cb ](int result, bool) {
+            if (result < 0) {
+                return cb(errnoToStatus(-result));
+            }
+            if (result == 0) {
+                return cb(endOfFileStatus());
+            }
+            self->_asyncRecv(buf + result, len - result, cb);
+        });
+    }
+
+    void _asyncSend(const char* buf, size_t len, stdx::function<void(Status)> cb) {
+        if (len == 0) {
+            return cb(Status::OK());
+        }
+
+        _reactor->send(_fd, buf, len, [ self = _self(), buf, len, cb ](int result, bool) {
+            if (result < 0) {
+                return cb(errnoToStatus(-result));
+            }
+            self->_asyncSend(buf + result, len - result, cb);
+        });
+    }
+
+    Status _recvAll(char* buf, size_t len) {
+        while (len > 0) {
+            const auto result = ::recv(_fd, buf, len, 0);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errnoToStatus(errno);
+            }
+            if (result == 0) {
+                return endOfFileStatus();
+            }
+            buf += result;
+            len -= result;
+        }
+        return Status::OK();
+    }
+
+    Status _sendAll(const char* buf, size_t len) {
+        while (len > 0) {
+            const auto result = ::send(_fd, buf, len, MSG_NOSIGNAL);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errnoToStatus(errno);
+            }
+            buf += result;
+            len -= result;
+        }
+        return Status::OK();
+    }
+
+    TransportLayerIOUring* const _tl;
+    IOUringReactor* const _reactor;
+    const int _fd;
+
+    HostAndPort _local;
+    HostAndPort _remote;
+
+    AtomicWord<bool> _ended{false};
+
+    // Only one message is ever being received on a session at a time, so the header can be read
+    // into storage owned by the session.
+    std::array<char, kHeaderSize> _recvHeader;
+    SharedBuffer _recvBuffer;
+};
+
+TransportLayerIOUring::TransportLayerIOUring(const TransportLayerIOUring::Options& opts,
+                                             ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {
+    const auto numReactors = std::max<size_t>(_listenerOptions.numReactors, 1);
+    for (size_t i = 0; i < numReactors; ++i) {
+        _workerReactors.emplace_back(std::make_shared<IOUringReactor>());
+    }
+}
+
+TransportLayerIOUring::~TransportLayerIOUring() {
+    for (auto& acceptor : _acceptors) {
+        ::close(acceptor.second);
+    }
+}
+
+Status TransportLayerIOUring::setup() {
+    if (sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+        return {ErrorCodes::InvalidOptions, "The io_uring transport layer does not support SSL"};
+    }
+
+    // The acceptor only ever has one multishot accept per listening socket in its ring.
+    auto status = _acceptorReactor.init(64);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    for (auto& reactor : _workerReactors) {
+        status = reactor->init(_listenerOptions.ringEntries);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    std::vector<std::string> listenAddrs;
+    if (_listenerOptions.ipList.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    } else {
+        boost::split(
+            listenAddrs, _listenerOptions.ipList, boost::is_any_of(","), boost::token_compress_on);
+    }
+
+    if (_listenerOptions.useUnixSockets) {
+        listenAddrs.emplace_back(makeUnixSockPath(_listenerOptions.port));
+    }
+
+    _listenerPort = _listenerOptions.port;
+
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            warning() << "Skipping empty bind address";
+            continue;
+        }
+
+        const auto addrs = SockAddr::createAll(
+            ip, _listenerOptions.port, _listenerOptions.enableIPv6 ? AF_UNSPEC : AF_INET);
+        if (addrs.empty()) {
+            warning() << "Found no addresses for " << ip;
+            continue;
+        }
+
+        for (const auto& addr : addrs) {
+            if (addr.getType() == AF_UNIX) {
+                if (::unlink(ip.c_str()) == -1 && errno != ENOENT) {
+                    error() << "Failed to unlink socket file " << ip << " "
+                            << errnoWithDescription(errno);
+                    fassertFailedNoTrace(50713);
+                }
+            }
+
+            if (addr.getType() == AF_INET6 && !_listenerOptions.enableIPv6) {
+                error() << "Specified ipv6 bind address, but ipv6 is disabled";
+                fassertFailedNoTrace(50714);
+            }
+
+            const int fd = ::socket(addr.getType(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (fd < 0) {
+                return errnoToStatus(errno);
+            }
+            _acceptors.emplace_back(addr, fd);
+
+            const int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (addr.getType() == AF_INET6) {
+                ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &on, sizeof(on));
+            }
+
+            if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+                return errnoToStatus(errno);
+            }
+
+            if (addr.getType() == AF_UNIX) {
+                if (::chmod(ip.c_str(), serverGlobalParams.unixSocketPermissions) == -1) {
+                    error() << "Failed to chmod socket file " << ip << " "
+                            << errnoWithDescription(errno);
+                    fassertFailedNoTrace(50715);
+                }
+            }
+
+            if (_listenerOptions.port == 0 &&
+                (addr.getType() == AF_INET || addr.getType() == AF_INET6)) {
+                if (_listenerPort != _listenerOptions.port) {
+                    return Status(ErrorCodes::BadValue,
+                                  "Port 0 (ephemeral port) is not allowed when"
+                                  " listening on multiple IP interfaces");
+                }
+
+                struct sockaddr_storage bound;
+                socklen_t boundLen = sizeof(bound);
+                if (::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &boundLen) != 0) {
+                    return errnoToStatus(errno);
+                }
+                _listenerPort = SockAddr(bound, boundLen).getPort();
+            }
+        }
+    }
+
+    if (_acceptors.empty()) {
+        return Status(ErrorCodes::SocketException, "No available addresses/ports to bind to");
+    }
+
+    return Status::OK();
+}
+
+Status TransportLayerIOUring::start() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _running.store(true);
+
+    for (auto& acceptor : _acceptors) {
+        if (::listen(acceptor.second, serverGlobalParams.listenBacklog) != 0) {
+            return errnoToStatus(errno);
+        }
+
+        const int listenFd = acceptor.second;
+        _acceptorReactor.post([this, listenFd] { _acceptConnections(listenFd); });
+    }
+
+    _listenerThread = stdx::thread([this] {
+        setThreadName("listener");
+        try {
+            _acceptorReactor.run();
+        } catch (...) {
+            severe() << "Uncaught exception in the listener: " << exceptionToStatus();
+            fassertFailed(50716);
+        }
+    });
+
+    log() << "waiting for connections on port " << _listenerPort << " using io_uring";
+
+    return Status::OK();
+}
+
+void TransportLayerIOUring::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _running.store(false);
+
+    // Shutting the listening sockets down completes the accepts in the ring, so no new connections
+    // are opened.
+    for (auto& acceptor : _acceptors) {
+        ::shutdown(acceptor.second, SHUT_RDWR);
+        auto& addr = acceptor.first;
+        if (addr.getType() == AF_UNIX && !addr.isAnonymousUNIXSocket()) {
+            auto path = addr.getAddr();
+            log() << "removing socket file: " << path;
+            if (::unlink(path.c_str()) != 0) {
+                const auto ewd = errnoWithDescription();
+                warning() << "Unable to remove UNIX socket " << path << ": " << ewd;
+            }
+        }
+    }
+
+    // The worker reactors are left to the ServiceExecutor, which may need to keep running them to
+    // drain the open sessions.
+    if (_listenerThread.joinable()) {
+        _acceptorReactor.stop();
+        _listenerThread.join();
+    }
+}
+
+const std::vector<std::shared_ptr<IOUringReactor>>& TransportLayerIOUring::getReactors() {
+    return _workerReactors;
+}
+
+void TransportLayerIOUring::_acceptConnections(int listenFd) {
+    _acceptorReactor.accept(listenFd, true, [this, listenFd](int result, bool more) {
+        if (!_running.load()) {
+            // A connection accepted while shutting down has no session to own its descriptor
+            if (result >= 0) {
+                ::close(result);
+            }
+            return;
+        }
+
+        if (result < 0) {
+            log() << "Error accepting new connection: " << errnoWithDescription(-result);
+        } else {
+            auto& reactor = _workerReactors[_nextWorkerReactor++ % _workerReactors.size()];
+            auto session = std::make_shared<IOUringSession>(this, reactor.get(), result);
+
+            // Start the session from the thread of the reactor it was assigned to, so that the
+            // ServiceExecutor keeps its tasks on that reactor as well.
+            reactor->post([ this, session = std::move(session) ]() mutable {
+                _sep->startSession(std::move(session));
+            });
+        }
+
+        // A multishot accept keeps completing until the kernel ends it, e.g. after an error.
+        if (!more) {
+            _acceptConnections(listenFd);
+        }
+    });
+}
+
+#else
+
+TransportLayerIOUring::TransportLayerIOUring(const TransportLayerIOUring::Options& opts,
+                                             ServiceEntryPoint* sep)
+    : _sep(sep), _listenerOptions(opts) {}
+
+TransportLayerIOUring::~TransportLayerIOUring() = default;
+
+Status TransportLayerIOUring::setup() {
+    return {ErrorCodes::IllegalOperation, "This server was built without io_uring support"};
+}
+
+Status TransportLayerIOUring::start() {
+    MONGO_UNREACHABLE;
+}
+
+void TransportLayerIOUring::shutdown() {}
+
+const std::vector<std::shared_ptr<IOUringReactor>>& TransportLayerIOUring::getReactors() {
+    return _workerReactors;
+}
+
+void TransportLayerIOUring::_acceptConnections(int listenFd) {
+    MONGO_UNREACHABLE;
+}
+
+#endif  // MONGO_CONFIG_HAVE_IO_URING
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/io_uring_reactor.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/util/net/sockaddr.h"
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+/**
+ * A TransportLayer implementation for Linux based on io_uring, selected with
+ * net.transportLayer: io_uring.
+ *
+ * Accepted connections are distributed round-robin across a set of IOUringReactors, which are
+ * run by ServiceExecutorIOUring. All the network operations of a session are started on, and
+ * complete on, the thread of its reactor, and are submitted to the kernel in batches with the
+ * operations of all the other sessions of that reactor. Accepting is done by a multishot accept
+ * on a separate reactor run by the listener thread.
+ *
+ * TLS is not supported, so this transport layer refuses to start if SSL is enabled.
+ */
+class TransportLayerIOUring final : public TransportLayer {
+    MONGO_DISALLOW_COPYING(TransportLayerIOUring);
+
+public:
+    struct Options {
+        explicit Options(const ServerGlobalParams* params);
+        Options() = default;
+
+        int port = ServerGlobalParams::DefaultDBPort;  // port to bind to
+        std::string ipList;                            // addresses to bind to
+        bool useUnixSockets = true;                    // whether to allow UNIX sockets in ipList
+        bool enableIPv6 = false;                       // whether to allow IPv6 sockets in ipList
+        size_t numReactors = 1;    // number of reactors to distribute accepted sockets across
+        unsigned ringEntries = 4096;  // size of the submission queue of each reactor
+    };
+
+    TransportLayerIOUring(const Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerIOUring();
+
+    Status setup() final;
+    Status start() final;
+
+    void shutdown() final;
+
+    /**
+     * Returns the reactors accepted sockets are distributed across. They must be run by the
+     * ServiceExecutor.
+     */
+    const std::vector<std::shared_ptr<IOUringReactor>>& getReactors();
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class IOUringSession;
+
+    void _acceptConnections(int listenFd);
+
+    stdx::mutex _mutex;
+
+    std::vector<std::shared_ptr<IOUringReactor>> _workerReactors;
+
+    // Only accessed by the listener thread
+    size_t _nextWorkerReactor = 0;
+
+    IOUringReactor _acceptorReactor;
+
+    // Listening sockets and the addresses they are bound to
+    std::vector<std::pair<SockAddr, int>> _acceptors;
+
+    stdx::thread _listenerThread;
+
+    ServiceEntryPoint* const _sep = nullptr;
+    AtomicWord<bool> _running{false};
+    Options _listenerOptions;
+    // The real incoming port in case of _listenerOptions.port==0 (ephemeral).
+    int _listenerPort = 0;
+};
+
+}  // namespace transport
+}  // namespace mongo
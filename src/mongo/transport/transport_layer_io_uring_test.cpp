@@ -0,0 +1,368 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include <boost/optional.hpp>
+
+#include "mongo/config.h"
+#include "mongo/db/server_options.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/sock.h"
+
+namespace mongo {
+namespace {
+
+using transport::IOUringReactor;
+using transport::TransportLayerIOUring;
+
+/**
+ * Keeps the sessions started by the transport layer, along with the index of the worker reactor
+ * whose thread started each of them, or -1 if none did.
+ */
+class ServiceEntryPointUtil : public ServiceEntryPoint {
+public:
+    void startSession(transport::SessionHandle session) override {
+        int startedOn = -1;
+        for (size_t i = 0; i < _reactors.size(); ++i) {
+            if (_reactors[i]->isRunningInThisThread()) {
+                startedOn = static_cast<int>(i);
+            }
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _sessions.push_back(std::move(session));
+        _startedOn.push_back(startedOn);
+        _cv.notify_all();
+    }
+
+    void endAllSessions(transport::Session::TagMask tags) override {
+        std::vector<transport::SessionHandle> oldSessions;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            oldSessions.swap(_sessions);
+        }
+        oldSessions.clear();
+    }
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _sessions.size();
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    void setReactors(std::vector<std::shared_ptr<IOUringReactor>> reactors) {
+        _reactors = std::move(reactors);
+    }
+
+    transport::SessionHandle waitForSession(size_t index) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _sessions.size() > index; });
+        return _sessions[index];
+    }
+
+    std::vector<int> startedOn() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _startedOn;
+    }
+
+private:
+    std::vector<std::shared_ptr<IOUringReactor>> _reactors;
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::vector<transport::SessionHandle> _sessions;
+    std::vector<int> _startedOn;
+};
+
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+
+/**
+ * Starts a transport layer listening on an ephemeral port, with two worker reactors run on
+ * separate threads in place of ServiceExecutorIOUring. Tests are skipped if the kernel does not
+ * support io_uring.
+ */
+class TransportLayerIOUringTest : public unittest::Test {
+public:
+    void setUp() override {
+        IOUringReactor probe;
+        auto status = probe.init(8);
+        if (!status.isOK()) {
+            log() << "Skipping test, io_uring is not available: " << status;
+            return;
+        }
+        available = true;
+
+        ServerGlobalParams params;
+        params.noUnixSocket = true;
+        TransportLayerIOUring::Options opts(&params);
+        opts.port = 0;
+        opts.numReactors = 2;
+        opts.ringEntries = 64;
+
+        tl = stdx::make_unique<TransportLayerIOUring>(opts, &sep);
+        sep.setReactors(tl->getReactors());
+        ASSERT_OK(tl->setup());
+        ASSERT_OK(tl->start());
+
+        for (const auto& reactor : tl->getReactors()) {
+            workers.emplace_back([reactor] { reactor->run(); });
+        }
+    }
+
+    void tearDown() override {
+        if (!available) {
+            return;
+        }
+
+        sep.endAllSessions({});
+        tl->shutdown();
+
+        for (const auto& reactor : tl->getReactors()) {
+            reactor->stop();
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        // Releases the operations still pending on the reactors, and the sessions they refer to
+        tl.reset();
+    }
+
+    SockAddr listenAddr() {
+        return SockAddr("localhost", tl->listenerPort(), AF_INET);
+    }
+
+    ServiceEntryPointUtil sep;
+    std::unique_ptr<TransportLayerIOUring> tl;
+    std::vector<stdx::thread> workers;
+    bool available = false;
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+};
+
+/**
+ * Returns a message with a body of 'bodySize' bytes.
+ */
+Message makeMessage(size_t bodySize) {
+    const std::string body(bodySize, 'x');
+    Message message;
+    message.setData(dbQuery, body.data(), body.size());
+    return message;
+}
+
+/**
+ * Receives a whole message from the specified socket and returns its size.
+ */
+int recvMessageSize(Socket* socket) {
+    char header[sizeof(MSGHEADER::Value)];
+    socket->recv(header, sizeof(header));
+    const int size = MSGHEADER::ConstView(header).getMessageLength();
+    std::string body(size - sizeof(header), '\0');
+    socket->recv(&body[0], body.size());
+    return size;
+}
+
+TEST_F(TransportLayerIOUringTest, AcceptedSessionsStartOnTheirReactors) {
+    if (!available)
+        return;
+
+    ASSERT_GT(tl->listenerPort(), 0);
+
+    // The sockets are distributed round-robin, so each session belongs to a different reactor
+    auto sa = listenAddr();
+    Socket first;
+    ASSERT(first.connect(sa));
+    Socket second;
+    ASSERT(second.connect(sa));
+
+    sep.waitForSession(1);
+    const auto startedOn = sep.startedOn();
+    ASSERT_EQ(2U, startedOn.size());
+    ASSERT_GTE(startedOn[0], 0);
+    ASSERT_GTE(startedOn[1], 0);
+    ASSERT_NE(startedOn[0], startedOn[1]);
+}
+
+TEST_F(TransportLayerIOUringTest, SourceAndSinkMessages) {
+    if (!available)
+        return;
+
+    auto sa = listenAddr();
+    Socket socket;
+    ASSERT(socket.connect(sa));
+    auto session = sep.waitForSession(0);
+
+    auto request = makeMessage(100);
+    socket.send(request.buf(), request.size(), "request");
+    auto swMessage = session->sourceMessage();
+    ASSERT_OK(swMessage.getStatus());
+    ASSERT_EQ(request.size(), swMessage.getValue().size());
+
+    ASSERT_OK(session->sinkMessage(makeMessage(200)));
+    ASSERT_EQ(makeMessage(200).size(), recvMessageSize(&socket));
+
+    // The asynchronous versions complete on the session's reactor. The large message is received
+    // with more than one recv.
+    boost::optional<StatusWith<Message>> asyncMessage;
+    session->asyncSourceMessage([&](StatusWith<Message> swMessage) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        asyncMessage = std::move(swMessage);
+        cv.notify_all();
+    });
+
+    auto largeRequest = makeMessage(1024 * 1024);
+    socket.send(largeRequest.buf(), largeRequest.size(), "largeRequest");
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return static_cast<bool>(asyncMessage); });
+    }
+    ASSERT_OK(asyncMessage->getStatus());
+    ASSERT_EQ(largeRequest.size(), asyncMessage->getValue().size());
+
+    boost::optional<Status> sinkStatus;
+    session->asyncSinkMessage(makeMessage(300), [&](Status status) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        sinkStatus = std::move(status);
+        cv.notify_all();
+    });
+    ASSERT_EQ(makeMessage(300).size(), recvMessageSize(&socket));
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return static_cast<bool>(sinkStatus); });
+    }
+    ASSERT_OK(*sinkStatus);
+}
+
+TEST_F(TransportLayerIOUringTest, EndingSessionCompletesPendingSource) {
+    if (!available)
+        return;
+
+    auto sa = listenAddr();
+    Socket socket;
+    ASSERT(socket.connect(sa));
+    auto session = sep.waitForSession(0);
+
+    boost::optional<Status> sourceStatus;
+    session->asyncSourceMessage([&](StatusWith<Message> swMessage) {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        sourceStatus = swMessage.getStatus();
+        cv.notify_all();
+    });
+
+    session->end();
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return static_cast<bool>(sourceStatus); });
+    }
+    ASSERT_NOT_OK(*sourceStatus);
+}
+
+TEST_F(TransportLayerIOUringTest, ShutdownStopsAccepting) {
+    if (!available)
+        return;
+
+    auto sa = listenAddr();
+    Socket before;
+    ASSERT(before.connect(sa));
+    sep.waitForSession(0);
+
+    tl->shutdown();
+
+    Socket after;
+    ASSERT_FALSE(after.connect(sa));
+    ASSERT_EQ(1U, sep.numOpenSessions());
+}
+
+TEST_F(TransportLayerIOUringTest, PendingOperationsAreReleasedWithTheReactors) {
+    if (!available)
+        return;
+
+    auto sa = listenAddr();
+    Socket socket;
+    ASSERT(socket.connect(sa));
+    std::weak_ptr<transport::Session> weakSession = sep.waitForSession(0);
+
+    bool sourced = false;
+    weakSession.lock()->asyncSourceMessage([&](StatusWith<Message>) { sourced = true; });
+    sep.endAllSessions({});
+
+    // The receive in the ring keeps the session alive until the reactors are destroyed, which
+    // cancels it without running its handler
+    ASSERT_FALSE(weakSession.expired());
+    tearDown();
+    available = false;
+    ASSERT_TRUE(weakSession.expired());
+    ASSERT_FALSE(sourced);
+}
+
+#endif  // MONGO_CONFIG_HAVE_IO_URING
+
+TEST(TransportLayerIOUring, SetupFailsOnlyWithoutKernelOrBuildSupport) {
+    ServiceEntryPointUtil sep;
+    ServerGlobalParams params;
+    params.noUnixSocket = true;
+    TransportLayerIOUring::Options opts(&params);
+    opts.port = 0;
+
+    TransportLayerIOUring tl(opts, &sep);
+    auto status = tl.setup();
+#ifndef MONGO_CONFIG_HAVE_IO_URING
+    ASSERT_EQ(ErrorCodes::IllegalOperation, status);
+#else
+    if (!status.isOK()) {
+        ASSERT_EQ(ErrorCodes::InternalError, status);
+    }
+#endif
+}
+
+}  // namespace
+}  // namespace mongo
@@ -31,13 +31,17 @@
 #include "mongo/transport/transport_layer_manager.h"
 
 #include "mongo/base/status.h"
+#include "mongo/config.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_io_uring.h"
+#include "mongo/transport/service_executor_pinned.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_io_uring.h"
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 #include <limits>
@@ -104,9 +108,28 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     std::unique_ptr<TransportLayer> transportLayer;
     auto sep = ctx->getServiceEntryPoint();
 
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+    // The io_uring transport layer comes with its own ServiceExecutor, which runs its reactors.
+    if (config->transportLayer == "io_uring") {
+        transport::TransportLayerIOUring::Options opts(config);
+        opts.numReactors = ServiceExecutorIOUring::getNumReactors();
+
+        auto transportLayerIOUring = stdx::make_unique<transport::TransportLayerIOUring>(opts, sep);
+        ctx->setServiceExecutor(
+            stdx::make_unique<ServiceExecutorIOUring>(ctx, transportLayerIOUring->getReactors()));
+
+        std::vector<std::unique_ptr<TransportLayer>> retVector;
+        retVector.emplace_back(std::move(transportLayerIOUring));
+        return stdx::make_unique<TransportLayerManager>(std::move(retVector));
+    }
+#endif
+
     transport::TransportLayerASIO::Options opts(config);
     if (config->serviceExecutor == "adaptive") {
         opts.transportMode = transport::Mode::kAsynchronous;
+    } else if (config->serviceExecutor == "pinned") {
+        opts.transportMode = transport::Mode::kAsynchronous;
+        opts.numWorkerIOContexts = ServiceExecutorPinned::getNumIOContexts();
     } else if (config->serviceExecutor == "synchronous") {
         opts.transportMode = transport::Mode::kSynchronous;
     } else {
@@ -118,6 +141,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
     if (config->serviceExecutor == "adaptive") {
         ctx->setServiceExecutor(
             stdx::make_unique<ServiceExecutorAdaptive>(ctx, transportLayerASIO->getIOContext()));
+    } else if (config->serviceExecutor == "pinned") {
+        ctx->setServiceExecutor(
+            stdx::make_unique<ServiceExecutorPinned>(ctx, transportLayerASIO->getIOContexts()));
     } else if (config->serviceExecutor == "synchronous") {
         ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
     }
@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+AdaptiveTicketController::AdaptiveTicketController(int initialTickets, Options options)
+    : _options(options), _tickets(_clamp(initialTickets)) {}
+
+int AdaptiveTicketController::_clamp(int tickets) const {
+    return std::max(_options.minTickets, std::min(_options.maxTickets, tickets));
+}
+
+int AdaptiveTicketController::update(const Sample& sample) {
+    if (sample.congested) {
+        // Back off quickly, then climb again from the smaller size once the congestion clears.
+        _tickets = _clamp(static_cast<int>(_tickets * _options.decreaseFactor));
+        _direction = 1;
+        _previousThroughput = -1;
+        return _tickets;
+    }
+
+    if (!sample.saturated) {
+        // The tickets did not limit the work done, so the throughput says nothing about them.
+        _previousThroughput = -1;
+        return _tickets;
+    }
+
+    if (_previousThroughput >= 0) {
+        if (sample.throughput < _previousThroughput * (1 - _options.tolerance)) {
+            // The last step made things worse, so undo it and explore the other way.
+            _direction = -_direction;
+        } else if (sample.throughput <= _previousThroughput * (1 + _options.tolerance)) {
+            _direction = -1;
+        }
+    }
+    _previousThroughput = sample.throughput;
+
+    const int step =
+        std::max(_options.minIncrement, static_cast<int>(_tickets * _options.stepFraction));
+    const int next = _clamp(_tickets + _direction * step);
+    if (next == _tickets) {
+        // At a bound; turn around so that the next step measures something.
+        _direction = -_direction;
+    }
+    _tickets = next;
+    return _tickets;
+}
+
+}  // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+/**
+ * Decides how many tickets a TicketHolder should have from periodic measurements of the work done
+ * by the operations holding them, in the style of TCP congestion control.
+ *
+ * While the system reports congestion, the number of tickets is cut multiplicatively. Otherwise,
+ * if operations had to wait for tickets, the controller climbs the throughput curve additively:
+ * it keeps moving in a direction while throughput improves, turns around when throughput drops,
+ * and moves towards fewer tickets while throughput stays the same, since extra concurrency that
+ * does no extra work only adds contention. It therefore settles near the smallest number of
+ * tickets giving the best throughput. When no operation waits, the tickets are not the limit, and
+ * the number is left alone.
+ */
+class AdaptiveTicketController {
+public:
+    struct Options {
+        int minTickets = 5;
+        int maxTickets = 1024;
+
+        // Each step of the climb adds or removes this fraction of the tickets, but at least
+        // 'minIncrement' tickets. The fraction must be large enough compared to 'tolerance' for a
+        // step to make a measurable difference.
+        double stepFraction = 0.125;
+        int minIncrement = 8;
+
+        // Throughput changes smaller than this fraction are considered noise.
+        double tolerance = 0.05;
+
+        // The fraction of the tickets kept when the system is congested.
+        double decreaseFactor = 0.75;
+    };
+
+    struct Sample {
+        // The work completed per second since the previous sample.
+        double throughput = 0;
+
+        // Whether any operation waited for a ticket since the previous sample.
+        bool saturated = false;
+
+        // Whether the system was overloaded since the previous sample, such that fewer concurrent
+        // operations are needed regardless of throughput.
+        bool congested = false;
+    };
+
+    AdaptiveTicketController(int initialTickets, Options options);
+
+    /**
+     * Returns the number of tickets to use until the next sample, given the measurements taken
+     * with the number returned by the previous call.
+     */
+    int update(const Sample& sample);
+
+    int getTickets() const {
+        return _tickets;
+    }
+
+private:
+    int _clamp(int tickets) const;
+
+    const Options _options;
+    int _tickets;
+
+    // +1 to climb towards more tickets, -1 towards fewer.
+    int _direction = 1;
+
+    // The throughput measured with the previous number of tickets, or negative if there is no
+    // comparable measurement.
+    double _previousThroughput = -1;
+};
+
+}  // namespace mongo
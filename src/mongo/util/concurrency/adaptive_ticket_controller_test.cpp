@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/adaptive_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * A simulated system whose throughput grows linearly with the number of tickets up to 'knee', and
+ * then degrades slowly from contention. Measurements have up to 2% of deterministic noise.
+ */
+class SimulatedSystem {
+public:
+    explicit SimulatedSystem(int knee) : _knee(knee) {}
+
+    double throughput(int tickets) {
+        const double ideal = tickets <= _knee
+            ? 100.0 * tickets
+            : 100.0 * _knee * std::max(0.2, 1 - 0.003 * (tickets - _knee));
+        _seed = _seed * 1103515245 + 12345;
+        return ideal * (0.98 + 0.04 * ((_seed >> 16) % 1000) / 1000.0);
+    }
+
+private:
+    const int _knee;
+    unsigned _seed = 1;
+};
+
+/**
+ * Runs the controller against a saturated system with the given knee, and asserts that after
+ * converging it stays within a band around the knee.
+ */
+void assertConvergesToKnee(int initialTickets, int knee) {
+    AdaptiveTicketController controller(initialTickets, AdaptiveTicketController::Options());
+    SimulatedSystem system(knee);
+
+    int tickets = controller.getTickets();
+    int lowest = tickets;
+    int highest = tickets;
+    for (int i = 0; i < 200; i++) {
+        AdaptiveTicketController::Sample sample;
+        sample.throughput = system.throughput(tickets);
+        sample.saturated = true;
+        tickets = controller.update(sample);
+
+        if (i == 150) {
+            lowest = highest = tickets;
+        }
+        lowest = std::min(lowest, tickets);
+        highest = std::max(highest, tickets);
+    }
+
+    const int band = std::max(16, knee / 4);
+    ASSERT_GTE(lowest, knee - band) << "initial: " << initialTickets << ", knee: " << knee;
+    ASSERT_LTE(highest, knee + band) << "initial: " << initialTickets << ", knee: " << knee;
+}
+
+TEST(AdaptiveTicketControllerTest, ConvergesToTheKneeOfTheThroughputCurve) {
+    for (int knee : {40, 100, 400}) {
+        for (int initialTickets : {8, 128, 1024}) {
+            assertConvergesToKnee(initialTickets, knee);
+        }
+    }
+}
+
+TEST(AdaptiveTicketControllerTest, DecreasesMultiplicativelyWhenCongested) {
+    AdaptiveTicketController controller(128, AdaptiveTicketController::Options());
+    AdaptiveTicketController::Sample sample;
+    sample.throughput = 1000;
+    sample.saturated = true;
+    sample.congested = true;
+    ASSERT_EQ(96, controller.update(sample));
+    ASSERT_EQ(72, controller.update(sample));
+
+    for (int i = 0; i < 20; i++) {
+        controller.update(sample);
+    }
+    ASSERT_EQ(5, controller.getTickets());
+
+    // Once the congestion clears, the controller climbs again.
+    sample.congested = false;
+    ASSERT_EQ(13, controller.update(sample));
+}
+
+TEST(AdaptiveTicketControllerTest, KeepsTheTicketsWhenNotSaturated) {
+    AdaptiveTicketController controller(128, AdaptiveTicketController::Options());
+    AdaptiveTicketController::Sample sample;
+    sample.throughput = 1000;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQ(128, controller.update(sample));
+    }
+}
+
+TEST(AdaptiveTicketControllerTest, StaysWithinTheBounds) {
+    AdaptiveTicketController::Options options;
+    options.minTickets = 20;
+    options.maxTickets = 60;
+    AdaptiveTicketController controller(1000, options);
+    ASSERT_EQ(60, controller.getTickets());
+
+    // Throughput which always improves pushes the controller to the maximum, and no further.
+    AdaptiveTicketController::Sample sample;
+    sample.saturated = true;
+    for (int i = 0; i < 20; i++) {
+        sample.throughput = 1000.0 * (i + 1);
+        const int tickets = controller.update(sample);
+        ASSERT_GTE(tickets, 20);
+        ASSERT_LTE(tickets, 60);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/new.h"
+
+namespace mongo {
+
+/**
+ * Number of stripes in per-CPU striped data such as StripedCounters.
+ */
+constexpr size_t kNumCounterStripes = 32;
+
+/**
+ * Returns the stripe in [0, kNumCounterStripes) that the calling thread should update. On Linux
+ * this follows the CPU the thread is running on, so that threads on different CPUs write to
+ * different cache lines. Elsewhere each thread sticks to a stripe assigned round-robin.
+ */
+size_t getCounterStripe();
+
+/**
+ * A fixed set of 64-bit counters which are split into per-CPU stripes. Adding to a counter only
+ * touches the calling CPU's stripe, and reading it adds up all stripes. A read concurrent with
+ * updates may miss some of them, but never sees a torn value.
+ */
+template <size_t NumCounters>
+class StripedCounters {
+public:
+    void add(size_t counter, int64_t n) {
+        _stripes[getCounterStripe()].values[counter].fetchAndAdd(n);
+    }
+
+    int64_t get(size_t counter) const {
+        int64_t sum = 0;
+        for (const auto& stripe : _stripes) {
+            sum += stripe.values[counter].loadRelaxed();
+        }
+        return sum;
+    }
+
+private:
+    struct alignas(stdx::hardware_destructive_interference_size) Stripe {
+        std::array<AtomicInt64, NumCounters> values;
+    };
+
+    std::array<Stripe, kNumCounterStripes> _stripes;
+};
+
+}  // namespace mongo
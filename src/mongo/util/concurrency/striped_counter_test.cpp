@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/striped_counter.h"
+
+#include <vector>
+
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(StripedCountersTest, StartsAtZero) {
+    StripedCounters<3> counters;
+    for (size_t i = 0; i < 3; i++) {
+        ASSERT_EQ(0, counters.get(i));
+    }
+}
+
+TEST(StripedCountersTest, CountersAreIndependent) {
+    StripedCounters<3> counters;
+    counters.add(0, 5);
+    counters.add(2, 7);
+    counters.add(2, -2);
+
+    ASSERT_EQ(5, counters.get(0));
+    ASSERT_EQ(0, counters.get(1));
+    ASSERT_EQ(5, counters.get(2));
+}
+
+TEST(StripedCountersTest, AddsFromManyThreads) {
+    const int kThreads = 8;
+    const int kIncrements = 10000;
+
+    StripedCounters<2> counters;
+    std::vector<stdx::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < kIncrements; i++) {
+                counters.add(0, 1);
+                counters.add(1, 2);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(kThreads * kIncrements, counters.get(0));
+    ASSERT_EQ(2 * kThreads * kIncrements, counters.get(1));
+}
+
+TEST(StripedCountersTest, StripeIsInRange) {
+    ASSERT_LT(getCounterStripe(), kNumCounterStripes);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -25,95 +25,160 @@
  *    then also delete it in the license file.
  */
 
-#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
-
 #include "mongo/platform/basic.h"
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
-
-#include "mongo/util/log.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
-#if defined(__linux__)
-namespace {
-void _check(int ret) {
-    if (ret == 0)
-        return;
-    int err = errno;
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-}
+constexpr size_t TicketHolder::kNumPartitions;
+constexpr size_t TicketHolder::kNumWaitBuckets;
 
 TicketHolder::TicketHolder(int num) : _outof(num) {
-    _check(sem_init(&_sem, 0, num));
+    const int numPartitions = static_cast<int>(kNumPartitions);
+    for (int i = 0; i < numPartitions; i++) {
+        _partitions[i].value.store(num / numPartitions + (i < num % numPartitions ? 1 : 0));
+    }
 }
 
-TicketHolder::~TicketHolder() {
-    _check(sem_destroy(&_sem));
-}
+TicketHolder::~TicketHolder() = default;
 
-bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        if (errno == EAGAIN)
-            return false;
-        if (errno != EINTR)
-            _check(-1);
+bool TicketHolder::_tryTake(AtomicInt32* counter) {
+    int value = counter->load();
+    while (value > 0) {
+        const int old = counter->compareAndSwap(value, value - 1);
+        if (old == value) {
+            return true;
+        }
+        value = old;
     }
-    return true;
+    return false;
 }
 
-void TicketHolder::waitForTicket() {
-    while (0 != sem_wait(&_sem)) {
-        if (errno != EINTR)
-            _check(-1);
+size_t TicketHolder::_homePartition() {
+    // Threads are spread over the partitions in the order in which they first use any holder.
+    static AtomicUInt32 nextPartition;
+    thread_local const size_t partition = nextPartition.fetchAndAdd(1) % kNumPartitions;
+    return partition;
+}
+
+bool TicketHolder::_tryAcquire(Priority priority) {
+    const size_t home = _homePartition();
+    for (size_t i = 0; i < kNumPartitions; i++) {
+        if (_tryTake(&_partitions[(home + i) % kNumPartitions].value)) {
+            return true;
+        }
     }
+
+    return priority == Priority::kHigh && _tryTake(&_reservedAvailable.value);
+}
+
+bool TicketHolder::tryAcquire(Priority priority) {
+    return _tryAcquire(priority);
+}
+
+void TicketHolder::waitForTicket(Priority priority) {
+    invariant(waitForTicketUntil(Date_t::max(), priority));
 }
 
-bool TicketHolder::waitForTicketUntil(Date_t until) {
-    const long long millisSinceEpoch = until.toMillisSinceEpoch();
-    struct timespec ts;
+bool TicketHolder::waitForTicketUntil(Date_t until, Priority priority) {
+    return _waitForTicketUntil(until, priority, true);
+}
+
+bool TicketHolder::_waitForTicketUntil(Date_t until, Priority priority, bool recordWait) {
+    if (_tryAcquire(priority)) {
+        return true;
+    }
 
-    ts.tv_sec = millisSinceEpoch / 1000;
-    ts.tv_nsec = (millisSinceEpoch % 1000) * (1000 * 1000);
-    while (0 != sem_timedwait(&_sem, &ts)) {
-        if (errno == ETIMEDOUT)
-            return false;
+    const auto startMicros = curTimeMicros64();
+    auto& waiters = priority == Priority::kHigh ? _numHighPriorityWaiters : _numWaiters;
+    auto& newTicket = priority == Priority::kHigh ? _newHighPriorityTicket : _newTicket;
 
-        if (errno != EINTR)
-            _check(-1);
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    waiters.fetchAndAdd(1);
+    bool acquired;
+    if (until == Date_t::max()) {
+        newTicket.wait(lk, [&] { return _tryAcquire(priority); });
+        acquired = true;
+    } else {
+        acquired = newTicket.wait_until(
+            lk, until.toSystemTimePoint(), [&] { return _tryAcquire(priority); });
     }
-    return true;
+    waiters.subtractAndFetch(1);
+    lk.unlock();
+
+    if (acquired && recordWait) {
+        _recordWait(startMicros);
+    }
+    return acquired;
 }
 
 void TicketHolder::release() {
-    _check(sem_post(&_sem));
+    _addTicket();
+}
+
+void TicketHolder::_addTicket() {
+    bool addedReserved = false;
+    int reservedAvailable = _reservedAvailable.value.load();
+    while (reservedAvailable < _reserved.load()) {
+        const int old =
+            _reservedAvailable.value.compareAndSwap(reservedAvailable, reservedAvailable + 1);
+        if (old == reservedAvailable) {
+            addedReserved = true;
+            break;
+        }
+        reservedAvailable = old;
+    }
+
+    if (!addedReserved) {
+        _partitions[_homePartition()].value.fetchAndAdd(1);
+    }
+
+    // High priority waiters can use any ticket, and normal priority waiters only unreserved ones.
+    // Both kinds are woken for an unreserved ticket: if only one of them were, and every waiter of
+    // that kind had already been woken, a waiter of the other kind could sleep while it was free.
+    const bool wakeHighPriority = _numHighPriorityWaiters.load() > 0;
+    const bool wakeNormalPriority = !addedReserved && _numWaiters.load() > 0;
+    if (wakeHighPriority || wakeNormalPriority) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (wakeHighPriority) {
+            _newHighPriorityTicket.notify_one();
+        }
+        if (wakeNormalPriority) {
+            _newTicket.notify_one();
+        }
+    }
 }
 
-Status TicketHolder::resize(int newSize) {
+Status TicketHolder::resize(int newSize, Date_t deadline) {
     stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
 
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
                       str::stream() << "Minimum value for semaphore is 5; given " << newSize);
 
-    if (newSize > SEM_VALUE_MAX)
+    if (newSize <= _reserved.load())
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given "
-                                    << newSize);
+                      str::stream() << "New size " << newSize
+                                    << " must be greater than the number of reserved tickets "
+                                    << _reserved.load());
 
     while (_outof.load() < newSize) {
-        release();
+        _addTicket();
         _outof.fetchAndAdd(1);
     }
 
     while (_outof.load() > newSize) {
-        waitForTicket();
+        if (!_waitForTicketUntil(deadline, Priority::kHigh, false)) {
+            return Status(ErrorCodes::ExceededTimeLimit,
+                          str::stream() << "Timed out shrinking to " << newSize
+                                        << " tickets, the holder still has "
+                                        << _outof.load());
+        }
         _outof.subtractAndFetch(1);
     }
 
@@ -121,96 +186,97 @@ Status TicketHolder::resize(int newSize) {
     return Status::OK();
 }
 
-int TicketHolder::available() const {
-    int val = 0;
-    _check(sem_getvalue(&_sem, &val));
-    return val;
-}
-
-int TicketHolder::used() const {
-    return outof() - available();
-}
-
-int TicketHolder::outof() const {
-    return _outof.load();
-}
-
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
-
-TicketHolder::~TicketHolder() = default;
+Status TicketHolder::setReserved(int newReserved) {
+    stdx::lock_guard<stdx::mutex> lk(_resizeMutex);
 
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
-}
+    if (newReserved < 0 || newReserved >= _outof.load())
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "The number of reserved tickets must be at least 0 and less "
+                                       "than the total number of tickets "
+                                    << _outof.load()
+                                    << "; given "
+                                    << newReserved);
 
-void TicketHolder::waitForTicket() {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _reserved.store(newReserved);
 
-    while (!_tryAcquire()) {
-        _newTicket.wait(lk);
+    // Move the available tickets between the reserved tickets and the others. Tickets which are in
+    // use move when they are released.
+    while (_reservedAvailable.value.load() < newReserved && _tryAcquire(Priority::kNormal)) {
+        _reservedAvailable.value.fetchAndAdd(1);
     }
-}
-
-bool TicketHolder::waitForTicketUntil(Date_t until) {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    return _newTicket.wait_until(lk, until.toSystemTimePoint(), [this] { return _tryAcquire(); });
-}
-
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
+    bool movedToPartitions = false;
+    while (_reservedAvailable.value.load() > newReserved && _tryTake(&_reservedAvailable.value)) {
+        _partitions[_homePartition()].value.fetchAndAdd(1);
+        movedToPartitions = true;
     }
-    _newTicket.notify_one();
-}
-
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+    if (movedToPartitions) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _newTicket.notify_all();
     }
-
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
     return Status::OK();
 }
 
 int TicketHolder::available() const {
-    return _num;
+    int val = _reservedAvailable.value.load();
+    for (auto&& partition : _partitions) {
+        val += partition.value.load();
+    }
+    return val;
 }
 
 int TicketHolder::used() const {
-    return outof() - _num;
+    return outof() - available();
 }
 
 int TicketHolder::outof() const {
     return _outof.load();
 }
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
+int TicketHolder::reserved() const {
+    return _reserved.load();
+}
+
+long long TicketHolder::numWaits() const {
+    long long count = 0;
+    for (auto&& bucket : _waitHistogram) {
+        count += static_cast<long long>(bucket.load());
+    }
+    return count;
+}
+
+void TicketHolder::_recordWait(unsigned long long startMicros) {
+    const unsigned long long micros = curTimeMicros64() - startMicros;
+    size_t bucket = 0;
+    while (bucket + 1 < kNumWaitBuckets && (micros >> (bucket + 1)) != 0) {
+        bucket++;
     }
-    _num--;
-    return true;
+    _waitHistogram[bucket].fetchAndAdd(1);
+    _totalWaitMicros.fetchAndAdd(micros);
 }
-#endif
+
+void TicketHolder::appendStats(BSONObjBuilder* builder) const {
+    builder->append("out", used());
+    builder->append("available", available());
+    builder->append("totalTickets", outof());
+    builder->append("reserved", reserved());
+
+    BSONObjBuilder waitsBuilder(builder->subobjStart("waits"));
+    BSONArrayBuilder histogramBuilder(waitsBuilder.subarrayStart("histogram"));
+    for (size_t i = 0; i < kNumWaitBuckets; i++) {
+        const long long bucketCount = static_cast<long long>(_waitHistogram[i].load());
+        if (bucketCount == 0) {
+            continue;
+        }
+        BSONObjBuilder entryBuilder(histogramBuilder.subobjStart());
+        entryBuilder.append("micros", i == 0 ? 0LL : 1LL << i);
+        entryBuilder.append("count", bucketCount);
+        entryBuilder.doneFast();
+    }
+    histogramBuilder.doneFast();
+    waitsBuilder.append("count", numWaits());
+    waitsBuilder.append("totalMicros", static_cast<long long>(_totalWaitMicros.load()));
+    waitsBuilder.doneFast();
 }
+
+}  // namespace mongo
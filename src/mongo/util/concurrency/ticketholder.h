@@ -26,34 +26,62 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <array>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * A counting semaphore which limits how many operations may run at once.
+ *
+ * The available tickets are spread over several partitions, each on its own cache line. Each
+ * thread takes and returns tickets through a home partition, and only takes tickets from the other
+ * partitions when its own is empty, so that threads on different cores do not contend on one
+ * counter. Threads which find no ticket wait on a condition variable.
+ *
+ * Some of the tickets may be reserved for high priority operations. Normal priority operations
+ * can only use the rest, so that a burst of long operations cannot take every ticket and starve
+ * short ones. A released ticket refills the reserved tickets before the others.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
 public:
+    enum class Priority { kNormal, kHigh };
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
-    bool tryAcquire();
+    bool tryAcquire(Priority priority = Priority::kNormal);
 
-    void waitForTicket();
+    void waitForTicket(Priority priority = Priority::kNormal);
 
-    bool waitForTicketUntil(Date_t until);
+    bool waitForTicketUntil(Date_t until, Priority priority = Priority::kNormal);
 
     void release();
 
-    Status resize(int newSize);
+    /**
+     * Changes the number of tickets to 'newSize'. Shrinking takes the tickets it removes back as
+     * they are released, and gives up with ExceededTimeLimit once 'deadline' passes, keeping the
+     * tickets it removed until then.
+     */
+    Status resize(int newSize, Date_t deadline = Date_t::max());
+
+    /**
+     * Sets the number of tickets which only high priority operations may use. It must be less than
+     * outof().
+     */
+    Status setReserved(int newReserved);
 
     int available() const;
 
@@ -61,21 +89,75 @@ public:
 
     int outof() const;
 
+    int reserved() const;
+
+    /**
+     * Returns the number of acquisitions which had to wait for a ticket.
+     */
+    long long numWaits() const;
+
+    /**
+     * Appends the ticket counts, and a histogram of how long acquisitions which had to wait for a
+     * ticket waited.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    static constexpr size_t kNumPartitions = 16;
+
+    // Bucket 'i' counts the waits which took between 2^i and 2^(i+1) microseconds, except for the
+    // first, which also counts shorter waits, and the last, which also counts longer ones.
+    static constexpr size_t kNumWaitBuckets = 24;
 
-    // You can read _outof without a lock, but have to hold _resizeMutex to change.
+    // This alignment is a best effort approach to ensure that each counter falls on a separate
+    // cache line in order to avoid false sharing.
+    struct alignas(stdx::hardware_destructive_interference_size) AlignedCounter {
+        AtomicInt32 value;
+    };
+
+    static bool _tryTake(AtomicInt32* counter);
+
+    /**
+     * Returns the index of the partition through which the calling thread takes and returns
+     * tickets.
+     */
+    static size_t _homePartition();
+
+    bool _tryAcquire(Priority priority);
+
+    /**
+     * Implements waitForTicketUntil(). Only waits with 'recordWait' set are counted by numWaits()
+     * and the wait histogram, so that tickets taken back by resize() are not reported as waits.
+     */
+    bool _waitForTicketUntil(Date_t until, Priority priority, bool recordWait);
+
+    /**
+     * Adds a ticket to the reserved tickets if they are below their number, or else to the
+     * partition of the calling thread, and wakes a waiter which can use it.
+     */
+    void _addTicket();
+
+    void _recordWait(unsigned long long startMicros);
+
+    std::array<AlignedCounter, kNumPartitions> _partitions;
+    AlignedCounter _reservedAvailable;
+
+    // You can read _outof and _reserved without a lock, but have to hold _resizeMutex to change
+    // them.
     AtomicInt32 _outof;
+    AtomicInt32 _reserved;
     stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
 
-    AtomicInt32 _outof;
-    int _num;
+    // Waiters register themselves under '_mutex' before their last attempt to take a ticket, and
+    // the tickets are added to before the waiters are checked, so no wakeup is missed.
     stdx::mutex _mutex;
     stdx::condition_variable _newTicket;
-#endif
+    stdx::condition_variable _newHighPriorityTicket;
+    AtomicInt32 _numWaiters;
+    AtomicInt32 _numHighPriorityWaiters;
+
+    std::array<AtomicUInt64, kNumWaitBuckets> _waitHistogram;
+    AtomicUInt64 _totalWaitMicros;
 };
 
 class ScopedTicket {
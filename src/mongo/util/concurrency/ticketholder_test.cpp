@@ -31,6 +31,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -71,4 +74,139 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, ReservedTicketsAreOnlyForHighPriority) {
+    TicketHolder holder(5);
+    ASSERT_OK(holder.setReserved(2));
+    ASSERT_EQ(holder.reserved(), 2);
+    ASSERT_EQ(holder.available(), 5);
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+    ASSERT_FALSE(holder.tryAcquire());
+    ASSERT_FALSE(holder.waitForTicketUntil(Date_t::now() + Milliseconds(1)));
+    ASSERT_EQ(holder.available(), 2);
+
+    ASSERT(holder.tryAcquire(TicketHolder::Priority::kHigh));
+    ASSERT(holder.waitForTicketUntil(Date_t::now(), TicketHolder::Priority::kHigh));
+    ASSERT_FALSE(holder.tryAcquire(TicketHolder::Priority::kHigh));
+    ASSERT_EQ(holder.used(), 5);
+
+    // Released tickets refill the reserved tickets first.
+    holder.release();
+    ASSERT_FALSE(holder.tryAcquire());
+    holder.release();
+    ASSERT_FALSE(holder.tryAcquire());
+    holder.release();
+    ASSERT(holder.tryAcquire());
+    holder.release();
+
+    holder.release();
+    holder.release();
+    ASSERT_EQ(holder.available(), 5);
+}
+
+TEST(TicketholderTest, SetReservedValidatesTheNumber) {
+    TicketHolder holder(10);
+    ASSERT_NOT_OK(holder.setReserved(-1));
+    ASSERT_NOT_OK(holder.setReserved(10));
+    ASSERT_OK(holder.setReserved(8));
+    ASSERT_NOT_OK(holder.resize(8));
+    ASSERT_OK(holder.setReserved(0));
+    ASSERT_EQ(holder.available(), 10);
+}
+
+TEST(TicketholderTest, ResizeAddsAndRemovesTickets) {
+    TicketHolder holder(5);
+    ASSERT_OK(holder.resize(40));
+    ASSERT_EQ(holder.outof(), 40);
+    ASSERT_EQ(holder.available(), 40);
+
+    for (int i = 0; i < 40; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+    ASSERT_FALSE(holder.tryAcquire());
+    for (int i = 0; i < 40; i++) {
+        holder.release();
+    }
+
+    ASSERT_OK(holder.resize(6));
+    ASSERT_EQ(holder.outof(), 6);
+    ASSERT_EQ(holder.available(), 6);
+    ASSERT_NOT_OK(holder.resize(4));
+}
+
+TEST(TicketholderTest, ShrinkingStopsAtTheDeadline) {
+    TicketHolder holder(10);
+    for (int i = 0; i < 8; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    // Only the available tickets can be removed before the deadline
+    ASSERT_EQ(ErrorCodes::ExceededTimeLimit,
+              holder.resize(5, Date_t::now() + Milliseconds(10)).code());
+    ASSERT_EQ(holder.outof(), 8);
+    ASSERT_EQ(holder.available(), 0);
+
+    for (int i = 0; i < 3; i++) {
+        holder.release();
+    }
+    ASSERT_OK(holder.resize(5, Date_t::now() + Milliseconds(10)));
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 5);
+
+    for (int i = 0; i < 5; i++) {
+        holder.release();
+    }
+}
+
+TEST(TicketholderTest, ShrinkingIsNotCountedAsAWait) {
+    TicketHolder holder(6);
+    for (int i = 0; i < 6; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    stdx::thread releaser([&] {
+        sleepmillis(10);
+        holder.release();
+    });
+    ASSERT_OK(holder.resize(5));
+    releaser.join();
+    ASSERT_EQ(holder.outof(), 5);
+    ASSERT_EQ(holder.used(), 5);
+    ASSERT_EQ(holder.numWaits(), 0);
+
+    for (int i = 0; i < 5; i++) {
+        holder.release();
+    }
+}
+
+TEST(TicketholderTest, WaiterIsWokenByReleaseOnAnotherThread) {
+    TicketHolder holder(5);
+    for (int i = 0; i < 5; i++) {
+        ASSERT(holder.tryAcquire());
+    }
+
+    stdx::thread releaser([&] {
+        sleepmillis(10);
+        holder.release();
+    });
+    holder.waitForTicket();
+    releaser.join();
+    ASSERT_EQ(holder.used(), 5);
+
+    BSONObjBuilder builder;
+    holder.appendStats(&builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQ(stats["out"].numberInt(), 5);
+    ASSERT_EQ(stats["available"].numberInt(), 0);
+    ASSERT_EQ(stats["totalTickets"].numberInt(), 5);
+    ASSERT_EQ(stats["waits"]["count"].numberLong(), 1);
+    ASSERT_GTE(stats["waits"]["totalMicros"].numberLong(), 1);
+
+    for (int i = 0; i < 5; i++) {
+        holder.release();
+    }
+}
 }  // namespace
@@ -64,6 +64,16 @@ ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>
     setDiffieHellmanParameterPEMFile(ServerParameterSet::getGlobal(),
                                      "opensslDiffieHellmanParameters",
                                      &sslGlobalParams.sslPEMTempDHParam);
+
+/**
+ * Configurable via --setParameter opensslSessionResumption=false. If true (default), TLS sessions
+ * are cached for both incoming and outgoing connections so that reconnecting peers can perform an
+ * abbreviated handshake.
+ */
+ExportedServerParameter<bool, ServerParameterType::kStartupOnly>
+    sslSessionResumptionParameter(ServerParameterSet::getGlobal(),
+                                  "opensslSessionResumption",
+                                  &sslGlobalParams.sslSessionResumption);
 }  // namespace
 
 SSLPeerInfo& SSLPeerInfo::forSession(const transport::SessionHandle& session) {
@@ -149,6 +159,9 @@ BSONObj SSLConfiguration::getServerStatusBSON() const {
 
 SSLManagerInterface::~SSLManagerInterface() {}
 
+void SSLManagerInterface::prepareOutgoingSession(SSLConnectionType ssl,
+                                                 const std::string& remoteHost) {}
+
 SSLConnectionInterface::~SSLConnectionInterface() {}
 
 #endif
@@ -191,6 +191,16 @@ public:
      */
     virtual StatusWith<boost::optional<SSLPeerInfo>> parseAndValidatePeerCertificate(
         SSLConnectionType ssl, const std::string& remoteHost) = 0;
+
+    /**
+     * Prepares an outgoing connection to "remoteHost" which has not started its handshake yet. If
+     * a session was negotiated with the same host by an earlier connection, it is offered to the
+     * peer so the handshake can be abbreviated, and any session negotiated on this connection is
+     * remembered for later connections. "ssl" must have been created from a context initialized
+     * by initSSLContext() with ConnectionDirection::kOutgoing. The default implementation does
+     * nothing.
+     */
+    virtual void prepareOutgoingSession(SSLConnectionType ssl, const std::string& remoteHost);
 };
 
 // Access SSL functions through this instance.
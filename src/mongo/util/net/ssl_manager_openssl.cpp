@@ -48,6 +48,8 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/transport/session.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
@@ -322,6 +324,75 @@ using UniqueSSLContext = std::unique_ptr<SSL_CTX, decltype(&free_ssl_context)>;
 static const int BUFFER_SIZE = 8 * 1024;
 static const int DATE_LEN = 128;
 
+namespace {
+struct SSLSessionFree {
+    void operator()(SSL_SESSION* const p) noexcept {
+        if (p) {
+            ::SSL_SESSION_free(p);
+        }
+    }
+};
+using UniqueSSLSession = std::unique_ptr<SSL_SESSION, SSLSessionFree>;
+
+/**
+ * Remembers the most recent TLS session negotiated by outgoing connections to each remote host,
+ * so that reconnecting to a host, e.g. after a failover, can resume that session instead of
+ * performing a full handshake.
+ */
+class ClientSessionCache {
+public:
+    // Bounds the memory used by the cache. New hosts are not cached once the limit is reached.
+    static constexpr size_t kMaxSessions = 4096;
+
+    /**
+     * Offers the session cached for "remoteHost", if any, to the not yet connected "ssl".
+     */
+    void offer(SSL* ssl, const std::string& remoteHost) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _sessions.find(remoteHost);
+        if (it != _sessions.end()) {
+            // SSL_set_session takes its own reference to the session.
+            ::SSL_set_session(ssl, it->second.get());
+        }
+    }
+
+    /**
+     * Takes ownership of "session" and caches it for "remoteHost", replacing any older session.
+     */
+    void put(const std::string& remoteHost, SSL_SESSION* session) {
+        UniqueSSLSession newSession(session);
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _sessions.find(remoteHost);
+        if (it != _sessions.end()) {
+            // Swap so that the old session is freed after the lock is released.
+            it->second.swap(newSession);
+        } else if (_sessions.size() < kMaxSessions) {
+            _sessions.emplace(remoteHost, std::move(newSession));
+        }
+    }
+
+private:
+    stdx::mutex _mutex;
+    stdx::unordered_map<std::string, UniqueSSLSession> _sessions;
+};
+
+/**
+ * Attached to outgoing SSL objects by prepareOutgoingSession() so that the new session callback
+ * knows where to cache the sessions the connection negotiates.
+ */
+struct ClientSessionKey {
+    ClientSessionCache* cache;
+    std::string remoteHost;
+};
+
+// The SSL ex_data index under which the ClientSessionKey for an outgoing connection is stored.
+int clientSessionKeyIndex = -1;
+
+void freeClientSessionKey(void* parent, void* ptr, CRYPTO_EX_DATA* ad, int idx, long, void*) {
+    delete static_cast<ClientSessionKey*>(ptr);
+}
+}  // namespace
+
 class SSLManagerOpenSSL : public SSLManagerInterface {
 public:
     explicit SSLManagerOpenSSL(const SSLParams& params, bool isServer);
@@ -354,6 +425,8 @@ public:
 
     int SSL_shutdown(SSLConnectionInterface* conn) final;
 
+    void prepareOutgoingSession(SSL* ssl, const std::string& remoteHost) final;
+
 private:
     const int _rolesNid = OBJ_create(mongodbRolesOID.identifier.c_str(),
                                      mongodbRolesOID.shortDescription.c_str(),
@@ -363,7 +436,9 @@ private:
     bool _weakValidation;
     bool _allowInvalidCertificates;
     bool _allowInvalidHostnames;
+    bool _sessionResumption;
     SSLConfiguration _sslConfiguration;
+    ClientSessionCache _clientSessions;
 
     /**
      * creates an SSL object to be used for this file descriptor.
@@ -443,6 +518,7 @@ private:
      */
     static int password_cb(char* buf, int num, int rwflag, void* userdata);
     static int verify_cb(int ok, X509_STORE_CTX* ctx);
+    static int new_session_cb(SSL* ssl, SSL_SESSION* session);
 };
 
 void setupFIPS() {
@@ -483,6 +559,12 @@ MONGO_INITIALIZER(SetupOpenSSL)(InitializerContext*) {
     // Setup OpenSSL multithreading callbacks and mutexes
     SSLThreadInfo::init();
 
+    clientSessionKeyIndex =
+        ::SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeClientSessionKey);
+    if (clientSessionKeyIndex < 0) {
+        return Status(ErrorCodes::InternalError, "Failed to allocate SSL ex_data index");
+    }
+
     return Status::OK();
 }
 
@@ -562,7 +644,8 @@ SSLManagerOpenSSL::SSLManagerOpenSSL(const SSLParams& params, bool isServer)
       _clientContext(nullptr, free_ssl_context),
       _weakValidation(params.sslWeakCertificateValidation),
       _allowInvalidCertificates(params.sslAllowInvalidCertificates),
-      _allowInvalidHostnames(params.sslAllowInvalidHostnames) {
+      _allowInvalidHostnames(params.sslAllowInvalidHostnames),
+      _sessionResumption(params.sslSessionResumption) {
     if (!_initSynchronousSSLContext(&_clientContext, params, ConnectionDirection::kOutgoing)) {
         uasserted(16768, "ssl initialization problem");
     }
@@ -619,6 +702,30 @@ int SSLManagerOpenSSL::verify_cb(int ok, X509_STORE_CTX* ctx) {
     return 1;  // always succeed; we will catch the error in our get_verify_result() call
 }
 
+int SSLManagerOpenSSL::new_session_cb(SSL* ssl, SSL_SESSION* session) {
+    auto key = static_cast<ClientSessionKey*>(::SSL_get_ex_data(ssl, clientSessionKeyIndex));
+    if (!key) {
+        return 0;  // The connection was not prepared for resumption; OpenSSL keeps ownership.
+    }
+
+    key->cache->put(key->remoteHost, session);
+    return 1;
+}
+
+void SSLManagerOpenSSL::prepareOutgoingSession(SSL* ssl, const std::string& remoteHost) {
+    if (!_sessionResumption) {
+        return;
+    }
+
+    auto key = stdx::make_unique<ClientSessionKey>(ClientSessionKey{&_clientSessions, remoteHost});
+    if (::SSL_set_ex_data(ssl, clientSessionKeyIndex, key.get()) != 1) {
+        return;
+    }
+    key.release();
+
+    _clientSessions.offer(ssl, remoteHost);
+}
+
 int SSLManagerOpenSSL::SSL_read(SSLConnectionInterface* connInterface, void* buf, int num) {
     int status;
     SSLConnectionOpenSSL* conn = checked_cast<SSLConnectionOpenSSL*>(connInterface);
@@ -701,6 +808,19 @@ Status SSLManagerOpenSSL::initSSLContext(SSL_CTX* context,
                                     << getSSLErrorMessage(ERR_get_error()));
     }
 
+    if (!params.sslSessionResumption) {
+        ::SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_OFF);
+        ::SSL_CTX_set_options(context, SSL_OP_NO_TICKET);
+    } else if (direction == ConnectionDirection::kOutgoing) {
+        // OpenSSL's internal cache is keyed by session id, which a client does not know before
+        // connecting. Outgoing sessions are instead handed to new_session_cb, which caches them by
+        // remote host for prepareOutgoingSession(). Incoming connections use the default server
+        // cache and session tickets.
+        ::SSL_CTX_set_session_cache_mode(context,
+                                         SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        ::SSL_CTX_sess_set_new_cb(context, &SSLManagerOpenSSL::new_session_cb);
+    }
+
     if (direction == ConnectionDirection::kOutgoing && !params.sslClusterFile.empty()) {
         ::EVP_set_pw_prompt("Enter cluster certificate passphrase");
         if (!_setupPEM(context, params.sslClusterFile, params.sslClusterPassword)) {
@@ -1192,6 +1312,9 @@ SSLConnectionInterface* SSLManagerOpenSSL::connect(Socket* socket) {
     if (ret != 1)
         _handleSSLError(SSL_get_error(sslConn.get()->ssl, ret), ret);
 
+    prepareOutgoingSession(sslConn->ssl,
+                           str::stream() << undotted << ':' << socket->remoteAddr().getPort());
+
     do {
         ret = ::SSL_connect(sslConn->ssl);
     } while (!_doneWithSSLOp(sslConn.get(), ret));
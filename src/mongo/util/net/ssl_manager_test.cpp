@@ -35,6 +35,7 @@
 #include "mongo/config.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/ssl_options.h"
 
 
 namespace mongo {
@@ -83,5 +84,106 @@ TEST(SSLManager, matchHostname) {
     ASSERT_FALSE(failure);
 #endif
 }
+
+#if defined(MONGO_CONFIG_SSL) && MONGO_CONFIG_SSL_PROVIDER == SSL_PROVIDER_OPENSSL
+struct SSLFree {
+    void operator()(SSL* const ssl) noexcept {
+        ::SSL_free(ssl);
+    }
+};
+using UniqueSSL = std::unique_ptr<SSL, SSLFree>;
+
+struct SSLContextFree {
+    void operator()(SSL_CTX* const context) noexcept {
+        ::SSL_CTX_free(context);
+    }
+};
+using UniqueSSLContext = std::unique_ptr<SSL_CTX, SSLContextFree>;
+
+/**
+ * Connects clients to a server in memory, using contexts set up by an SSLManager for outgoing
+ * and incoming connections respectively.
+ */
+class SessionResumptionFixture {
+public:
+    explicit SessionResumptionFixture(bool sessionResumption) {
+        SSLParams params;
+        params.sslMode.store(SSLParams::SSLMode_requireSSL);
+        params.sslPEMKeyFile = "jstests/libs/server.pem";
+        params.sslCAFile = "jstests/libs/ca.pem";
+        params.sslSessionResumption = sessionResumption;
+
+        _manager = SSLManagerInterface::create(params, false);
+        ASSERT_OK(_manager->initSSLContext(
+            _clientContext.get(), params, SSLManagerInterface::ConnectionDirection::kOutgoing));
+        ASSERT_OK(_manager->initSSLContext(
+            _serverContext.get(), params, SSLManagerInterface::ConnectionDirection::kIncoming));
+    }
+
+    /**
+     * Completes a handshake between a new outgoing connection to "remoteHost" and a new incoming
+     * connection, closes both cleanly, and returns whether the client resumed a session.
+     */
+    bool connect(const std::string& remoteHost) {
+        UniqueSSL client(::SSL_new(_clientContext.get()));
+        UniqueSSL server(::SSL_new(_serverContext.get()));
+
+        BIO* clientBio;
+        BIO* serverBio;
+        ASSERT_EQ(1, ::BIO_new_bio_pair(&clientBio, 0, &serverBio, 0));
+        ::SSL_set_bio(client.get(), clientBio, clientBio);
+        ::SSL_set_bio(server.get(), serverBio, serverBio);
+        ::SSL_set_connect_state(client.get());
+        ::SSL_set_accept_state(server.get());
+
+        _manager->prepareOutgoingSession(client.get(), remoteHost);
+
+        bool clientDone = false;
+        bool serverDone = false;
+        for (int i = 0; i < 100 && !(clientDone && serverDone); ++i) {
+            clientDone = clientDone || ::SSL_do_handshake(client.get()) == 1;
+            serverDone = serverDone || ::SSL_do_handshake(server.get()) == 1;
+        }
+        ASSERT(clientDone && serverDone);
+
+        // With TLS 1.3 the server sends its session tickets after the handshake, and the client
+        // only processes them when it reads
+        char byte = 'x';
+        ASSERT_EQ(1, ::SSL_write(server.get(), &byte, 1));
+        ASSERT_EQ(1, ::SSL_read(client.get(), &byte, 1));
+
+        const bool reused = ::SSL_session_reused(client.get());
+
+        // OpenSSL does not resume sessions of connections which were not shut down
+        ::SSL_shutdown(client.get());
+        ::SSL_shutdown(server.get());
+        return reused;
+    }
+
+private:
+    std::unique_ptr<SSLManagerInterface> _manager;
+    UniqueSSLContext _clientContext{::SSL_CTX_new(::SSLv23_method())};
+    UniqueSSLContext _serverContext{::SSL_CTX_new(::SSLv23_method())};
+};
+
+TEST(SSLManager, OutgoingConnectionsResumeSessionsWithTheSameHost) {
+    SessionResumptionFixture fixture(true);
+
+    ASSERT_FALSE(fixture.connect("host1:27017"));
+    ASSERT_TRUE(fixture.connect("host1:27017"));
+    ASSERT_TRUE(fixture.connect("host1:27017"));
+
+    // Sessions are only offered to the host they were negotiated with
+    ASSERT_FALSE(fixture.connect("host2:27017"));
+    ASSERT_TRUE(fixture.connect("host2:27017"));
+}
+
+TEST(SSLManager, SessionsAreNotResumedWhenSessionResumptionIsOff) {
+    SessionResumptionFixture fixture(false);
+
+    ASSERT_FALSE(fixture.connect("host1:27017"));
+    ASSERT_FALSE(fixture.connect("host1:27017"));
+}
+#endif
 }  // namespace
 }  // namespace mongo
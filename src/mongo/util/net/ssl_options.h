@@ -59,6 +59,7 @@ struct SSLParams {
     bool sslAllowInvalidHostnames = false;        // --sslAllowInvalidHostnames
     bool disableNonSSLConnectionLogging =
         false;  // --setParameter disableNonSSLConnectionLogging=true
+    bool sslSessionResumption = true;  // --setParameter opensslSessionResumption=false
 
     SSLParams() {
         sslMode.store(SSLMode_disabled);
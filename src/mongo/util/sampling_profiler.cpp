@@ -0,0 +1,662 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/sampling_profiler.h"
+
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+#include <cerrno>
+#include <cstring>
+#include <map>
+
+#if !defined(_WIN32)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stacktrace.h"
+
+namespace mongo {
+
+constexpr int SamplingProfiler::kMaxFrames;
+constexpr size_t SamplingProfiler::kMaxOperations;
+constexpr size_t SamplingProfiler::kMaxStacks;
+constexpr size_t SamplingProfiler::kMaxOperationStacks;
+constexpr Microseconds SamplingProfiler::kDefaultSamplingInterval;
+
+namespace {
+
+// Operation ids which are always interned. Samples of threads outside any OperationScope go to
+// kNoOperation, and samples of operations which did not fit in the table go to kOtherOperation.
+const int kNoOperation = 0;
+const int kOtherOperation = 1;
+
+/**
+ * What a thread is working on, as seen by the signal handler. It has a constant initializer and
+ * a trivial destructor, so reading it from the signal handler does not run any TLS setup code.
+ */
+struct ThreadState {
+    int operation;
+    unsigned generation;
+    AtomicWord<long long>* samples;
+};
+
+thread_local ThreadState threadState = {kNoOperation, 0, nullptr};
+
+/**
+ * The operation this thread interned last, so that a thread which keeps running the same kind of
+ * operation takes the profiler's mutex only when that changes. Generations are unique across all
+ * profilers, so an entry is only used by the profiler that interned it, until its next reset().
+ */
+struct InternedOperation {
+    unsigned generation = 0;
+    int operation = kNoOperation;
+    std::string opType;
+    std::string ns;
+};
+
+thread_local InternedOperation lastInternedOperation;
+
+// The next generation handed out to a profiler, on construction and by reset().
+AtomicWord<unsigned> nextGeneration{1};
+
+// The profiler that the SIGPROF handler feeds, if any.
+AtomicWord<SamplingProfiler*> signalTarget{nullptr};
+
+#if !defined(_WIN32)
+void handleProfilingSignal(int signal, siginfo_t* info, void* context) {
+    const int savedErrno = errno;
+    if (auto profiler = signalTarget.load()) {
+        profiler->recordSample(context);
+    }
+    errno = savedErrno;
+}
+
+std::string symbolizeFrame(void* frame) {
+    Dl_info dli;
+    if (dladdr(frame, &dli) && dli.dli_sname) {
+        int status;
+        char* demangled = abi::__cxa_demangle(dli.dli_sname, 0, 0, &status);
+        if (demangled) {
+            // Strip off the function parameters as they are very verbose and not useful.
+            std::string symbol(demangled, strcspn(demangled, "("));
+            free(demangled);
+            return symbol;
+        }
+        return dli.dli_sname;
+    }
+    return str::stream() << frame;
+}
+#else
+std::string symbolizeFrame(void* frame) {
+    return str::stream() << frame;
+}
+#endif
+
+std::string stackName(int stackNum) {
+    return str::stream() << "stack" << stackNum;
+}
+
+/**
+ * Returns the indexes in [0, "size") of the at most "limit" entries with the most samples,
+ * hottest first. Entries without samples are left out.
+ */
+template <typename GetSamples>
+std::vector<int> getHottest(size_t size, size_t limit, GetSamples getSamples) {
+    std::vector<int> hottest;
+    for (size_t i = 0; i < size; ++i) {
+        if (getSamples(i) > 0) {
+            hottest.push_back(static_cast<int>(i));
+        }
+    }
+    std::stable_sort(hottest.begin(), hottest.end(), [&](int a, int b) {
+        return getSamples(a) > getSamples(b);
+    });
+    if (hottest.size() > limit) {
+        hottest.resize(limit);
+    }
+    return hottest;
+}
+
+/**
+ * Adds "hottest" to the entries FTDC keeps emitting. To keep the output within budget, the
+ * entries start over from "hottest" alone when they would grow beyond 2 * "maxEntries".
+ */
+void updateEmitted(std::set<int>* emitted, const std::vector<int>& hottest, size_t maxEntries) {
+    const size_t numNew = std::count_if(
+        hottest.begin(), hottest.end(), [&](int entry) { return !emitted->count(entry); });
+    if (emitted->size() + numNew > 2 * maxEntries) {
+        emitted->clear();
+    }
+    emitted->insert(hottest.begin(), hottest.end());
+}
+
+}  // namespace
+
+/**
+ * A bounded lock-free queue of samples, after Dmitry Vyukov's bounded MPMC queue. Each cell
+ * carries a sequence number which tells whether it is free for the producer at a given position
+ * or holds a sample for the consumer there. Any number of threads and signal handlers may produce
+ * concurrently, but there is a single consumer at a time.
+ */
+class SamplingProfiler::SampleBuffer {
+public:
+    struct Sample {
+        int operation;
+        int numFrames;
+        void* frames[kMaxFrames];
+    };
+
+    explicit SampleBuffer(size_t capacity) : _mask(capacity - 1), _cells(new Cell[capacity]) {
+        invariant(capacity > 0 && (capacity & _mask) == 0);
+        for (size_t i = 0; i < capacity; ++i) {
+            _cells[i].sequence.store(i);
+        }
+    }
+
+    /**
+     * Reserves a cell for a new sample, or returns nullptr if the buffer is full. The sample
+     * must be handed to publish() along with "position" once filled in. Async-signal-safe.
+     */
+    Sample* tryClaim(unsigned long long* position) {
+        auto pos = _enqueuePosition.load();
+        while (true) {
+            Cell& cell = _cells[pos & _mask];
+            const long long diff = static_cast<long long>(cell.sequence.load() - pos);
+            if (diff == 0) {
+                const auto observed = _enqueuePosition.compareAndSwap(pos, pos + 1);
+                if (observed == pos) {
+                    *position = pos;
+                    return &cell.sample;
+                }
+                pos = observed;
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                pos = _enqueuePosition.load();
+            }
+        }
+    }
+
+    void publish(unsigned long long position) {
+        _cells[position & _mask].sequence.store(position + 1);
+    }
+
+    /**
+     * Passes the oldest published sample to "consume" and frees its cell. Returns false if there
+     * is none. Must not be called concurrently with itself.
+     */
+    template <typename Consume>
+    bool tryConsume(Consume consume) {
+        Cell& cell = _cells[_dequeuePosition & _mask];
+        if (cell.sequence.load() != _dequeuePosition + 1) {
+            return false;
+        }
+        consume(cell.sample);
+        cell.sequence.store(_dequeuePosition + _mask + 1);
+        ++_dequeuePosition;
+        return true;
+    }
+
+private:
+    struct Cell {
+        AtomicWord<unsigned long long> sequence;
+        Sample sample;
+    };
+
+    const unsigned long long _mask;
+    std::unique_ptr<Cell[]> _cells;
+    AtomicWord<unsigned long long> _enqueuePosition{0};
+    unsigned long long _dequeuePosition = 0;
+};
+
+SamplingProfiler::OperationScope::OperationScope(SamplingProfiler* profiler,
+                                                 StringData opType,
+                                                 StringData ns,
+                                                 AtomicWord<long long>* samples)
+    : _previousOperation(threadState.operation),
+      _previousGeneration(threadState.generation),
+      _previousSamples(threadState.samples) {
+    int operation = kNoOperation;
+    unsigned generation = 0;
+    if (profiler->isRunning()) {
+        operation = profiler->_internOperation(opType, ns, &generation);
+    }
+
+    threadState.operation = operation;
+    threadState.generation = generation;
+    if (samples) {
+        threadState.samples = samples;
+    }
+}
+
+SamplingProfiler::OperationScope::~OperationScope() {
+    threadState.operation = _previousOperation;
+    threadState.generation = _previousGeneration;
+    threadState.samples = _previousSamples;
+}
+
+SamplingProfiler* SamplingProfiler::get() {
+    static SamplingProfiler* const profiler = new SamplingProfiler();
+    return profiler;
+}
+
+size_t SamplingProfiler::StackHash::operator()(const Stack& stack) const {
+    return boost::hash_range(stack.begin(), stack.end());
+}
+
+SamplingProfiler::SamplingProfiler() : SamplingProfiler(Options()) {}
+
+SamplingProfiler::SamplingProfiler(Options options)
+    : _options(options),
+      _generation(nextGeneration.fetchAndAdd(1)),
+      _operationSamples(kMaxOperations) {
+    _operations.push_back({"none", ""});
+    _operations.push_back({"other", ""});
+}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+}
+
+Status SamplingProfiler::start(Microseconds samplingInterval) {
+#if defined(_WIN32)
+    return {ErrorCodes::CommandNotSupported,
+            "The sampling CPU profiler is not supported on this platform"};
+#else
+    if (samplingInterval <= Microseconds(0)) {
+        return {ErrorCodes::BadValue, "The sampling interval must be positive"};
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_controlMutex);
+    if (isRunning()) {
+        return {ErrorCodes::ConflictingOperationInProgress,
+                "The sampling CPU profiler is already running"};
+    }
+    if (signalTarget.compareAndSwap(nullptr, this) != nullptr) {
+        return {ErrorCodes::ConflictingOperationInProgress,
+                "Another sampling CPU profiler is running"};
+    }
+
+    // The buffer is allocated on first use and kept, as a signal handler may still be using it
+    // right after stop().
+    if (!_buffer) {
+        _buffer = stdx::make_unique<SampleBuffer>(_options.bufferCapacity);
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handleProfilingSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        const int savedErrno = errno;
+        signalTarget.store(nullptr);
+        return {ErrorCodes::InternalError,
+                str::stream() << "Failed to install the SIGPROF handler: "
+                              << errnoWithDescription(savedErrno)};
+    }
+
+    _samplingIntervalMicros.store(durationCount<Microseconds>(samplingInterval));
+    _running.store(true);
+    {
+        stdx::lock_guard<stdx::mutex> drainLock(_mutex);
+        _stopDraining = false;
+    }
+    _drainThread = stdx::thread([this] { _drainLoop(); });
+
+    const long long micros = durationCount<Microseconds>(samplingInterval);
+    struct itimerval timer;
+    timer.it_interval.tv_sec = micros / 1000000;
+    timer.it_interval.tv_usec = micros % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        const int savedErrno = errno;
+        _stop(lk);
+        return {ErrorCodes::InternalError,
+                str::stream() << "Failed to arm the profiling timer: "
+                              << errnoWithDescription(savedErrno)};
+    }
+
+    log() << "Started the sampling CPU profiler, sampling every " << samplingInterval
+          << " of CPU time";
+    return Status::OK();
+#endif
+}
+
+void SamplingProfiler::stop() {
+    stdx::lock_guard<stdx::mutex> lk(_controlMutex);
+    _stop(lk);
+}
+
+void SamplingProfiler::_stop(WithLock) {
+    if (!isRunning()) {
+        return;
+    }
+
+#if !defined(_WIN32)
+    struct itimerval disarmed;
+    memset(&disarmed, 0, sizeof(disarmed));
+    setitimer(ITIMER_PROF, &disarmed, nullptr);
+#endif
+
+    _running.store(false);
+    signalTarget.store(nullptr);
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopDraining = true;
+    }
+    _drainCondition.notify_all();
+    _drainThread.join();
+
+    log() << "Stopped the sampling CPU profiler";
+}
+
+void SamplingProfiler::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    {
+        stdx::lock_guard<stdx::mutex> operationsLock(_operationsMutex);
+        _operations.resize(kOtherOperation + 1);
+        _operationIds.clear();
+        _generation.store(nextGeneration.fetchAndAdd(1));
+    }
+
+    // Throw away what is still buffered, which refers to the forgotten operations.
+    _drain(lk);
+
+    _totalSamples = 0;
+    _untrackedStackSamples = 0;
+    std::fill(_operationSamples.begin(), _operationSamples.end(), 0);
+    _operationStackSamples.clear();
+    _stacks.clear();
+    _stackNums.clear();
+    _ftdcOperations.clear();
+    _ftdcStacks.clear();
+    _droppedSamples.store(0);
+}
+
+void SamplingProfiler::recordSample(void* signalContext) {
+    if (!isRunning()) {
+        return;
+    }
+
+    const ThreadState state = threadState;
+    if (state.samples) {
+        state.samples->fetchAndAdd(1);
+    }
+
+    unsigned long long position;
+    auto sample = _buffer->tryClaim(&position);
+    if (!sample) {
+        _droppedSamples.fetchAndAdd(1);
+        return;
+    }
+
+    // An operation id handed out before the last reset() may since have been reused.
+    const bool current = state.operation == kNoOperation ||
+        state.generation == _generation.loadRelaxed();
+    sample->operation = current ? state.operation : kOtherOperation;
+#if !defined(_WIN32)
+    sample->numFrames = signalContext
+        ? rawBacktraceFromSignalContext(sample->frames, kMaxFrames, signalContext)
+        : rawBacktrace(sample->frames, kMaxFrames);
+#else
+    sample->numFrames = rawBacktrace(sample->frames, kMaxFrames);
+#endif
+    _buffer->publish(position);
+}
+
+int SamplingProfiler::_internOperation(StringData opType, StringData ns, unsigned* generation) {
+    auto& last = lastInternedOperation;
+    *generation = _generation.load();
+    if (last.generation == *generation && StringData(last.opType) == opType &&
+        StringData(last.ns) == ns) {
+        return last.operation;
+    }
+
+    const int operation = [&] {
+        std::string key = str::stream() << opType << '\0' << ns;
+
+        stdx::lock_guard<stdx::mutex> lk(_operationsMutex);
+        *generation = _generation.load();
+
+        auto it = _operationIds.find(key);
+        if (it != _operationIds.end()) {
+            return it->second;
+        }
+        if (_operations.size() >= kMaxOperations) {
+            return kOtherOperation;
+        }
+
+        const int newOperation = _operations.size();
+        _operations.push_back({opType.toString(), ns.toString()});
+        _operationIds.emplace(std::move(key), newOperation);
+        return newOperation;
+    }();
+
+    last.generation = *generation;
+    last.operation = operation;
+    last.opType.assign(opType.rawData(), opType.size());
+    last.ns.assign(ns.rawData(), ns.size());
+    return operation;
+}
+
+SamplingProfiler::OperationInfo SamplingProfiler::_getOperation(int operation) {
+    stdx::lock_guard<stdx::mutex> lk(_operationsMutex);
+    if (operation < 0 || static_cast<size_t>(operation) >= _operations.size()) {
+        operation = kOtherOperation;
+    }
+    return _operations[operation];
+}
+
+void SamplingProfiler::_drainLoop() {
+    setThreadName("SamplingProfiler");
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (!_stopDraining) {
+        _drainCondition.wait_for(
+            lk, _options.drainPeriod.toSystemDuration(), [&] { return _stopDraining; });
+        _drain(lk);
+    }
+}
+
+void SamplingProfiler::_drain(WithLock lk) {
+    if (!_buffer) {
+        return;
+    }
+
+    while (_buffer->tryConsume([&](const SampleBuffer::Sample& sample) {
+        _aggregate(lk, sample.operation, sample.frames, sample.numFrames);
+    })) {
+    }
+}
+
+void SamplingProfiler::_aggregate(WithLock,
+                                  int operation,
+                                  void* const* frames,
+                                  int numFrames) {
+    ++_totalSamples;
+
+    if (operation < 0 || static_cast<size_t>(operation) >= kMaxOperations) {
+        operation = kOtherOperation;
+    }
+    ++_operationSamples[operation];
+
+    Stack stack(frames, frames + std::max(numFrames, 0));
+    auto it = _stackNums.find(stack);
+    if (it == _stackNums.end()) {
+        if (_stacks.size() >= kMaxStacks) {
+            ++_untrackedStackSamples;
+            return;
+        }
+        it = _stackNums.emplace(std::move(stack), static_cast<int>(_stacks.size())).first;
+        _stacks.push_back({&it->first, 0, BSONObj()});
+    }
+
+    const int stackNum = it->second;
+    ++_stacks[stackNum].samples;
+
+    const auto key = (static_cast<unsigned long long>(operation) << 32) | stackNum;
+    auto found = _operationStackSamples.find(key);
+    if (found != _operationStackSamples.end()) {
+        ++found->second;
+    } else if (_operationStackSamples.size() < kMaxOperationStacks) {
+        _operationStackSamples.emplace(key, 1);
+    }
+}
+
+const BSONObj& SamplingProfiler::_symbolize(WithLock, StackInfo* stackInfo) {
+    if (stackInfo->symbolized.isEmpty()) {
+        BSONArrayBuilder builder;
+        for (auto frame : *stackInfo->frames) {
+            builder.append(symbolizeFrame(frame));
+        }
+        stackInfo->symbolized = builder.arr();
+        const int stackNum = stackInfo - _stacks.data();
+        log() << "cpuSamplingProfile " << stackName(stackNum) << ": "
+              << stackInfo->symbolized;
+    }
+    return stackInfo->symbolized;
+}
+
+void SamplingProfiler::appendReport(BSONObjBuilder* builder,
+                                    size_t maxOperations,
+                                    size_t maxStacksPerOperation) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _drain(lk);
+
+    builder->append("running", isRunning());
+    builder->appendNumber("samplingIntervalMicros", _samplingIntervalMicros.load());
+    builder->appendNumber("samples", _totalSamples);
+    builder->appendNumber("droppedSamples", _droppedSamples.load());
+    builder->appendNumber("untrackedStackSamples", _untrackedStackSamples);
+
+    const auto operations = getHottest(_operationSamples.size(), maxOperations, [&](size_t i) {
+        return _operationSamples[i];
+    });
+
+    // Collect the stacks of the reported operations as (samples, stackNum) pairs.
+    std::map<int, std::vector<std::pair<long long, int>>> stacksByOperation;
+    for (auto operation : operations) {
+        stacksByOperation[operation];
+    }
+    for (const auto& entry : _operationStackSamples) {
+        auto it = stacksByOperation.find(static_cast<int>(entry.first >> 32));
+        if (it != stacksByOperation.end()) {
+            it->second.emplace_back(entry.second, static_cast<int>(entry.first & 0xffffffff));
+        }
+    }
+
+    std::set<int> reportedStacks;
+    BSONArrayBuilder operationsBuilder(builder->subarrayStart("operations"));
+    for (auto operation : operations) {
+        const auto info = _getOperation(operation);
+        BSONObjBuilder operationBuilder(operationsBuilder.subobjStart());
+        operationBuilder.append("op", info.opType);
+        operationBuilder.append("ns", info.ns);
+        operationBuilder.appendNumber("samples", _operationSamples[operation]);
+
+        auto& stacks = stacksByOperation[operation];
+        std::sort(stacks.begin(), stacks.end(), [](const auto& a, const auto& b) {
+            return a.first > b.first || (a.first == b.first && a.second < b.second);
+        });
+        if (stacks.size() > maxStacksPerOperation) {
+            stacks.resize(maxStacksPerOperation);
+        }
+
+        BSONArrayBuilder stacksBuilder(operationBuilder.subarrayStart("stacks"));
+        for (const auto& stack : stacks) {
+            BSONObjBuilder stackBuilder(stacksBuilder.subobjStart());
+            stackBuilder.append("stack", stackName(stack.second));
+            stackBuilder.appendNumber("samples", stack.first);
+            reportedStacks.insert(stack.second);
+        }
+        stacksBuilder.doneFast();
+        operationBuilder.doneFast();
+    }
+    operationsBuilder.doneFast();
+
+    BSONObjBuilder stacksBuilder(builder->subobjStart("stacks"));
+    for (auto stackNum : reportedStacks) {
+        stacksBuilder.append(stackName(stackNum), _symbolize(lk, &_stacks[stackNum]));
+    }
+    stacksBuilder.doneFast();
+}
+
+void SamplingProfiler::appendFTDCSection(BSONObjBuilder* builder, size_t maxEntries) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _drain(lk);
+
+    builder->appendNumber("samples", _totalSamples);
+    builder->appendNumber("droppedSamples", _droppedSamples.load());
+    builder->appendNumber("untrackedStackSamples", _untrackedStackSamples);
+
+    updateEmitted(&_ftdcOperations,
+                  getHottest(_operationSamples.size(),
+                             maxEntries,
+                             [&](size_t i) { return _operationSamples[i]; }),
+                  maxEntries);
+    BSONObjBuilder operationsBuilder(builder->subobjStart("operations"));
+    for (auto operation : _ftdcOperations) {
+        const auto info = _getOperation(operation);
+        std::string name = info.opType;
+        if (!info.ns.empty()) {
+            name += ' ' + info.ns;
+        }
+        operationsBuilder.appendNumber(name, _operationSamples[operation]);
+    }
+    operationsBuilder.doneFast();
+
+    // FTDC only keeps numbers, so each stack is logged with its frames when first emitted.
+    updateEmitted(
+        &_ftdcStacks,
+        getHottest(_stacks.size(), maxEntries, [&](size_t i) { return _stacks[i].samples; }),
+        maxEntries);
+    BSONObjBuilder stacksBuilder(builder->subobjStart("stacks"));
+    for (auto stackNum : _ftdcStacks) {
+        _symbolize(lk, &_stacks[stackNum]);
+        stacksBuilder.appendNumber(stackName(stackNum), _stacks[stackNum].samples);
+    }
+    stacksBuilder.doneFast();
+}
+
+}  // namespace mongo
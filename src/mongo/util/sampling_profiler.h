@@ -0,0 +1,241 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/duration.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * A sampling CPU profiler that tells where the server spends CPU without attaching an external
+ * profiler.
+ *
+ * While running, an ITIMER_PROF interval timer raises SIGPROF every samplingInterval of process
+ * CPU time, on whichever thread is using the CPU. The signal handler captures the interrupted
+ * stack with rawBacktraceFromSignalContext() and pushes it into a pre-allocated lock-free ring
+ * buffer, along with the operation the thread is working on. The handler neither allocates nor
+ * locks; when the ring is full the sample is counted as dropped. It walks frame pointers rather
+ * than calling backtrace(), which can deadlock when the signal interrupts an exception unwind, so
+ * on platforms where frame pointers are not walked samples carry no stack. A background thread
+ * drains the ring into bounded tables of samples per operation and per stack.
+ *
+ * Threads name the operation they are working on with an OperationScope. Operations are only
+ * interned while the profiler is running, so an idle profiler costs one load per scope.
+ *
+ * Once installed, the SIGPROF handler stays installed after stop(), because a signal already in
+ * flight when the timer is disarmed would otherwise terminate the process. The gperftools
+ * profiler behind _cpuProfilerStart also uses SIGPROF, so the two cannot run at the same time.
+ * Only POSIX systems are supported.
+ */
+class SamplingProfiler {
+    MONGO_DISALLOW_COPYING(SamplingProfiler);
+
+public:
+    static constexpr int kMaxFrames = 64;
+
+    // Bounds on the aggregation tables. Samples beyond them are still counted in the totals.
+    static constexpr size_t kMaxOperations = 1024;
+    static constexpr size_t kMaxStacks = 10000;
+    static constexpr size_t kMaxOperationStacks = 100000;
+
+    static constexpr Microseconds kDefaultSamplingInterval{10000};
+
+    struct Options {
+        // Number of samples the ring buffer holds until drained. Must be a power of two.
+        size_t bufferCapacity = 4096;
+
+        // How often the background thread drains the ring buffer.
+        Milliseconds drainPeriod{100};
+    };
+
+    /**
+     * Charges the samples taken on the calling thread to an operation type and namespace until
+     * the scope ends, when the enclosing scope's operation is restored. If "samples" is not null,
+     * it is also incremented for each sample taken on this thread, so that currentOp can show it.
+     * Scopes nest and must be destroyed in reverse order of construction.
+     */
+    class OperationScope {
+        MONGO_DISALLOW_COPYING(OperationScope);
+
+    public:
+        OperationScope(StringData opType, StringData ns, AtomicWord<long long>* samples = nullptr)
+            : OperationScope(SamplingProfiler::get(), opType, ns, samples) {}
+
+        OperationScope(SamplingProfiler* profiler,
+                       StringData opType,
+                       StringData ns,
+                       AtomicWord<long long>* samples = nullptr);
+
+        ~OperationScope();
+
+    private:
+        int _previousOperation;
+        unsigned _previousGeneration;
+        AtomicWord<long long>* _previousSamples;
+    };
+
+    /**
+     * Returns the process-wide profiler. It is never destroyed.
+     */
+    static SamplingProfiler* get();
+
+    SamplingProfiler();
+    explicit SamplingProfiler(Options options);
+    ~SamplingProfiler();
+
+    /**
+     * Starts taking a sample every "samplingInterval" of CPU time used by the process. Fails if
+     * this or another profiler is already running, or if the platform is not supported.
+     */
+    Status start(Microseconds samplingInterval);
+
+    /**
+     * Stops sampling. The samples collected so far are kept until reset().
+     */
+    void stop();
+
+    bool isRunning() const {
+        return _running.load();
+    }
+
+    /**
+     * Discards all samples and forgets the operations seen so far.
+     */
+    void reset();
+
+    /**
+     * Samples the calling thread's stack if the profiler is running. A signal handler passes the
+     * ucontext_t it received as "signalContext", which samples the interrupted code instead and
+     * makes the call async-signal-safe.
+     */
+    void recordSample(void* signalContext = nullptr);
+
+    /**
+     * Appends the full profile: the "maxOperations" operations with the most samples, each with
+     * its "maxStacksPerOperation" hottest stacks, followed by the symbolized stacks.
+     */
+    void appendReport(BSONObjBuilder* builder, size_t maxOperations, size_t maxStacksPerOperation);
+
+    /**
+     * Appends a compact form of the profile for FTDC, which only keeps numbers. It holds the
+     * sample counts of at most 2 * "maxEntries" operations and as many stacks, keyed by name. An
+     * entry stays in the output once it has been among the "maxEntries" hottest, so that the
+     * schema changes rarely. Each stack is logged with its frames when it is first emitted.
+     */
+    void appendFTDCSection(BSONObjBuilder* builder, size_t maxEntries);
+
+private:
+    class SampleBuffer;
+
+    using Stack = std::vector<void*>;
+
+    struct StackHash {
+        size_t operator()(const Stack& stack) const;
+    };
+
+    struct StackInfo {
+        const Stack* frames;
+        long long samples;
+        BSONObj symbolized;  // Generated when first reported.
+    };
+
+    struct OperationInfo {
+        std::string opType;
+        std::string ns;
+    };
+
+    int _internOperation(StringData opType, StringData ns, unsigned* generation);
+
+    void _stop(WithLock);
+
+    void _drainLoop();
+    void _drain(WithLock);
+    void _aggregate(WithLock, int operation, void* const* frames, int numFrames);
+
+    const BSONObj& _symbolize(WithLock, StackInfo* stackInfo);
+    OperationInfo _getOperation(int operation);
+
+    const Options _options;
+
+    AtomicWord<bool> _running{false};
+    AtomicWord<long long> _droppedSamples{0};
+
+    // Replaced by reset() so that operation ids handed out before it are not trusted. Generations
+    // are unique across profilers.
+    AtomicWord<unsigned> _generation;
+
+    std::unique_ptr<SampleBuffer> _buffer;
+
+    // Serializes start() and stop().
+    stdx::mutex _controlMutex;
+    AtomicWord<long long> _samplingIntervalMicros{0};
+    stdx::thread _drainThread;
+
+    // Guards the interned operations.
+    stdx::mutex _operationsMutex;
+    std::vector<OperationInfo> _operations;
+    stdx::unordered_map<std::string, int> _operationIds;
+
+    // Guards everything below, which is only updated by draining the ring buffer.
+    stdx::mutex _mutex;
+    stdx::condition_variable _drainCondition;
+    bool _stopDraining = false;
+
+    long long _totalSamples = 0;
+    long long _untrackedStackSamples = 0;
+    std::vector<long long> _operationSamples;
+    stdx::unordered_map<Stack, int, StackHash> _stackNums;
+    std::vector<StackInfo> _stacks;
+    stdx::unordered_map<unsigned long long, long long> _operationStackSamples;
+
+    // The operations and stacks appendFTDCSection() keeps emitting.
+    std::set<int> _ftdcOperations;
+    std::set<int> _ftdcStacks;
+};
+
+}  // namespace mongo
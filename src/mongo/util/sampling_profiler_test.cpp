@@ -0,0 +1,300 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/sampling_profiler.h"
+
+#include <csignal>
+#include <cstdint>
+#include <ucontext.h>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/stacktrace.h"
+
+namespace mongo {
+namespace {
+
+// Long enough that the profiling timer never fires during a test, so that the only samples are
+// the ones the tests record themselves.
+const Microseconds kNeverSample = Seconds(3600);
+
+SamplingProfiler::Options makeOptions(size_t bufferCapacity = 64) {
+    SamplingProfiler::Options options;
+    options.bufferCapacity = bufferCapacity;
+    options.drainPeriod = Hours(1);
+    return options;
+}
+
+BSONObj getReport(SamplingProfiler* profiler) {
+    BSONObjBuilder builder;
+    profiler->appendReport(&builder, 10, 10);
+    return builder.obj();
+}
+
+TEST(SamplingProfilerTest, ChargesSamplesToOperations) {
+    SamplingProfiler profiler(makeOptions());
+    ASSERT_OK(profiler.start(kNeverSample));
+
+    AtomicWord<long long> findSamples{0};
+    {
+        SamplingProfiler::OperationScope scope(&profiler, "find", "test.coll", &findSamples);
+        for (int i = 0; i < 3; i++) {
+            profiler.recordSample();
+        }
+    }
+    profiler.recordSample();
+    profiler.stop();
+
+    const auto report = getReport(&profiler);
+    ASSERT_FALSE(report["running"].trueValue());
+    ASSERT_EQ(4, report["samples"].numberLong());
+    ASSERT_EQ(0, report["droppedSamples"].numberLong());
+    ASSERT_EQ(3, findSamples.load());
+
+    const auto operations = report["operations"].Array();
+    ASSERT_EQ(2U, operations.size());
+    ASSERT_EQ("find", operations[0]["op"].String());
+    ASSERT_EQ("test.coll", operations[0]["ns"].String());
+    ASSERT_EQ(3, operations[0]["samples"].numberLong());
+    ASSERT_EQ("none", operations[1]["op"].String());
+    ASSERT_EQ(1, operations[1]["samples"].numberLong());
+
+    // Every stack an operation refers to is reported with its frames.
+    for (const auto& operation : operations) {
+        for (const auto& stack : operation["stacks"].Array()) {
+            ASSERT_TRUE(report["stacks"].Obj().hasField(stack["stack"].String()));
+        }
+    }
+}
+
+TEST(SamplingProfilerTest, NestedScopesRestoreTheOuterOperation) {
+    SamplingProfiler profiler(makeOptions());
+    ASSERT_OK(profiler.start(kNeverSample));
+
+    AtomicWord<long long> samples{0};
+    {
+        SamplingProfiler::OperationScope outer(&profiler, "query", "test.$cmd", &samples);
+        {
+            SamplingProfiler::OperationScope inner(&profiler, "insert", "test");
+            profiler.recordSample();
+            profiler.recordSample();
+        }
+        profiler.recordSample();
+    }
+    profiler.stop();
+
+    // The inner scope keeps counting into the outer scope's counter.
+    ASSERT_EQ(3, samples.load());
+
+    const auto operations = getReport(&profiler)["operations"].Array();
+    ASSERT_EQ(2U, operations.size());
+    ASSERT_EQ("insert", operations[0]["op"].String());
+    ASSERT_EQ(2, operations[0]["samples"].numberLong());
+    ASSERT_EQ("query", operations[1]["op"].String());
+    ASSERT_EQ(1, operations[1]["samples"].numberLong());
+}
+
+TEST(SamplingProfilerTest, IgnoresSamplesWhileStopped) {
+    SamplingProfiler profiler(makeOptions());
+    profiler.recordSample();
+
+    ASSERT_OK(profiler.start(kNeverSample));
+    profiler.stop();
+    profiler.recordSample();
+
+    ASSERT_EQ(0, getReport(&profiler)["samples"].numberLong());
+}
+
+TEST(SamplingProfilerTest, OnlyOneProfilerRuns) {
+    SamplingProfiler first(makeOptions());
+    SamplingProfiler second(makeOptions());
+    ASSERT_OK(first.start(kNeverSample));
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress, first.start(kNeverSample));
+    ASSERT_EQ(ErrorCodes::ConflictingOperationInProgress, second.start(kNeverSample));
+
+    first.stop();
+    ASSERT_OK(second.start(kNeverSample));
+    second.stop();
+}
+
+TEST(SamplingProfilerTest, DropsSamplesWhenBufferIsFull) {
+    SamplingProfiler profiler(makeOptions(4));
+    ASSERT_OK(profiler.start(kNeverSample));
+    for (int i = 0; i < 10; i++) {
+        profiler.recordSample();
+    }
+
+    auto report = getReport(&profiler);
+    ASSERT_EQ(4, report["samples"].numberLong());
+    ASSERT_EQ(6, report["droppedSamples"].numberLong());
+
+    // Reporting drained the buffer, which makes room again.
+    profiler.recordSample();
+    profiler.stop();
+    ASSERT_EQ(5, getReport(&profiler)["samples"].numberLong());
+}
+
+TEST(SamplingProfilerTest, ResetForgetsSamplesAndOperations) {
+    SamplingProfiler profiler(makeOptions());
+    ASSERT_OK(profiler.start(kNeverSample));
+    {
+        SamplingProfiler::OperationScope scope(&profiler, "update", "test.coll");
+        profiler.recordSample();
+
+        profiler.reset();
+
+        // The operation was forgotten, so samples of the scope opened before the reset can no
+        // longer be told apart.
+        profiler.recordSample();
+    }
+    profiler.stop();
+
+    const auto report = getReport(&profiler);
+    ASSERT_EQ(1, report["samples"].numberLong());
+    const auto operations = report["operations"].Array();
+    ASSERT_EQ(1U, operations.size());
+    ASSERT_EQ("other", operations[0]["op"].String());
+}
+
+TEST(SamplingProfilerTest, RepeatedScopesAreChargedToTheirOperationAcrossReset) {
+    SamplingProfiler profiler(makeOptions());
+    ASSERT_OK(profiler.start(kNeverSample));
+    for (int i = 0; i < 2; i++) {
+        SamplingProfiler::OperationScope scope(&profiler, "find", "test.coll");
+        profiler.recordSample();
+    }
+
+    profiler.reset();
+
+    // After the reset, "find" must be interned again instead of reusing its old id, which would
+    // be handed to "insert".
+    {
+        SamplingProfiler::OperationScope scope(&profiler, "find", "test.coll");
+        profiler.recordSample();
+        profiler.recordSample();
+    }
+    {
+        SamplingProfiler::OperationScope scope(&profiler, "insert", "test.coll");
+        profiler.recordSample();
+    }
+    profiler.stop();
+
+    const auto operations = getReport(&profiler)["operations"].Array();
+    ASSERT_EQ(2U, operations.size());
+    ASSERT_EQ("find", operations[0]["op"].String());
+    ASSERT_EQ(2, operations[0]["samples"].numberLong());
+    ASSERT_EQ("insert", operations[1]["op"].String());
+    ASSERT_EQ(1, operations[1]["samples"].numberLong());
+}
+
+TEST(SamplingProfilerTest, FTDCSectionIsBounded) {
+    const size_t kMaxEntries = 2;
+
+    SamplingProfiler profiler(makeOptions(256));
+    ASSERT_OK(profiler.start(kNeverSample));
+
+    // Operation i gets i + 1 samples, so the later ones are hotter.
+    for (int i = 0; i < 8; i++) {
+        SamplingProfiler::OperationScope scope(&profiler, "find", "test.c" + std::to_string(i));
+        for (int j = 0; j <= i; j++) {
+            profiler.recordSample();
+        }
+
+        BSONObjBuilder builder;
+        profiler.appendFTDCSection(&builder, kMaxEntries);
+        const auto section = builder.obj();
+        ASSERT_LTE(section["operations"].Obj().nFields(), 2 * static_cast<int>(kMaxEntries));
+        ASSERT_LTE(section["stacks"].Obj().nFields(), 2 * static_cast<int>(kMaxEntries));
+        ASSERT_EQ(i + 1, section["operations"]["find test.c" + std::to_string(i)].numberLong());
+    }
+    profiler.stop();
+}
+
+TEST(SamplingProfilerTest, ChargesSignalSamplesToTheInterruptedOperation) {
+    SamplingProfiler profiler(makeOptions());
+    ASSERT_OK(profiler.start(kNeverSample));
+    {
+        SamplingProfiler::OperationScope scope(&profiler, "find", "test.coll");
+        ASSERT_EQ(0, raise(SIGPROF));
+    }
+    profiler.stop();
+
+    const auto report = getReport(&profiler);
+    ASSERT_EQ(1, report["samples"].numberLong());
+    const auto operations = report["operations"].Array();
+    ASSERT_EQ(1U, operations.size());
+    ASSERT_EQ("find", operations[0]["op"].String());
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+    // The stack starts at the interrupted address, however far the frame pointers lead from it.
+    const auto stack = operations[0]["stacks"].Array()[0]["stack"].String();
+    ASSERT_FALSE(report["stacks"][stack].Array().empty());
+#endif
+}
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+TEST(SamplingProfilerTest, SignalContextBacktraceFollowsFramePointers) {
+    // Three frame records, each holding the caller's frame pointer and then the return address,
+    // where the outermost one has no caller.
+    uintptr_t stack[12] = {};
+    stack[2] = reinterpret_cast<uintptr_t>(&stack[6]);
+    stack[3] = 0x1111;
+    stack[6] = reinterpret_cast<uintptr_t>(&stack[10]);
+    stack[7] = 0x2222;
+    stack[11] = 0x3333;
+
+    ucontext_t context = {};
+#if defined(__x86_64__)
+    context.uc_mcontext.gregs[REG_RIP] = 0x1000;
+    context.uc_mcontext.gregs[REG_RSP] = reinterpret_cast<uintptr_t>(&stack[0]);
+    context.uc_mcontext.gregs[REG_RBP] = reinterpret_cast<uintptr_t>(&stack[2]);
+#else
+    context.uc_mcontext.pc = 0x1000;
+    context.uc_mcontext.sp = reinterpret_cast<uintptr_t>(&stack[0]);
+    context.uc_mcontext.regs[29] = reinterpret_cast<uintptr_t>(&stack[2]);
+#endif
+
+    void* frames[8];
+    ASSERT_EQ(4, rawBacktraceFromSignalContext(frames, 8, &context));
+    ASSERT_EQ(reinterpret_cast<void*>(0x1000), frames[0]);
+    ASSERT_EQ(reinterpret_cast<void*>(0x1111), frames[1]);
+    ASSERT_EQ(reinterpret_cast<void*>(0x2222), frames[2]);
+    ASSERT_EQ(reinterpret_cast<void*>(0x3333), frames[3]);
+
+    ASSERT_EQ(2, rawBacktraceFromSignalContext(frames, 2, &context));
+
+    // A frame pointer which points down the stack ends the walk instead of being followed.
+    stack[6] = reinterpret_cast<uintptr_t>(&stack[0]);
+    ASSERT_EQ(3, rawBacktraceFromSignalContext(frames, 8, &context));
+}
+#endif
+
+}  // namespace
+}  // namespace mongo
@@ -45,6 +45,20 @@ namespace mongo {
 void printStackTrace(std::ostream& os);
 void printStackTrace();
 
+// Stores the return addresses of up to "maxFrames" frames of the calling thread's stack into
+// "addresses", innermost first, and returns how many were stored. Returns 0 on platforms that do
+// not support collecting backtraces. Not async-signal-safe: it may allocate, and glibc's unwinder
+// takes locks which an interrupted exception unwind could be holding.
+int rawBacktrace(void** addresses, int maxFrames);
+
+#if !defined(_WIN32)
+// Like rawBacktrace(), but for the code that a signal interrupted, as described by the ucontext_t
+// that an SA_SIGINFO handler receives as "context". The first address is the interrupted one.
+// Follows frame pointers, so it is async-signal-safe, but skips the callers of functions built
+// without them. Returns 0 on platforms where frame pointers are not walked.
+int rawBacktraceFromSignalContext(void** addresses, int maxFrames, void* context);
+#endif
+
 #if defined(_WIN32)
 // Print stack trace (using a specified stack context) to "os", default to the log stream.
 void printWindowsStackTrace(CONTEXT& context, std::ostream& os);
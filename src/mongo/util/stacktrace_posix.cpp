@@ -51,6 +51,13 @@
 #include <ucontext.h>
 #endif
 
+// The architectures whose frame records hold the caller's frame pointer followed by the return
+// address, which are all built with frame pointers on Linux.
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+#include <ucontext.h>
+#define MONGO_HAVE_FRAME_POINTER_WALK
+#endif
+
 namespace mongo {
 
 namespace {
@@ -136,6 +143,10 @@ void printStackTrace(std::ostream& os) {
     os << "This platform does not support printing stacktraces" << std::endl;
 }
 
+int rawBacktrace(void** addresses, int maxFrames) {
+    return 0;
+}
+
 #else
 /**
  * Prints a stack backtrace for the current thread to the specified ostream.
@@ -243,6 +254,72 @@ void printStackTrace(std::ostream& os) {
     os << "-----  END BACKTRACE  -----" << std::endl;
 }
 
+int rawBacktrace(void** addresses, int maxFrames) {
+    return backtrace(addresses, maxFrames);
+}
+
+#endif
+
+#if defined(MONGO_HAVE_FRAME_POINTER_WALK)
+namespace {
+
+// Frames larger than this end the walk. A frame pointer further up the stack than that most
+// likely comes from code that uses the register for something else.
+const uintptr_t kMaxFrameBytes = 100 * 1024;
+
+/**
+ * Stores the return addresses along the chain of frame records starting at "framePointer" into
+ * "addresses", from index "count" on, and returns the new count. Each frame must lie above the
+ * previous one, and the first above "stackPointer", by no more than kMaxFrameBytes, so that a
+ * frame pointer register holding something else does not lead the walk off the stack.
+ */
+int walkFramePointers(
+    uintptr_t framePointer, uintptr_t stackPointer, void** addresses, int maxFrames, int count) {
+    uintptr_t lowest = stackPointer;
+    while (count < maxFrames) {
+        if (framePointer < lowest || framePointer - lowest > kMaxFrameBytes ||
+            framePointer % sizeof(void*) != 0) {
+            break;
+        }
+
+        void* const* const frame = reinterpret_cast<void* const*>(framePointer);
+        if (!frame[1]) {
+            break;
+        }
+        addresses[count++] = frame[1];
+        lowest = framePointer + 2 * sizeof(void*);
+        framePointer = reinterpret_cast<uintptr_t>(frame[0]);
+    }
+    return count;
+}
+
+}  // namespace
+
+int rawBacktraceFromSignalContext(void** addresses, int maxFrames, void* context) {
+    if (maxFrames <= 0) {
+        return 0;
+    }
+
+    const auto& registers = static_cast<ucontext_t*>(context)->uc_mcontext;
+#if defined(__x86_64__)
+    const uintptr_t pc = registers.gregs[REG_RIP];
+    const uintptr_t sp = registers.gregs[REG_RSP];
+    const uintptr_t fp = registers.gregs[REG_RBP];
+#else
+    const uintptr_t pc = registers.pc;
+    const uintptr_t sp = registers.sp;
+    const uintptr_t fp = registers.regs[29];
+#endif
+
+    addresses[0] = reinterpret_cast<void*>(pc);
+    return walkFramePointers(fp, sp, addresses, maxFrames, 1);
+}
+
+#else
+int rawBacktraceFromSignalContext(void** addresses, int maxFrames, void* context) {
+    return 0;
+}
+
 #endif
 
 namespace {